@@ -0,0 +1,511 @@
+#include "BrainFramework.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+// Standalone microbenchmarks for the network kernels
+// Usage: BrainFrameworkBenchmark [--quick] [--workers N] [--min-time-ms N] [--json path|-]
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+    bool quick{ false };
+    int workers{ 0 };
+    double minTimeMs{ 100.0 };
+    std::string jsonPath;
+};
+
+struct Result
+{
+    std::string name;
+    std::string kernel;
+    std::vector<std::pair<std::string, long long>> parameters;
+    long long links{ 0 };
+    double nsPerOp{ 0.0 };
+    long long iterations{ 0 };
+
+    double GetLinksPerSecond() const { return nsPerOp > 0.0 ? links * 1e9 / nsPerOp : 0.0; }
+    double GetGFlops() const { return nsPerOp > 0.0 ? 2.0 * links / nsPerOp : 0.0; } // One multiply and one add per link
+};
+
+// Consumes values so the optimizer can't drop the evaluations
+volatile float g_Sink = 0.0f;
+
+// Repeats the function until the minimum time is reached and returns nanoseconds per call
+template <typename Function>
+double Measure(const Options& options, long long& iterations, Function&& function)
+{
+    // Warm up caches and the worker pool
+    function();
+
+    long long batch = 1;
+    while (true)
+    {
+        const Clock::time_point start = Clock::now();
+        for (long long i = 0; i < batch; ++i)
+        {
+            function();
+        }
+        const double elapsedNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        if (elapsedNs >= options.minTimeMs * 1e6 || batch >= (1ll << 30))
+        {
+            iterations = batch;
+            return elapsedNs / static_cast<double>(batch);
+        }
+        batch *= 2;
+    }
+}
+
+// Random feed-forward topology: every non-input neuron can link to any earlier non-output neuron with probability density
+std::vector<BrainFramework::BasicNeuralNetwork::Neuron> MakeBasicNeurons(std::mt19937& rng, int inputs, int hiddens, int outputs, float density)
+{
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    std::uniform_real_distribution<float> weight(-1.0f, 1.0f);
+
+    const int neuronsCount = inputs + hiddens + outputs;
+    const int outputsStart = inputs + hiddens;
+    std::vector<BrainFramework::BasicNeuralNetwork::Neuron> neurons(neuronsCount);
+    for (int i = inputs; i < neuronsCount; ++i)
+    {
+        const int sources = std::min(i, outputsStart);
+        for (int j = 0; j < sources; ++j)
+        {
+            if (uniform(rng) < density)
+            {
+                neurons[i].links.emplace_back(j, weight(rng));
+            }
+        }
+    }
+    return neurons;
+}
+
+std::vector<float> MakeLayeredWeights(std::mt19937& rng, const std::vector<int>& layerSizes)
+{
+    std::uniform_real_distribution<float> weight(-1.0f, 1.0f);
+    std::vector<float> weights;
+    for (std::size_t i = 1; i < layerSizes.size(); ++i)
+    {
+        const int count = layerSizes[i - 1] * layerSizes[i];
+        for (int j = 0; j < count; ++j)
+        {
+            weights.push_back(weight(rng));
+        }
+    }
+    return weights;
+}
+
+std::vector<std::vector<float>> MakeInputs(std::mt19937& rng, int batchSize, int inputs)
+{
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    std::vector<std::vector<float>> batch(batchSize, std::vector<float>(inputs));
+    for (std::vector<float>& input : batch)
+    {
+        for (float& v : input)
+        {
+            v = value(rng);
+        }
+    }
+    return batch;
+}
+
+// Evaluates a whole batch of distinct inputs back to back, reported per evaluation
+double MeasureEvaluate(const Options& options, long long& iterations, BrainFramework::NeuralNetwork& network, const std::vector<std::vector<float>>& batch)
+{
+    std::vector<float> outputs(network.GetOutputsCount());
+    const double nsPerBatch = Measure(options, iterations, [&]()
+    {
+        for (const std::vector<float>& inputs : batch)
+        {
+            network.Evaluate(inputs, outputs);
+        }
+        g_Sink = g_Sink + outputs[0];
+    });
+    return nsPerBatch / static_cast<double>(batch.size());
+}
+
+// Same batch evaluated in one EvaluateBatch call, lanes are the batch rows, reported per evaluation
+double MeasureEvaluateBatch(const Options& options, long long& iterations, BrainFramework::NeuralNetwork& network, const std::vector<std::vector<float>>& batch)
+{
+    std::vector<float> inputs;
+    for (const std::vector<float>& row : batch)
+    {
+        inputs.insert(inputs.end(), row.begin(), row.end());
+    }
+    const int lanes = static_cast<int>(batch.size());
+    std::vector<float> outputs(static_cast<std::size_t>(lanes) * network.GetOutputsCount());
+    const double nsPerBatch = Measure(options, iterations, [&]()
+    {
+        network.EvaluateBatch(inputs, outputs, lanes);
+        g_Sink = g_Sink + outputs[0];
+    });
+    return nsPerBatch / static_cast<double>(batch.size());
+}
+
+void BenchmarkBasic(const Options& options, std::vector<Result>& results)
+{
+    const std::vector<int> hiddenSizes = options.quick ? std::vector<int>{ 32, 256 } : std::vector<int>{ 16, 64, 256, 1024 };
+    const std::vector<float> densities = options.quick ? std::vector<float>{ 0.1f, 1.0f } : std::vector<float>{ 0.02f, 0.1f, 0.5f, 1.0f };
+    const std::vector<int> batchSizes = options.quick ? std::vector<int>{ 1, 64 } : std::vector<int>{ 1, 16, 256 };
+    constexpr int k_Inputs = 20;
+    constexpr int k_Outputs = 4;
+
+    for (int hiddens : hiddenSizes)
+    {
+        for (float density : densities)
+        {
+            std::mt19937 rng(1234);
+            const std::vector<BrainFramework::BasicNeuralNetwork::Neuron> neurons = MakeBasicNeurons(rng, k_Inputs, hiddens, k_Outputs, density);
+
+            BrainFramework::BasicNeuralNetwork network;
+            network.Make(k_Inputs, k_Outputs, std::vector<BrainFramework::BasicNeuralNetwork::Neuron>(neurons));
+            const long long links = network.GetLinksCount();
+            const long long densityPercent = static_cast<long long>(density * 100.0f);
+
+            {
+                Result& result = results.emplace_back();
+                result.name = "BasicNeuralNetwork::Make";
+                result.kernel = "sparse";
+                result.parameters = { { "neurons", network.GetNeuronsCount() }, { "densityPercent", densityPercent } };
+                result.links = links;
+                result.nsPerOp = Measure(options, result.iterations, [&]()
+                {
+                    BrainFramework::BasicNeuralNetwork made;
+                    made.Make(k_Inputs, k_Outputs, std::vector<BrainFramework::BasicNeuralNetwork::Neuron>(neurons));
+                    g_Sink = g_Sink + static_cast<float>(made.GetNeuronsCount());
+                });
+            }
+
+            for (int batchSize : batchSizes)
+            {
+                const std::vector<std::vector<float>> batch = MakeInputs(rng, batchSize, k_Inputs);
+
+                Result& result = results.emplace_back();
+                result.name = "BasicNeuralNetwork::Evaluate";
+                result.kernel = "sparse";
+                result.parameters = { { "neurons", network.GetNeuronsCount() }, { "densityPercent", densityPercent }, { "batch", batchSize } };
+                result.links = links;
+                result.nsPerOp = MeasureEvaluate(options, result.iterations, network, batch);
+
+                if (batchSize > 1)
+                {
+                    Result& batchResult = results.emplace_back();
+                    batchResult.name = "BasicNeuralNetwork::EvaluateBatch";
+                    batchResult.kernel = "sparse-lanes";
+                    batchResult.parameters = result.parameters;
+                    batchResult.links = links;
+                    batchResult.nsPerOp = MeasureEvaluateBatch(options, batchResult.iterations, network, batch);
+                }
+            }
+        }
+    }
+}
+
+void BenchmarkLayered(const Options& options, std::vector<Result>& results, BrainFramework::TaskScheduler* taskScheduler)
+{
+    const std::vector<int> widths = options.quick ? std::vector<int>{ 32, 512 } : std::vector<int>{ 16, 64, 256, 1024, 2048 };
+    const std::vector<int> depths = options.quick ? std::vector<int>{ 1, 3 } : std::vector<int>{ 1, 2, 4 };
+    const std::vector<int> batchSizes = options.quick ? std::vector<int>{ 1, 64 } : std::vector<int>{ 1, 16, 256 };
+    constexpr int k_Inputs = 256;
+    constexpr int k_Outputs = 4;
+
+    for (int width : widths)
+    {
+        for (int depth : depths)
+        {
+            std::vector<int> layerSizes;
+            layerSizes.push_back(k_Inputs);
+            for (int i = 0; i < depth; ++i)
+            {
+                layerSizes.push_back(width);
+            }
+            layerSizes.push_back(k_Outputs);
+
+            std::mt19937 rng(1234);
+            const std::vector<float> weights = MakeLayeredWeights(rng, layerSizes);
+
+            BrainFramework::LayeredNeuralNetwork network;
+            network.Make(layerSizes, weights);
+            const long long links = network.GetLinksCount();
+
+            {
+                Result& result = results.emplace_back();
+                result.name = "LayeredNeuralNetwork::Make";
+                result.kernel = "dense";
+                result.parameters = { { "width", width }, { "depth", depth } };
+                result.links = links;
+                result.nsPerOp = Measure(options, result.iterations, [&]()
+                {
+                    BrainFramework::LayeredNeuralNetwork made;
+                    made.Make(layerSizes, weights);
+                    g_Sink = g_Sink + static_cast<float>(made.GetNeuronsCount());
+                });
+            }
+
+            for (int batchSize : batchSizes)
+            {
+                const std::vector<std::vector<float>> batch = MakeInputs(rng, batchSize, k_Inputs);
+
+                BrainFramework::LayeredNeuralNetwork::SetTaskScheduler(nullptr);
+                {
+                    Result& result = results.emplace_back();
+                    result.name = "LayeredNeuralNetwork::Evaluate";
+                    result.kernel = "dense";
+                    result.parameters = { { "width", width }, { "depth", depth }, { "batch", batchSize } };
+                    result.links = links;
+                    result.nsPerOp = MeasureEvaluate(options, result.iterations, network, batch);
+                }
+
+                if (batchSize > 1)
+                {
+                    Result& result = results.emplace_back();
+                    result.name = "LayeredNeuralNetwork::EvaluateBatch";
+                    result.kernel = "dense-lanes";
+                    result.parameters = { { "width", width }, { "depth", depth }, { "batch", batchSize } };
+                    result.links = links;
+                    result.nsPerOp = MeasureEvaluateBatch(options, result.iterations, network, batch);
+                }
+
+                if (taskScheduler != nullptr)
+                {
+                    BrainFramework::LayeredNeuralNetwork::SetTaskScheduler(taskScheduler);
+                    Result& result = results.emplace_back();
+                    result.name = "LayeredNeuralNetwork::Evaluate";
+                    result.kernel = "dense-parallel";
+                    result.parameters = { { "width", width }, { "depth", depth }, { "batch", batchSize }, { "workers", taskScheduler->GetWorkersCount() } };
+                    result.links = links;
+                    result.nsPerOp = MeasureEvaluate(options, result.iterations, network, batch);
+                    BrainFramework::LayeredNeuralNetwork::SetTaskScheduler(nullptr);
+                }
+            }
+        }
+    }
+}
+
+// Mutation helpers run on a fresh copy every time, the cost of the copy alone is measured and removed
+void BenchmarkMutations(const Options& options, std::vector<Result>& results)
+{
+    const std::vector<int> widths = options.quick ? std::vector<int>{ 32, 512 } : std::vector<int>{ 16, 64, 256, 1024 };
+    constexpr int k_Inputs = 64;
+    constexpr int k_Outputs = 4;
+
+    for (int width : widths)
+    {
+        const std::vector<int> layerSizes = { k_Inputs, width, width, k_Outputs };
+        std::mt19937 rng(1234);
+        const std::vector<float> weights = MakeLayeredWeights(rng, layerSizes);
+        const long long links = static_cast<long long>(weights.size());
+
+        std::vector<int> workingLayerSizes;
+        std::vector<float> workingWeights;
+        auto copy = [&]()
+        {
+            workingLayerSizes = layerSizes;
+            workingWeights = weights;
+        };
+
+        long long copyIterations = 0;
+        const double copyNs = Measure(options, copyIterations, [&]()
+        {
+            copy();
+            g_Sink = g_Sink + workingWeights[0];
+        });
+
+        auto addMutation = [&](const char* name, auto&& mutation)
+        {
+            Result& result = results.emplace_back();
+            result.name = name;
+            result.kernel = "mutation";
+            result.parameters = { { "width", width }, { "depth", 2 } };
+            result.links = links;
+            const double ns = Measure(options, result.iterations, [&]()
+            {
+                copy();
+                mutation();
+                g_Sink = g_Sink + workingWeights[0];
+            });
+            result.nsPerOp = std::max(ns - copyNs, 0.0);
+        };
+
+        addMutation("LayeredNeuralNetwork::AddNeuronOnLayer", [&]()
+        {
+            BrainFramework::LayeredNeuralNetwork::AddNeuronOnLayer(workingLayerSizes, workingWeights, 1);
+        });
+        addMutation("LayeredNeuralNetwork::RemoveNeuronOnLayer", [&]()
+        {
+            BrainFramework::LayeredNeuralNetwork::RemoveNeuronOnLayer(workingLayerSizes, workingWeights, 1);
+        });
+        addMutation("LayeredNeuralNetwork::AddLayer", [&]()
+        {
+            BrainFramework::LayeredNeuralNetwork::AddLayer(workingLayerSizes, workingWeights, 2);
+        });
+    }
+}
+
+// Bulk draws against one value per call, the count of values stands for the links
+void BenchmarkRandom(const Options& options, std::vector<Result>& results)
+{
+    const std::vector<int> counts = options.quick ? std::vector<int>{ 4096 } : std::vector<int>{ 256, 4096, 65536 };
+
+    for (int count : counts)
+    {
+        std::vector<float> values(count);
+        std::vector<std::uint8_t> bits(count);
+        BrainFramework::RandomStream stream(1234);
+        std::mt19937 rng(1234);
+        std::normal_distribution<float> normal(0.0f, 1.0f);
+
+        auto addRandom = [&](const char* name, const char* kernel, auto&& draw)
+        {
+            Result& result = results.emplace_back();
+            result.name = name;
+            result.kernel = kernel;
+            result.parameters = { { "values", count } };
+            result.links = count;
+            result.nsPerOp = Measure(options, result.iterations, [&]()
+            {
+                draw();
+                g_Sink = g_Sink + values[0] + bits[0];
+            });
+        };
+
+        addRandom("RandomStream::NextFloat", "scalar", [&]()
+        {
+            for (float& value : values)
+                value = stream.NextFloat();
+        });
+        addRandom("RandomStream::FillUniform", "bulk", [&]() { stream.FillUniform(values); });
+        addRandom("std::normal_distribution", "scalar", [&]()
+        {
+            for (float& value : values)
+                value = normal(rng);
+        });
+        addRandom("RandomStream::FillNormal", "bulk", [&]() { stream.FillNormal(values); });
+        addRandom("RandomStream::FillBernoulli", "bulk", [&]() { stream.FillBernoulli(bits, 0.25f); });
+    }
+}
+
+std::string FormatParameters(const Result& result)
+{
+    std::string text;
+    for (const auto& parameter : result.parameters)
+    {
+        if (!text.empty())
+            text += " ";
+        text += parameter.first + "=" + std::to_string(parameter.second);
+    }
+    return text;
+}
+
+void PrintTable(const std::vector<Result>& results)
+{
+    std::printf("%-42s %-15s %-48s %14s %14s %10s\n", "benchmark", "kernel", "parameters", "ns/op", "links/s", "GFLOP/s");
+    for (const Result& result : results)
+    {
+        std::printf("%-42s %-15s %-48s %14.1f %14.4g %10.3f\n", result.name.c_str(), result.kernel.c_str(), FormatParameters(result).c_str(),
+            result.nsPerOp, result.GetLinksPerSecond(), result.GetGFlops());
+    }
+}
+
+void WriteJson(std::ostream& stream, const Options& options, const std::vector<Result>& results)
+{
+    stream << "{\n";
+    stream << "  \"hardwareConcurrency\": " << std::thread::hardware_concurrency() << ",\n";
+    stream << "  \"l2CacheSize\": " << BrainFramework::TaskScheduler::GetL2CacheSize() << ",\n";
+    stream << "  \"minTimeMs\": " << options.minTimeMs << ",\n";
+    stream << "  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& result = results[i];
+        stream << "    { \"name\": \"" << result.name << "\", \"kernel\": \"" << result.kernel << "\", \"parameters\": {";
+        for (std::size_t j = 0; j < result.parameters.size(); ++j)
+        {
+            stream << (j > 0 ? ", " : " ") << "\"" << result.parameters[j].first << "\": " << result.parameters[j].second;
+        }
+        stream << " }, \"links\": " << result.links << ", \"iterations\": " << result.iterations
+            << ", \"nsPerOp\": " << result.nsPerOp << ", \"linksPerSecond\": " << result.GetLinksPerSecond()
+            << ", \"gflops\": " << result.GetGFlops() << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    stream << "  ]\n";
+    stream << "}\n";
+}
+
+bool ParseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (argument == "--quick")
+        {
+            options.quick = true;
+            options.minTimeMs = 20.0;
+        }
+        else if (argument == "--workers" && hasValue)
+        {
+            options.workers = std::atoi(argv[++i]);
+        }
+        else if (argument == "--min-time-ms" && hasValue)
+        {
+            options.minTimeMs = std::atof(argv[++i]);
+        }
+        else if (argument == "--json" && hasValue)
+        {
+            options.jsonPath = argv[++i];
+        }
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--quick] [--workers N] [--min-time-ms N] [--json path|-]\n", argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+        return 1;
+
+    std::unique_ptr<BrainFramework::TaskScheduler> taskScheduler;
+    const int workers = options.workers > 0 ? options.workers : static_cast<int>(std::thread::hardware_concurrency());
+    if (workers > 1)
+    {
+        taskScheduler = std::make_unique<BrainFramework::TaskScheduler>(workers);
+    }
+
+    std::vector<Result> results;
+    BenchmarkBasic(options, results);
+    BenchmarkLayered(options, results, taskScheduler.get());
+    BenchmarkMutations(options, results);
+    BenchmarkRandom(options, results);
+
+    if (options.jsonPath == "-")
+    {
+        WriteJson(std::cout, options, results);
+    }
+    else
+    {
+        PrintTable(results);
+        if (!options.jsonPath.empty())
+        {
+            std::ofstream file(options.jsonPath);
+            if (!file)
+            {
+                std::fprintf(stderr, "Can't write %s\n", options.jsonPath.c_str());
+                return 1;
+            }
+            WriteJson(file, options, results);
+        }
+    }
+
+    return 0;
+}
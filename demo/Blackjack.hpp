@@ -37,21 +37,28 @@ public:
 
     BlackjackRLAgent(Blackjack& blackjack, BrainFramework::NeuralNetwork& neuralNetwork)
         : BlackjackBaseAgent(blackjack)
-        , m_NeuralNetwork(neuralNetwork)
+        , m_NeuralNetwork(&neuralNetwork)
     {
         m_Inputs.resize(k_Inputs);
-        for (int i = 0; i < k_Inputs; ++i)
-        {
-            m_Inputs[i] = 0.0f;
-        }
         m_Outputs.resize(k_Outputs);
-        m_Outputs[0] = 0.0f;
-        m_Cards = 0;
+        ResetInputs();
+    }
+
+    // Pooled by its simulation, only the network changes from one episode to the next
+    void Rebind(Blackjack& /*blackjack*/, BrainFramework::NeuralNetwork& neuralNetwork)
+    {
+        m_NeuralNetwork = &neuralNetwork;
+    }
+
+    void Initialize() override
+    {
+        BlackjackBaseAgent::Initialize();
+        ResetInputs();
     }
 
     bool Evaluate() override
     {
-        return m_NeuralNetwork.Evaluate(m_Inputs, m_Outputs);
+        return m_NeuralNetwork->Evaluate(m_Inputs, m_Outputs);
     }
 
     void AddCard(int card) override
@@ -63,12 +70,128 @@ public:
     bool TakeCard() override { return m_Outputs[0] >= 0.0f; }
 
 private:
-    BrainFramework::NeuralNetwork& m_NeuralNetwork;
+    void ResetInputs()
+    {
+        for (int i = 0; i < k_Inputs; ++i)
+        {
+            m_Inputs[i] = 0.0f;
+        }
+        m_Outputs[0] = 0.0f;
+        m_Cards = 0;
+    }
+
+    BrainFramework::NeuralNetwork* m_NeuralNetwork;
     std::vector<float> m_Inputs;
     std::vector<float> m_Outputs;
     int m_Cards{ 0 };
 };
 
+// Blackjack on many lanes at once, each lane with its own deck
+// A lane plays exactly as a BlackjackRLAgent alone in a Blackjack
+class BlackjackVector : public BrainFramework::VectorSimulation
+{
+public:
+    static constexpr int k_Inputs = BlackjackRLAgent::k_Inputs;
+    static constexpr int k_Outputs = BlackjackRLAgent::k_Outputs;
+    static constexpr int k_DeckSize = 48;
+
+    explicit BlackjackVector(int lanes)
+        : BrainFramework::VectorSimulation(lanes)
+    {
+        m_Hands.resize(GetLanesCount());
+        m_Cards.resize(GetLanesCount());
+        m_DeckSizes.resize(GetLanesCount());
+        m_Decks.resize(static_cast<std::size_t>(GetLanesCount()) * k_DeckSize);
+        m_Inputs.resize(static_cast<std::size_t>(GetLanesCount()) * k_Inputs);
+    }
+
+    const char* GetName() const override { return "Blackjack"; }
+    int GetObservationsCount() const override { return k_Inputs; }
+    int GetActionsCount() const override { return k_Outputs; }
+
+protected:
+    void ResetLane(int lane) override
+    {
+        // Same card order as Blackjack::Initialize, so the same draws pick the same cards
+        std::uint8_t* deck = &m_Decks[static_cast<std::size_t>(lane) * k_DeckSize];
+        int size = 0;
+        for (int color = 0; color < 4; ++color)
+        {
+            for (int i = 2; i < 10; ++i)
+            {
+                deck[size++] = static_cast<std::uint8_t>(i);
+            }
+
+            deck[size++] = 10;
+            deck[size++] = 10;
+            deck[size++] = 10;
+
+            deck[size++] = 1;
+        }
+
+        m_DeckSizes[lane] = size;
+        m_Hands[lane] = 0;
+        m_Cards[lane] = 0;
+        std::fill_n(&m_Inputs[static_cast<std::size_t>(lane) * k_Inputs], k_Inputs, 0.0f);
+    }
+
+    void StepLanes(int lanes, const float* actions) override
+    {
+        for (int lane = 0; lane < lanes; ++lane)
+        {
+            if (!IsLaneActive(lane))
+                continue;
+
+            if (actions[lane * k_Outputs] < 0.0f)
+            {
+                AddReward(lane, 3.0f);
+                Finish(lane);
+                continue;
+            }
+
+            // Picked cards leave the deck in place, as the erase of Blackjack::PickCard
+            std::uint8_t* deck = &m_Decks[static_cast<std::size_t>(lane) * k_DeckSize];
+            int& deckSize = m_DeckSizes[lane];
+            const int index = GetLaneRandom(lane).NextInt(0, deckSize - 1);
+            const int card = deck[index];
+            std::copy(deck + index + 1, deck + deckSize, deck + index);
+            deckSize--;
+
+            m_Inputs[static_cast<std::size_t>(lane) * k_Inputs + m_Cards[lane]] = static_cast<float>(card);
+            m_Cards[lane]++;
+
+            int& hand = m_Hands[lane];
+            hand += card;
+            if (hand > 21)
+            {
+                AddReward(lane, -10.0f);
+                Finish(lane);
+            }
+            else if (hand == 21)
+            {
+                AddReward(lane, 10.0f);
+                Finish(lane);
+            }
+            else
+            {
+                AddReward(lane, 1.0f);
+            }
+        }
+    }
+
+    void WriteObservations(int lanes, float* observations) const override
+    {
+        std::copy(m_Inputs.begin(), m_Inputs.begin() + static_cast<std::size_t>(lanes) * k_Inputs, observations);
+    }
+
+private:
+    std::vector<int> m_Hands;
+    std::vector<int> m_Cards;
+    std::vector<int> m_DeckSizes;
+    std::vector<std::uint8_t> m_Decks; // k_DeckSize per lane, the first m_DeckSizes of them still in the deck
+    std::vector<float> m_Inputs; // k_Inputs per lane, the cards drawn so far
+};
+
 class Blackjack : public BrainFramework::Simulation<BlackjackBaseAgent>
 {
 public:
@@ -81,21 +204,76 @@ public:
     Blackjack(const Blackjack&) = delete;
     Blackjack& operator=(const Blackjack&) = delete;
 
+    std::unique_ptr<BrainFramework::ISimulation> Clone() const override { return std::make_unique<Blackjack>(); }
+
+    // Every agent draws from the same deck
+    bool HasSharedAgentState() const override { return true; }
+
+    std::unique_ptr<BrainFramework::VectorSimulation> CreateVectorSimulation(int lanes) const override
+    {
+        return std::make_unique<BlackjackVector>(lanes);
+    }
+
+    // A BlackjackRLAgent game alone at the table, each card taken waits for the network
+    BrainFramework::EpisodeTask PlayEpisode(BrainFramework::CoroutineAgent& agent) const override
+    {
+        std::vector<int> deck;
+        MakeDeck(deck);
+
+        std::array<float, BlackjackRLAgent::k_Inputs> inputs{};
+        int hand = 0;
+        int cards = 0;
+        while (true)
+        {
+            const std::span<const float> outputs = co_await agent.Decide(inputs);
+            if (outputs[0] < 0.0f)
+            {
+                agent.AddReward(3.0f);
+                co_return;
+            }
+
+            const int index = agent.GetRandom().NextInt(0, static_cast<int>(deck.size()) - 1);
+            const int card = deck[index];
+            deck.erase(deck.begin() + index);
+
+            inputs[cards++] = static_cast<float>(card);
+            hand += card;
+            if (hand > 21)
+            {
+                agent.AddReward(-10.0f);
+                co_return;
+            }
+            else if (hand == 21)
+            {
+                agent.AddReward(10.0f);
+                co_return;
+            }
+
+            agent.AddReward(1.0f);
+        }
+    }
+
     void Initialize() override
     {
-        m_AllCards.clear();
+        SeedRandom();
+        MakeDeck(m_AllCards);
+    }
+
+    static void MakeDeck(std::vector<int>& cards)
+    {
+        cards.clear();
         for (int color = 0; color < 4; ++color)
         {
             for (int i = 2; i < 10; ++i)
             {
-                m_AllCards.push_back(i); // 2 to 9
+                cards.push_back(i); // 2 to 9
             }
 
-            m_AllCards.push_back(10);
-            m_AllCards.push_back(10);
-            m_AllCards.push_back(10);
+            cards.push_back(10);
+            cards.push_back(10);
+            cards.push_back(10);
 
-            m_AllCards.push_back(1); // As is tricky...
+            cards.push_back(1); // As is tricky...
         }
     }
 
@@ -103,7 +281,7 @@ public:
 
     int PickCard()
     {
-        const int rIndex = BrainFramework::RandomIndex(m_AllCards);
+        const int rIndex = GetRandom().NextInt(0, static_cast<int>(m_AllCards.size()) - 1);
         const int card = m_AllCards[rIndex];
         m_AllCards.erase(m_AllCards.begin() + rIndex);
         return card;
@@ -126,6 +304,7 @@ private:
 
 void BlackjackBaseAgent::Initialize()
 { 
+    ResetAgent();
     m_Hand = 0; 
     m_Cards = 0;
     m_Result = BrainFramework::AgentInterface::Result::Initialized;
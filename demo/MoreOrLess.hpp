@@ -35,9 +35,45 @@ public:
 
     MoreOrLessRLAgent(MoreOrLess& moreOrLess, BrainFramework::NeuralNetwork& neuralNetwork)
         : MoreOrLessBaseAgent(moreOrLess)
-        , m_NeuralNetwork(neuralNetwork)
+        , m_NeuralNetwork(&neuralNetwork)
     {
         m_Inputs.resize(k_Inputs);
+        m_Outputs.resize(k_Outputs);
+        ResetInputs();
+    }
+
+    MoreOrLessRLAgent(const MoreOrLessRLAgent&) = delete;
+    MoreOrLessRLAgent& operator=(const MoreOrLessRLAgent&) = delete;
+
+    // Pooled by its simulation, only the network changes from one episode to the next
+    void Rebind(MoreOrLess& /*moreOrLess*/, BrainFramework::NeuralNetwork& neuralNetwork)
+    {
+        m_NeuralNetwork = &neuralNetwork;
+    }
+
+    void Initialize() override
+    {
+        MoreOrLessBaseAgent::Initialize();
+        ResetInputs();
+    }
+
+    bool Evaluate() override
+    {
+        return m_NeuralNetwork->Evaluate(m_Inputs, m_Outputs);
+    }
+
+    int GetGuessedNumber() const override { return static_cast<int>(std::round(m_Outputs[0] * 100.0f)); }
+
+    void AddFeedback(int guessCount, int numberGuessed, float hint) override
+    {
+        const int index = guessCount * 2;
+        m_Inputs[index] = static_cast<float>(numberGuessed);
+        m_Inputs[index + 1] = hint;
+    }
+
+private:
+    void ResetInputs()
+    {
         for (int i = 0; i < k_Inputs; ++i)
         {
             if (i % 2 == 0)
@@ -49,31 +85,117 @@ public:
                 m_Inputs[i] = 0.0f;
             }
         }
-        m_Outputs.resize(k_Outputs);
         m_Outputs[0] = 0.0f;
     }
 
-    MoreOrLessRLAgent(const MoreOrLessRLAgent&) = delete;
-    MoreOrLessRLAgent& operator=(const MoreOrLessRLAgent&) = delete;
+    BrainFramework::NeuralNetwork* m_NeuralNetwork;
+    std::vector<float> m_Inputs;
+    std::vector<float> m_Outputs;
+};
 
-    bool Evaluate() override
+// MoreOrLess on many lanes at once, a lane plays exactly as a MoreOrLessRLAgent alone in a MoreOrLess
+class MoreOrLessVector : public BrainFramework::VectorSimulation
+{
+public:
+    static constexpr int k_Inputs = MoreOrLessRLAgent::k_Inputs;
+    static constexpr int k_Outputs = MoreOrLessRLAgent::k_Outputs;
+    static constexpr int k_MaxGuesses = 10;
+
+    explicit MoreOrLessVector(int lanes)
+        : BrainFramework::VectorSimulation(lanes)
     {
-        return m_NeuralNetwork.Evaluate(m_Inputs, m_Outputs);
+        m_NumberToGuess.resize(GetLanesCount());
+        m_Guess.resize(GetLanesCount());
+        m_PreviousGuessed.resize(GetLanesCount());
+        m_PreviousHint.resize(GetLanesCount());
+        m_Inputs.resize(static_cast<std::size_t>(GetLanesCount()) * k_Inputs);
     }
 
-    int GetGuessedNumber() const override { return static_cast<int>(std::round(m_Outputs[0] * 100.0f)); }
+    const char* GetName() const override { return "MoreOrLess"; }
+    int GetObservationsCount() const override { return k_Inputs; }
+    int GetActionsCount() const override { return k_Outputs; }
 
-    void AddFeedback(int guessCount, int numberGuessed, float hint) override
+protected:
+    void ResetLane(int lane) override
     {
-        const int index = guessCount * 2;
-        m_Inputs[index] = static_cast<float>(numberGuessed);
-        m_Inputs[index + 1] = hint;
+        m_NumberToGuess[lane] = GetLaneRandom(lane).NextInt(0, 100);
+        m_Guess[lane] = 0;
+        m_PreviousGuessed[lane] = -1;
+        m_PreviousHint[lane] = 0.0f;
+
+        float* inputs = &m_Inputs[static_cast<std::size_t>(lane) * k_Inputs];
+        for (int i = 0; i < k_Inputs; ++i)
+        {
+            inputs[i] = (i % 2 == 0) ? -1.0f : 0.0f;
+        }
+    }
+
+    void StepLanes(int lanes, const float* actions) override
+    {
+        for (int lane = 0; lane < lanes; ++lane)
+        {
+            if (!IsLaneActive(lane))
+                continue;
+
+            const int numberGuessed = static_cast<int>(std::round(actions[lane * k_Outputs] * 100.0f));
+            const int numberToGuess = m_NumberToGuess[lane];
+            int& guess = m_Guess[lane];
+
+            if (numberGuessed < 0 || numberGuessed > 100)
+            {
+                AddReward(lane, -100.0f);
+            }
+            else if (numberGuessed > 0)
+            {
+                AddReward(lane, 0.1f);
+            }
+
+            if (numberGuessed == numberToGuess)
+            {
+                AddReward(lane, 100.0f / (guess + 1));
+                Finish(lane);
+                continue;
+            }
+
+            const float hint = numberGuessed > numberToGuess ? -1.0f : 1.0f;
+
+            float* inputs = &m_Inputs[static_cast<std::size_t>(lane) * k_Inputs];
+            inputs[guess * 2] = static_cast<float>(numberGuessed);
+            inputs[guess * 2 + 1] = hint;
+
+            if (guess > 0)
+            {
+                const float previousHint = m_PreviousHint[lane];
+                const int previousGuessed = m_PreviousGuessed[lane];
+                if ((previousHint > 0.0f && numberGuessed > previousGuessed) || (previousHint < 0.0f && numberGuessed < previousGuessed))
+                {
+                    AddReward(lane, 1.0f);
+                }
+            }
+
+            guess++;
+            m_PreviousGuessed[lane] = numberGuessed;
+            m_PreviousHint[lane] = hint;
+
+            if (guess >= k_MaxGuesses)
+            {
+                AddReward(lane, -10.0f);
+                Finish(lane);
+            }
+        }
+    }
+
+    void WriteObservations(int lanes, float* observations) const override
+    {
+        std::copy(m_Inputs.begin(), m_Inputs.begin() + static_cast<std::size_t>(lanes) * k_Inputs, observations);
     }
 
 private:
-    BrainFramework::NeuralNetwork& m_NeuralNetwork;
-    std::vector<float> m_Inputs;
-    std::vector<float> m_Outputs;
+    std::vector<int> m_NumberToGuess;
+    std::vector<int> m_Guess;
+    std::vector<int> m_PreviousGuessed;
+    std::vector<float> m_PreviousHint;
+    std::vector<float> m_Inputs; // k_Inputs per lane, the observations as they are
 };
 
 class MoreOrLess : public BrainFramework::Simulation<MoreOrLessBaseAgent>
@@ -88,9 +210,72 @@ public:
     MoreOrLess(const MoreOrLess&) = delete;
     MoreOrLess& operator=(const MoreOrLess&) = delete;
 
+    std::unique_ptr<BrainFramework::ISimulation> Clone() const override { return std::make_unique<MoreOrLess>(); }
+
+    // Agents only read the number to guess
+    bool HasSharedAgentState() const override { return false; }
+
+    std::unique_ptr<BrainFramework::VectorSimulation> CreateVectorSimulation(int lanes) const override
+    {
+        return std::make_unique<MoreOrLessVector>(lanes);
+    }
+
+    // A MoreOrLessRLAgent game, each guess waits for the network
+    BrainFramework::EpisodeTask PlayEpisode(BrainFramework::CoroutineAgent& agent) const override
+    {
+        const int numberToGuess = agent.GetRandom().NextInt(0, 100);
+
+        std::array<float, MoreOrLessRLAgent::k_Inputs> inputs;
+        for (int i = 0; i < MoreOrLessRLAgent::k_Inputs; ++i)
+        {
+            inputs[i] = (i % 2 == 0) ? -1.0f : 0.0f;
+        }
+
+        int previousGuessed = -1;
+        float previousHint = 0.0f;
+        for (int guess = 0; guess < MoreOrLessVector::k_MaxGuesses; ++guess)
+        {
+            const std::span<const float> outputs = co_await agent.Decide(inputs);
+            const int numberGuessed = static_cast<int>(std::round(outputs[0] * 100.0f));
+
+            if (numberGuessed < 0 || numberGuessed > 100)
+            {
+                agent.AddReward(-100.0f);
+            }
+            else if (numberGuessed > 0)
+            {
+                agent.AddReward(0.1f);
+            }
+
+            if (numberGuessed == numberToGuess)
+            {
+                agent.AddReward(100.0f / (guess + 1));
+                co_return;
+            }
+
+            const float hint = numberGuessed > numberToGuess ? -1.0f : 1.0f;
+            inputs[guess * 2] = static_cast<float>(numberGuessed);
+            inputs[guess * 2 + 1] = hint;
+
+            if (guess > 0)
+            {
+                if ((previousHint > 0.0f && numberGuessed > previousGuessed) || (previousHint < 0.0f && numberGuessed < previousGuessed))
+                {
+                    agent.AddReward(1.0f);
+                }
+            }
+
+            previousGuessed = numberGuessed;
+            previousHint = hint;
+        }
+
+        agent.AddReward(-10.0f);
+    }
+
     void Initialize() override
     {
-        m_NumberToGuess = std::rand() % (100 + 1); // [0,100]
+        SeedRandom();
+        m_NumberToGuess = GetRandom().NextInt(0, 100);
     }
 
     bool IsFinished() const override { return false; }
@@ -116,7 +301,10 @@ private:
 
 void MoreOrLessBaseAgent::Initialize()
 {
+    ResetAgent();
     m_Guess = 0;
+    m_PreviousGuessed = -1;
+    m_PreviousHint = 0.0f;
     m_Result = BrainFramework::AgentInterface::Result::Initialized;
 }
 
@@ -128,7 +128,7 @@ public:
         for (const Gene& gene1 : genome1.m_Genes)
         {
             auto it = innovations2.find(gene1.GetInnovation());
-            const Gene* gene = (it != innovations2.end() && (rand() % 2 == 0) && it->second.IsEnabled()) ? &(it->second) : &gene1;
+            const Gene* gene = (it != innovations2.end() && BrainFramework::RandomBool() && it->second.IsEnabled()) ? &(it->second) : &gene1;
             m_Genes.push_back(*gene);
         }
 
@@ -150,7 +150,7 @@ public:
         // Alterate mutation chances
         for (auto& mutationChance : m_MutationChances)
         {
-            mutationChance.second *= (rand() % 2 == 0) ? 0.95f : 1.05263f;
+            mutationChance.second *= BrainFramework::RandomBool() ? 0.95f : 1.05263f;
         }
 
         if (BrainFramework::RandomFloat() < m_MutationChances[Mutations::Connections])
@@ -239,12 +239,175 @@ public:
         return neuralNetwork.Make(m_Inputs, m_Outputs, std::move(neurons));
     }
 
+    // Canonical hash of the network MakeNeuralNetwork builds: its links in any order, with quantized weights
+    // Innovations, disabled genes and unused neurons do not change how a genome plays, so they are left out
+    BrainFramework::Hash128 GetStructureHash() const
+    {
+        thread_local std::vector<std::array<std::int64_t, 3>> links;
+        links.clear();
+        for (const Gene& gene : m_Genes)
+        {
+            if (gene.IsEnabled() && gene.GetWeight() != 0.0f)
+                links.push_back({ gene.GetIn(), gene.GetOut(), std::llround(gene.GetWeight() * k_HashWeightScale) });
+        }
+        std::sort(links.begin(), links.end());
+
+        BrainFramework::Hash128Builder builder;
+        builder.Add(m_Inputs);
+        builder.Add(m_Outputs);
+        for (const std::array<std::int64_t, 3>& link : links)
+        {
+            builder.Add(link[0]);
+            builder.Add(link[1]);
+            builder.Add(link[2]);
+        }
+        return builder.Get();
+    }
+
+    // Everything but the score, read back by a genome of the same build
+    // Neurons and innovations go as varint deltas from the previous gene, usually a byte each, the enabled flag rides on the out delta
+    void Write(BrainFramework::ByteWriter& writer) const
+    {
+        writer.WriteVarint(static_cast<std::uint64_t>(m_Inputs));
+        writer.WriteVarint(static_cast<std::uint64_t>(m_Outputs));
+        writer.WriteVarint(static_cast<std::uint64_t>(m_MaxNeurons));
+        for (int i = 0; i < static_cast<int>(Mutations::COUNT); ++i)
+        {
+            writer.Write(m_MutationChances.at(static_cast<Mutations>(i)));
+        }
+
+        writer.WriteVarint(m_Genes.size());
+        std::int64_t in = 0;
+        std::int64_t out = 0;
+        std::int64_t innovation = 0;
+        for (const Gene& gene : m_Genes)
+        {
+            writer.WriteSignedVarint(gene.GetIn() - in);
+            writer.WriteVarint(BrainFramework::ZigZagEncode(gene.GetOut() - out) << 1 | static_cast<std::uint64_t>(gene.IsEnabled()));
+            writer.WriteSignedVarint(gene.GetInnovation() - innovation);
+            writer.Write(gene.GetWeight());
+            in = gene.GetIn();
+            out = gene.GetOut();
+            innovation = gene.GetInnovation();
+        }
+    }
+
+    // Names the genome to the worker processes after its structure hash, genomes playing alike share a key as they share a cached fitness
+    static std::uint64_t MakeKey(const BrainFramework::Hash128& structureHash)
+    {
+        const std::uint64_t key = structureHash.low ^ structureHash.high;
+        return key != 0 ? key : 1;
+    }
+
+    std::uint64_t GetKey() const { return MakeKey(GetStructureHash()); }
+
+    // The key comes from the structure hash the model already has, the bytes are only written when asked for
+    void Describe(BrainFramework::GenomeDescription& description, std::uint64_t key, bool writeBytes) const
+    {
+        description.key = key;
+        description.bytes.Clear();
+        if (writeBytes)
+            Write(description.bytes);
+    }
+
+    // False, leaving the genome as it was, when the bytes don't hold a genome whose genes link its own neurons
+    bool Read(BrainFramework::ByteReader& reader)
+    {
+        int inputs = 0;
+        int outputs = 0;
+        int maxNeurons = 0;
+        if (!reader.ReadVarint(inputs, k_MaxReadNeurons) || !reader.ReadVarint(outputs, k_MaxReadNeurons) || !reader.ReadVarint(maxNeurons, k_MaxReadNeurons))
+            return false;
+        if (inputs <= 0 || outputs <= 0 || maxNeurons < inputs + outputs)
+            return false;
+
+        std::array<float, static_cast<std::size_t>(Mutations::COUNT)> mutationChances;
+        for (float& mutationChance : mutationChances)
+        {
+            if (!reader.Read(mutationChance))
+                return false;
+        }
+
+        std::uint64_t genesCount = 0;
+        if (!reader.ReadVarint(genesCount) || genesCount > reader.GetRemaining() / k_MinGeneBytes)
+            return false;
+
+        std::vector<Gene> genes;
+        genes.reserve(static_cast<std::size_t>(genesCount));
+        std::int64_t in = 0;
+        std::int64_t out = 0;
+        std::int64_t innovation = 0;
+        for (std::uint64_t i = 0; i < genesCount; ++i)
+        {
+            std::int64_t inDelta = 0;
+            std::uint64_t outAndEnabled = 0;
+            std::int64_t innovationDelta = 0;
+            float weight = 0.0f;
+            if (!reader.ReadSignedVarint(inDelta) || !reader.ReadVarint(outAndEnabled) || !reader.ReadSignedVarint(innovationDelta) || !reader.Read(weight))
+                return false;
+
+            // Deltas are bounded before they are added, so a damaged one can't overflow
+            const std::int64_t outDelta = BrainFramework::ZigZagDecode(outAndEnabled >> 1);
+            constexpr std::int64_t maxInnovationDelta = std::numeric_limits<std::uint32_t>::max();
+            if (inDelta < -maxNeurons || inDelta > maxNeurons || outDelta < -maxNeurons || outDelta > maxNeurons || innovationDelta < -maxInnovationDelta || innovationDelta > maxInnovationDelta)
+                return false;
+
+            in += inDelta;
+            out += outDelta;
+            innovation += innovationDelta;
+            if (in < 0 || in >= maxNeurons || out < 0 || out >= maxNeurons || innovation < std::numeric_limits<int>::min() || innovation > std::numeric_limits<int>::max())
+                return false;
+
+            genes.emplace_back(static_cast<int>(in), static_cast<int>(out), weight, (outAndEnabled & 1) != 0, static_cast<int>(innovation));
+        }
+
+        m_Inputs = inputs;
+        m_Outputs = outputs;
+        m_MaxNeurons = maxNeurons;
+        m_Genes.swap(genes);
+        for (int i = 0; i < static_cast<int>(Mutations::COUNT); ++i)
+        {
+            m_MutationChances[static_cast<Mutations>(i)] = mutationChances[i];
+        }
+        m_GlobalRank = 0;
+        m_Score = 0.0f;
+        m_Birth = 0;
+        return true;
+    }
+
+    // Innovations only mean something within the population that drew them, a genome from another one gets new ones
+    // Its genes then line up with no local gene, the genomes renumbered through the same map still line up together
+    void RenumberInnovations(std::unordered_map<int, int>& innovations)
+    {
+        for (Gene& gene : m_Genes)
+        {
+            auto [it, inserted] = innovations.try_emplace(gene.GetInnovation(), 0);
+            if (inserted)
+                it->second = GetNewInnovation();
+            gene.SetInnovation(it->second);
+        }
+    }
+
+    // Innovations drawn from firstInnovation on move by offset, as if the genome had been bred with the counter there
+    // Breeding only draws innovations and never reads them, so the genome is otherwise the same
+    void ShiftInnovations(int firstInnovation, int offset)
+    {
+        for (Gene& gene : m_Genes)
+        {
+            if (gene.GetInnovation() >= firstInnovation)
+                gene.SetInnovation(gene.GetInnovation() + offset);
+        }
+    }
+
     void UpdateGlobalRank(int globalRank) { m_GlobalRank = globalRank; }
     void SetScore(float score) { m_Score = score; }
+    // Place of the genome in the breeding of its generation, its episode is drawn from it wherever speciation puts the genome
+    void SetBirth(int birth) { m_Birth = birth; }
 
     static int GetInnovation() { return ms_Innovation; }
     static int GetNewInnovation() { return ms_Innovation++; }
     static void ResetInnovation() { ms_Innovation = 0; }
+    static void RestoreInnovation(int innovation) { ms_Innovation = innovation; }
 
     const std::vector<Gene>& GetGenes() const { return m_Genes; }
     const std::unordered_map<Mutations, float>& GetMutationChances() const { return m_MutationChances; }
@@ -253,22 +416,14 @@ public:
     int GetMaxNeurons() const { return m_MaxNeurons; }
     int GetGlobalRank() const { return m_GlobalRank; }
     float GetScore() const { return m_Score; }
+    int GetBirth() const { return m_Birth; }
 
 private:
     void PointMutate()
     {
-        float step = m_MutationChances[Mutations::Step];
-        for (Gene& gene : m_Genes)
-        {
-            if (BrainFramework::RandomFloat() < k_PerturbChance)
-            {
-                gene.SetWeight(gene.GetWeight() + BrainFramework::RandomFloat() * step * 2.0f - step);
-            }
-            else
-            {
-                gene.SetWeight(BrainFramework::RandomFloat() * 4.0f - 2.0f);
-            }
-        }
+        BrainFramework::MutateWeights(m_Genes.size(), k_PerturbChance, m_MutationChances[Mutations::Step],
+            [this](std::size_t i) { return m_Genes[i].GetWeight(); },
+            [this](std::size_t i, float weight) { m_Genes[i].SetWeight(weight); });
     }
 
     void LinkMutate(bool forceInputBias)
@@ -370,6 +525,7 @@ private:
     int m_MaxNeurons{ 0 };
     int m_GlobalRank{ 0 };
     float m_Score{ 0.0f };
+    int m_Birth{ 0 };
 
     static constexpr float k_PerturbChance = 0.90f;
     static constexpr float k_MutateConnectionsChance = 0.25f;
@@ -379,10 +535,110 @@ private:
     static constexpr float k_EnableMutationChance = 0.2f;
     static constexpr float k_DisableMutationChance = 0.4f;
     static constexpr float k_StepSize = 0.1f;
+    static constexpr float k_HashWeightScale = 65536.0f; // Weights are hashed in steps of 1 / 65536
+    static constexpr int k_MaxReadNeurons = 1 << 20;
+    static constexpr std::size_t k_MinGeneBytes = 3 + sizeof(float); // Three one byte varints and the weight
 
     static inline int ms_Innovation = 0;
 };
 
+// The innovations of a genome sorted once, it is then compared with every species without hashing its genes again
+class GeneIndex
+{
+public:
+    explicit GeneIndex(const Genome& genome)
+    {
+        const std::vector<Gene>& genes = genome.GetGenes();
+        m_Genes.reserve(genes.size());
+        for (const Gene& gene : genes)
+            m_Genes.push_back({ gene.GetInnovation(), gene.GetWeight() });
+
+        std::vector<std::pair<int, float>> sortedGenes = m_Genes;
+        std::stable_sort(sortedGenes.begin(), sortedGenes.end(), [](const std::pair<int, float>& a, const std::pair<int, float>& b) {
+            return a.first < b.first;
+        });
+
+        // A repeated innovation counts once per gene and weighs what its last gene weighs
+        for (const std::pair<int, float>& gene : sortedGenes)
+        {
+            if (!m_Innovations.empty() && m_Innovations.back().innovation == gene.first)
+            {
+                m_Innovations.back().genesCount++;
+                m_Innovations.back().weight = gene.second;
+            }
+            else
+            {
+                m_Innovations.push_back({ gene.first, 1, gene.second });
+            }
+        }
+    }
+
+    // Genes of each index that don't share an innovation with the other, over the genes of the largest
+    static float Disjoint(const GeneIndex& index1, const GeneIndex& index2)
+    {
+        int disjointGenes = 0;
+        std::size_t i1 = 0;
+        std::size_t i2 = 0;
+        while (i1 < index1.m_Innovations.size() || i2 < index2.m_Innovations.size())
+        {
+            if (i2 == index2.m_Innovations.size() || (i1 < index1.m_Innovations.size() && index1.m_Innovations[i1].innovation < index2.m_Innovations[i2].innovation))
+            {
+                disjointGenes += index1.m_Innovations[i1++].genesCount;
+            }
+            else if (i1 == index1.m_Innovations.size() || index2.m_Innovations[i2].innovation < index1.m_Innovations[i1].innovation)
+            {
+                disjointGenes += index2.m_Innovations[i2++].genesCount;
+            }
+            else
+            {
+                i1++;
+                i2++;
+            }
+        }
+
+        const int maxGenesCount = static_cast<int>(index1.m_Genes.size() > index2.m_Genes.size() ? index1.m_Genes.size() : index2.m_Genes.size());
+        return maxGenesCount > 0 ? static_cast<float>(disjointGenes) / maxGenesCount : 0.0f;
+    }
+
+    // Mean weight difference of the shared innovations, summed in the order of the genes of the first index
+    static float Weights(const GeneIndex& index1, const GeneIndex& index2)
+    {
+        float weightDifferenceSum = 0.0f;
+        int coincidentGenesCount = 0;
+
+        for (const std::pair<int, float>& gene : index1.m_Genes)
+        {
+            const Innovation* innovation = index2.Find(gene.first);
+            if (innovation != nullptr)
+            {
+                weightDifferenceSum += std::abs(gene.second - innovation->weight);
+                coincidentGenesCount++;
+            }
+        }
+
+        return coincidentGenesCount > 0 ? weightDifferenceSum / coincidentGenesCount : 0.0f;
+    }
+
+private:
+    struct Innovation
+    {
+        int innovation{ 0 };
+        int genesCount{ 0 };
+        float weight{ 0.0f };
+    };
+
+    const Innovation* Find(int innovation) const
+    {
+        auto it = std::lower_bound(m_Innovations.begin(), m_Innovations.end(), innovation, [](const Innovation& a, int b) {
+            return a.innovation < b;
+        });
+        return it != m_Innovations.end() && it->innovation == innovation ? &*it : nullptr;
+    }
+
+    std::vector<std::pair<int, float>> m_Genes; // Innovation and weight, in the order of the genes
+    std::vector<Innovation> m_Innovations; // Sorted
+};
+
 class Species
 {
 public:
@@ -390,16 +646,19 @@ public:
     //Species(const Species&) = delete;
     //Species& operator=(const Species&) = delete;
 
-    bool SameSpecies(const Genome& genome)
+    // The genome is compared with the first genome of the species
+    static bool SameSpecies(const GeneIndex& genome, const GeneIndex& firstGenome)
     {
         constexpr float k_DeltaDisjoint = 2.0f;
         constexpr float k_DeltaWeights = 0.4f;
         constexpr float k_DeltaThreshold = 1.0f;
 
-        const Genome& firstGenome = m_Genomes[0];
+        // The weights only add to the distance, they are left out of the genomes too disjoint already
+        float deltaDisjoint = k_DeltaDisjoint * GeneIndex::Disjoint(genome, firstGenome);
+        if (deltaDisjoint >= k_DeltaThreshold)
+            return false;
 
-        float deltaDisjoint = k_DeltaDisjoint * Disjoint(genome.GetGenes(), firstGenome.GetGenes());
-        float deltaWeights = k_DeltaWeights * Weights(genome.GetGenes(), firstGenome.GetGenes());
+        float deltaWeights = k_DeltaWeights * GeneIndex::Weights(genome, firstGenome);
         return deltaDisjoint + deltaWeights < k_DeltaThreshold;
     }
 
@@ -469,61 +728,11 @@ public:
 private:
     void SortGenomes()
     {
-        std::sort(m_Genomes.begin(), m_Genomes.end(), [](const Genome& a, const Genome& b) {
+        std::stable_sort(m_Genomes.begin(), m_Genomes.end(), [](const Genome& a, const Genome& b) {
             return a.GetScore() > b.GetScore();
         });
     }
 
-    static float Disjoint(const std::vector<Gene>& genes1, const std::vector<Gene>& genes2)
-    {
-        std::unordered_set<int> innovationSet1;
-        for (const Gene& gene : genes1)
-            innovationSet1.insert(gene.GetInnovation());
-
-        std::unordered_set<int> innovationSet2;
-        for (const Gene& gene : genes2)
-            innovationSet2.insert(gene.GetInnovation());
-
-        int disjointGenes = 0;
-        for (const Gene& gene : genes1)
-        {
-            if (innovationSet2.find(gene.GetInnovation()) == innovationSet2.end())
-                disjointGenes++;
-        }
-        for (const Gene& gene : genes2)
-        {
-            if (innovationSet1.find(gene.GetInnovation()) == innovationSet1.end())
-                disjointGenes++;
-        }
-
-        const int maxGenesCount = static_cast<int>(genes1.size() > genes2.size() ? genes1.size() : genes2.size());
-        return maxGenesCount > 0 ? static_cast<float>(disjointGenes) / maxGenesCount : 0.0f;
-    }
-
-    static float Weights(const std::vector<Gene>& genes1, const std::vector<Gene>& genes2)
-    {
-        std::unordered_map<int, const Gene*> innovationToGene;
-        for (const Gene& gene : genes2)
-        {
-            innovationToGene[gene.GetInnovation()] = &gene;
-        }
-
-        float weightDifferenceSum = 0.0f;
-        int coincidentGenesCount = 0;
-
-        for (const Gene& gene : genes1)
-        {
-            auto itr = innovationToGene.find(gene.GetInnovation());
-            if (itr != innovationToGene.end())
-            {
-                weightDifferenceSum += std::abs(gene.GetWeight() - itr->second->GetWeight());
-                coincidentGenesCount++;
-            }
-        }
-
-        return coincidentGenesCount > 0 ? weightDifferenceSum / coincidentGenesCount : 0.0f;
-    }
-
 private:
     std::vector<Genome> m_Genomes;
     float m_TopScore{ 0.0f };
@@ -540,20 +749,43 @@ public:
 
     const char* GetName() const override { return "NEAT"; }
 
+#ifndef BRAINFRAMEWORK_NO_IMGUI
     void DisplayImGui() override
     {
-        ImGui::Text("MaxScore: %f", GetMaxScore());
-        ImGui::Text("Generation: %d", GetGeneration());
-        ImGui::Text("Species: %d", static_cast<int>(GetSpecies().size()));
+        std::shared_ptr<const Stats> stats = m_Stats.Get();
+        if (stats == nullptr)
+            return;
 
-        int genomes = 0;
-        for (const Species& species : GetSpecies())
-        {
-            genomes += static_cast<int>(species.GetGenomes().size());
-        }
-        ImGui::Text("Genomes: %d", genomes);
+        ImGui::Text("MaxScore: %f", stats->maxScore);
+        ImGui::Text("Generation: %d", stats->generation);
+        ImGui::Text("Species: %d", stats->species);
+        ImGui::Text("Genomes: %d", stats->genomes);
+        ImGui::Text("Innovations: %d", stats->innovations);
+        ImGui::Text("CachedGenomes: %d", stats->cachedGenomes);
+        ImGui::Text("AdoptedChildren: %d", stats->adoptedChildren);
+        ImGui::Text("ReusedGenomes: %d", stats->reusedGenomes);
+
+        // A request shows until the training thread applied it
+        std::shared_ptr<const DisplaySettings> requestedSettings = m_RequestedSettings.Get();
+        DisplaySettings settings = requestedSettings != nullptr ? *requestedSettings : stats->settings;
+        bool changed = ImGui::SliderInt("FitnessCacheEvaluations", &settings.fitnessCacheEvaluations, 0, 10);
+        changed |= ImGui::Checkbox("Pipelined", &settings.pipelined);
+        if (changed)
+            m_RequestedSettings.Publish(settings);
+    }
+#endif
 
-        ImGui::Text("Innovations: %d", Genome::GetInnovation());
+    void ApplySettings() override
+    {
+        std::shared_ptr<const DisplaySettings> requestedSettings = m_RequestedSettings.Get();
+        if (requestedSettings == nullptr)
+            return;
+
+        m_FitnessCacheEvaluations = requestedSettings->fitnessCacheEvaluations;
+        m_Pipelined = requestedSettings->pipelined;
+
+        PublishStats();
+        m_RequestedSettings.Clear(requestedSettings);
     }
 
     bool PrepareTraining(const BrainFramework::ISimulation& simulation) override
@@ -562,25 +794,72 @@ public:
         {
             Reset();
 
+            const std::uint64_t generationSeed = GetGenerationSeed(m_Generation);
+            std::vector<Genome> genomes(k_Population);
             for (int i = 0; i < k_Population; ++i)
             {
-                Genome genome;
-                genome.Initialize(simulation.GetRLInputsCount(), simulation.GetRLOutputsCount());
-                genome.Mutate();
-                AddToSpecies(genome);
+                BrainFramework::RandomScope genomeScope(BrainFramework::DeriveSeed(generationSeed, i));
+                genomes[i].Initialize(simulation.GetRLInputsCount(), simulation.GetRLOutputsCount());
+                genomes[i].Mutate();
+                genomes[i].SetBirth(i);
             }
+            AddToSpecies(genomes);
+        }
+
+        m_Speculation.reset();
+        StartGeneration();
+        return true;
+    }
+
+    // Genomes are evaluated once, on the first episode of the node of their birth
+    std::uint64_t GetEvaluationSeed() const override
+    {
+        return GetEvaluationSeed(m_EvaluationIndex);
+    }
+
+    std::uint64_t GetEvaluationSeed(int evaluationIndex) const
+    {
+        return BrainFramework::DeriveSeed(BrainFramework::DeriveSeed(GetGenerationSeed(m_Generation), m_GenomeBirths[evaluationIndex]), 0);
+    }
+
+    bool SupportsBatch() const override { return true; }
+
+    // Every genome left in the generation, walked in the species order StartEvaluation follows
+    bool PrepareBatch(std::vector<BrainFramework::EvaluationJob>& jobs) override
+    {
+        jobs.clear();
+
+        int evaluationIndex = m_EvaluationIndex;
+        int firstGenome = m_CurrentGenome;
+        for (int i = m_CurrentSpecies; i < static_cast<int>(m_Species.size()); ++i)
+        {
+            const std::vector<Genome>& genomes = m_Species[i].GetGenomes();
+            for (int j = firstGenome; j < static_cast<int>(genomes.size()); ++j)
+            {
+                // Skipped the way NextGenome skips them
+                if (m_GenomeStates[evaluationIndex] != GenomeState::Pending)
+                {
+                    evaluationIndex++;
+                    continue;
+                }
+
+                BrainFramework::EvaluationJob& job = jobs.emplace_back();
+
+                FillJob(job, genomes[j], evaluationIndex++, nullptr);
+            }
+            firstGenome = 0;
         }
 
-        m_CurrentSpecies = 0;
-        m_CurrentGenome = 0;
         return true;
     }
 
-    bool StartEvaluation(std::unique_ptr<BrainFramework::NeuralNetwork>& neuralNetwork) override
+    bool StartEvaluation(std::shared_ptr<BrainFramework::NeuralNetwork>& neuralNetwork) override
     {
+        BrainFramework::PerfScope perfScope("NEAT::StartEvaluation");
+
         Genome& genome = m_Species[m_CurrentSpecies].GetGenomes()[m_CurrentGenome];
 
-        std::unique_ptr<BrainFramework::BasicNeuralNetwork> basicNeuralNetwork = std::make_unique<BrainFramework::BasicNeuralNetwork>();
+        std::shared_ptr<BrainFramework::BasicNeuralNetwork> basicNeuralNetwork = std::make_shared<BrainFramework::BasicNeuralNetwork>();
         if (!genome.MakeNeuralNetwork(*basicNeuralNetwork))
         {
             return false;
@@ -593,17 +872,59 @@ public:
 
     bool EndEvalutation(float result) override
     {
-        Genome& genome = m_Species[m_CurrentSpecies].GetGenomes()[m_CurrentGenome];
-        genome.SetScore(result);
-
+        CompleteGenome(m_Species[m_CurrentSpecies].GetGenomes()[m_CurrentGenome], m_EvaluationIndex, result);
         NextGenome();
 
         return true;
     }
 
-    bool MakeBestNeuralNetwork(std::unique_ptr<BrainFramework::NeuralNetwork>& neuralNetwork, int index = 0) override
+    // Pipelined generations: once only the slowest genomes of a generation are still playing, idle workers breed the next one
+    // from a guess of their scores and start on its children, the generation commits when the last result arrives
+    // The final selection takes every speculative child bred from the same parents at the same place and breeds the others,
+    // a taken child plays the episode of its birth wherever it lands, so the population evolves exactly as it would without the pipeline
+    bool SupportsAsync() const override { return m_Pipelined; }
+
+    bool AcquireJob(BrainFramework::EvaluationJob& job) override
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        if (AcquireGenome(job, nullptr))
+            return true;
+
+        if (!m_Pipelined || m_PendingGenomes == 0)
+            return false;
+
+        if (m_Speculation == nullptr)
+            Speculate();
+
+        return m_Speculation->AcquireGenome(job, m_Speculation);
+    }
+
+    bool CompleteJob(BrainFramework::EvaluationJob& job) override
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        const float result = job.results.empty() ? 0.0f : job.results[0];
+        auto adopted = m_AdoptedJobs.find(job.key);
+        const int slot = adopted != m_AdoptedJobs.end() ? adopted->second : job.slot;
+        if (IsAwaited(slot, job.key))
+        {
+            CompleteGenome(GetGenome(slot), slot, result);
+            if (m_PendingGenomes == 0)
+                EndGeneration();
+        }
+        else if (m_Speculation != nullptr && m_Speculation->IsAwaited(job.slot, job.key))
+        {
+            m_Speculation->CompleteGenome(m_Speculation->GetGenome(job.slot), job.slot, result);
+        }
+
+        // Otherwise the child was bred from a wrong guess and its result is dropped
+        return true;
+    }
+
+    bool MakeBestNeuralNetwork(std::shared_ptr<BrainFramework::NeuralNetwork>& neuralNetwork, int index = 0) override
     {
-        std::unique_ptr<BrainFramework::BasicNeuralNetwork> basicNeuralNetwork = std::make_unique<BrainFramework::BasicNeuralNetwork>();
+        std::shared_ptr<BrainFramework::BasicNeuralNetwork> basicNeuralNetwork = std::make_shared<BrainFramework::BasicNeuralNetwork>();
         const bool result = m_BestGenome.MakeNeuralNetwork(*basicNeuralNetwork);
 
         neuralNetwork = std::move(basicNeuralNetwork);
@@ -611,44 +932,448 @@ public:
         return result;
     }
 
+    // The best species champions leave, arrivals take the place of the children bred last and the generation is planned again
+    bool SupportsMigration() const override { return true; }
+
+    void WriteMigrants(int count, BrainFramework::ByteWriter& writer) const override
+    {
+        std::vector<const Genome*> champions;
+        for (int i = 0; i < std::min(m_ScoredSpecies, static_cast<int>(m_Species.size())); ++i)
+        {
+            champions.push_back(&m_Species[i].GetGenomes()[0]);
+        }
+        std::stable_sort(champions.begin(), champions.end(), [](const Genome* a, const Genome* b) {
+            return a->GetScore() > b->GetScore();
+        });
+
+        const int migrants = std::clamp(count, 0, static_cast<int>(champions.size()));
+        writer.Write(static_cast<std::uint32_t>(migrants));
+        for (int i = 0; i < migrants; ++i)
+        {
+            champions[i]->Write(writer);
+        }
+    }
+
+    int ReadMigrants(BrainFramework::ByteReader& reader) override
+    {
+        std::uint32_t count = 0;
+        if (m_Species.empty() || !reader.Read(count))
+            return 0;
+
+        const Genome& local = m_Species[0].GetGenomes()[0];
+        std::vector<Genome> arrivals;
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            Genome arrival;
+            if (!arrival.Read(reader) || arrival.GetInputs() != local.GetInputs() || arrival.GetOutputs() != local.GetOutputs())
+                break;
+
+            arrivals.push_back(std::move(arrival));
+        }
+
+        // Children leave from the last species, which loses its first genome too unless it's a champion
+        int departures = 0;
+        for (int i = static_cast<int>(m_Species.size()) - 1; i >= 0 && departures < static_cast<int>(arrivals.size()); --i)
+        {
+            std::vector<Genome>& genomes = m_Species[i].GetGenomes();
+            const int kept = i < m_ScoredSpecies ? 1 : 0;
+            while (static_cast<int>(genomes.size()) > kept && departures < static_cast<int>(arrivals.size()))
+            {
+                genomes.pop_back();
+                departures++;
+            }
+            if (genomes.empty())
+                m_Species.erase(m_Species.begin() + i);
+        }
+        arrivals.resize(departures);
+
+        std::unordered_map<int, int> innovations;
+        for (int i = 0; i < static_cast<int>(arrivals.size()); ++i)
+        {
+            arrivals[i].RenumberInnovations(innovations);
+            arrivals[i].SetBirth(k_FirstArrivalBirth + i);
+        }
+        AddToSpecies(arrivals);
+
+        m_Speculation.reset();
+        StartGeneration();
+        return departures;
+    }
+
+    // Genomes travel whole in the compact encoding of Write, a few bytes per gene
+    std::shared_ptr<BrainFramework::RemoteGenome> ReadRemoteGenome(BrainFramework::ByteReader& reader) const override
+    {
+        std::shared_ptr<BrainFramework::RemoteGenomeOf<Genome, BrainFramework::BasicNeuralNetwork>> remoteGenome = std::make_shared<BrainFramework::RemoteGenomeOf<Genome, BrainFramework::BasicNeuralNetwork>>();
+        if (!remoteGenome->genome.Read(reader))
+            return nullptr;
+
+        return remoteGenome;
+    }
+
     void Reset()
     {
         Genome::ResetInnovation();
         m_Species.clear();
+        m_ScoredSpecies = 0;
     }
 
+    // Moves to the next genome that needs a simulation, genomes with a cached fitness are skipped
     void NextGenome()
     {
-        m_CurrentGenome++;
-        if (m_CurrentGenome >= static_cast<int>(m_Species[m_CurrentSpecies].GetGenomes().size()))
+        if (!AdvanceGenome())
+            EndGeneration();
+    }
+
+    // False once the walk is past the last genome, it then waits there for the generation to end
+    bool AdvanceGenome()
+    {
+        do
+        {
+            m_EvaluationIndex++;
+            m_CurrentGenome++;
+            if (m_CurrentGenome >= static_cast<int>(m_Species[m_CurrentSpecies].GetGenomes().size()))
+            {
+                m_CurrentGenome = 0;
+                m_CurrentSpecies++;
+                if (m_CurrentSpecies >= static_cast<int>(m_Species.size()))
+                    return false;
+            }
+        } while (m_GenomeStates[m_EvaluationIndex] != GenomeState::Pending);
+        return true;
+    }
+
+    // Plans the generation and points the walk at its first genome to simulate
+    void StartGeneration()
+    {
+        PlanEvaluations();
+        AdoptSpeculation();
+
+        m_CurrentSpecies = 0;
+        m_CurrentGenome = 0;
+        m_EvaluationIndex = 0;
+        PublishStats();
+        if (m_GenomeStates[m_EvaluationIndex] != GenomeState::Pending && !AdvanceGenome() && m_PendingGenomes == 0)
+            EndGeneration();
+    }
+
+    // Copies what DisplayImGui shows, at the start of every generation
+    void PublishStats()
+    {
+        Stats stats;
+        stats.maxScore = m_MaxScore;
+        stats.generation = m_Generation;
+        stats.species = static_cast<int>(m_Species.size());
+        stats.genomes = static_cast<int>(m_GenomeStates.size());
+        stats.innovations = Genome::GetInnovation();
+        stats.cachedGenomes = m_CachedGenomes;
+        stats.adoptedChildren = m_AdoptedChildren;
+        stats.reusedGenomes = m_ReusedGenomes;
+        stats.settings = { m_FitnessCacheEvaluations, m_Pipelined };
+        m_Stats.Publish(std::move(stats));
+    }
+
+    void EndGeneration()
+    {
+        ApplyCachedScores();
+        NewGeneration();
+        StartGeneration();
+    }
+
+    // Decides, in evaluation order, which genomes of the generation are simulated
+    // A structure is simulated once per generation, until the cache holds m_FitnessCacheEvaluations results for it
+    // Its duplicates and the structures with enough results skip the simulation, structures gone from the population are forgotten
+    void PlanEvaluations()
+    {
+        BrainFramework::PerfScope perfScope("NEAT::PlanEvaluations");
+
+        m_GenerationCacheEvaluations = m_FitnessCacheEvaluations;
+        m_GenomeHashes.clear();
+        m_GenomeBirths.clear();
+        m_GenomeStates.clear();
+        m_CachedGenomes = 0;
+        m_PendingGenomes = 0;
+
+        std::unordered_map<BrainFramework::Hash128, CachedFitness, BrainFramework::Hash128::Hasher> fitnessCache;
+        fitnessCache.reserve(k_Population);
+        for (const Species& species : m_Species)
         {
-            m_CurrentGenome = 0;
-            m_CurrentSpecies++;
-            if (m_CurrentSpecies >= static_cast<int>(m_Species.size()))
+            for (const Genome& genome : species.GetGenomes())
             {
-                m_CurrentSpecies = 0;
-                NewGeneration();
+                // Hashed even without the cache, pipelined generations match their children on it
+                const BrainFramework::Hash128 hash = genome.GetStructureHash();
+                m_GenomeHashes.push_back(hash);
+                m_GenomeBirths.push_back(genome.GetBirth());
+                if (m_GenerationCacheEvaluations <= 0)
+                {
+                    m_GenomeStates.push_back(GenomeState::Pending);
+                    m_PendingGenomes++;
+                    continue;
+                }
+
+                bool evaluate = false;
+                auto [it, inserted] = fitnessCache.try_emplace(hash);
+                if (inserted)
+                {
+                    auto previous = m_FitnessCache.find(hash);
+                    if (previous != m_FitnessCache.end())
+                        it->second = previous->second;
+                    evaluate = it->second.evaluations < m_GenerationCacheEvaluations;
+                }
+
+                m_GenomeStates.push_back(evaluate ? GenomeState::Pending : GenomeState::Cached);
+                if (evaluate)
+                    m_PendingGenomes++;
+                else
+                    m_CachedGenomes++;
             }
         }
+        m_FitnessCache.swap(fitnessCache);
     }
 
-    void AddToSpecies(const Genome& genome)
+    // Every genome is scored on the mean of all the results of its structure, simulated or not this generation
+    void ApplyCachedScores()
     {
+        if (m_GenerationCacheEvaluations <= 0)
+            return;
+
+        int evaluationIndex = 0;
         for (Species& species : m_Species)
         {
-            if (species.SameSpecies(genome))
+            for (Genome& genome : species.GetGenomes())
             {
-                species.GetGenomes().push_back(genome);
-                return;
+                const CachedFitness& cachedFitness = m_FitnessCache[m_GenomeHashes[evaluationIndex++]];
+                if (cachedFitness.evaluations > 0)
+                    genome.SetScore(cachedFitness.scoreSum / cachedFitness.evaluations);
             }
         }
-        
-        Species& species = m_Species.emplace_back();
-        species.GetGenomes().push_back(genome);
+    }
+
+    void CompleteGenome(Genome& genome, int evaluationIndex, float result)
+    {
+        genome.SetScore(result);
+
+        if (m_GenerationCacheEvaluations > 0)
+        {
+            CachedFitness& cachedFitness = m_FitnessCache[m_GenomeHashes[evaluationIndex]];
+            cachedFitness.scoreSum += result;
+            cachedFitness.evaluations++;
+        }
+
+        m_GenomeStates[evaluationIndex] = GenomeState::Done;
+        m_PendingGenomes--;
+    }
+
+    // Breeds the next generation on a copy of the model, the genomes still playing are guessed at their cached fitness
+    // or at the median of the results of the generation
+    void Speculate()
+    {
+        BrainFramework::PerfScope perfScope("NEAT::Speculate");
+
+        std::vector<Genome*> genomes = GetGenomes();
+        std::vector<float> results;
+        for (int i = 0; i < static_cast<int>(genomes.size()); ++i)
+        {
+            if (m_GenomeStates[i] == GenomeState::Done)
+                results.push_back(genomes[i]->GetScore());
+        }
+        float median = 0.0f;
+        if (!results.empty())
+        {
+            std::nth_element(results.begin(), results.begin() + results.size() / 2, results.end());
+            median = results[results.size() / 2];
+        }
+
+        std::shared_ptr<NEATModel> speculation = std::make_shared<NEATModel>();
+        speculation->CopyGenerationFrom(*this);
+        std::vector<Genome*> speculationGenomes = speculation->GetGenomes();
+        for (int i = 0; i < static_cast<int>(genomes.size()); ++i)
+        {
+            if (m_GenomeStates[i] != GenomeState::Running)
+                continue;
+
+            auto it = m_FitnessCache.find(m_GenomeHashes[i]);
+            const bool cached = m_GenerationCacheEvaluations > 0 && it != m_FitnessCache.end() && it->second.evaluations > 0;
+            speculation->CompleteGenome(*speculationGenomes[i], i, cached ? it->second.scoreSum / it->second.evaluations : median);
+        }
+
+        // The committed generation draws the same innovations again
+        const int innovation = Genome::GetInnovation();
+        speculation->EndGeneration();
+        Genome::RestoreInnovation(innovation);
+
+        m_Speculation = std::move(speculation);
+    }
+
+    // Keeps the results of the speculative generation wherever it bred the same genome at the same birth, which plays the same episode
+    void AdoptSpeculation()
+    {
+        std::shared_ptr<NEATModel> speculation = std::move(m_Speculation);
+        m_AdoptedJobs.clear();
+        m_ReusedGenomes = 0;
+        if (speculation == nullptr || speculation->m_Generation != m_Generation)
+            return;
+
+        std::unordered_map<int, int> speculationSlots;
+        speculationSlots.reserve(speculation->m_GenomeBirths.size());
+        for (int i = 0; i < static_cast<int>(speculation->m_GenomeBirths.size()); ++i)
+            speculationSlots.emplace(speculation->m_GenomeBirths[i], i);
+
+        for (int i = 0; i < static_cast<int>(m_GenomeStates.size()); ++i)
+        {
+            auto it = speculationSlots.find(m_GenomeBirths[i]);
+            if (m_GenomeStates[i] != GenomeState::Pending || it == speculationSlots.end() || m_GenomeHashes[i] != speculation->m_GenomeHashes[it->second])
+                continue;
+
+            const int slot = it->second;
+            if (speculation->m_GenomeStates[slot] == GenomeState::Done)
+            {
+                CompleteGenome(GetGenome(i), i, speculation->GetGenome(slot).GetScore());
+                m_ReusedGenomes++;
+            }
+            else if (speculation->m_GenomeStates[slot] == GenomeState::Running)
+            {
+                // Still playing, CompleteJob takes its result as this generation's
+                m_GenomeStates[i] = GenomeState::Running;
+                m_AdoptedJobs.emplace(speculation->GetJobKey(slot), i);
+                m_ReusedGenomes++;
+            }
+        }
+    }
+
+    // Hands out the genome the walk points at, false once the walk waits at the end of the generation
+    // The owner keeps a speculative model alive for as long as the job may read its genome
+    bool AcquireGenome(BrainFramework::EvaluationJob& job, std::shared_ptr<const NEATModel> owner)
+    {
+        if (m_CurrentSpecies >= static_cast<int>(m_Species.size()))
+            return false;
+
+        FillJob(job, m_Species[m_CurrentSpecies].GetGenomes()[m_CurrentGenome], m_EvaluationIndex, std::move(owner));
+        m_GenomeStates[m_EvaluationIndex] = GenomeState::Running;
+        AdvanceGenome();
+        return true;
+    }
+
+    void FillJob(BrainFramework::EvaluationJob& job, const Genome& genome, int evaluationIndex, std::shared_ptr<const NEATModel> owner) const
+    {
+        job.makeNeuralNetwork = [genome = &genome, owner = std::move(owner)](std::shared_ptr<BrainFramework::NeuralNetwork>& neuralNetwork)
+        {
+            std::shared_ptr<BrainFramework::BasicNeuralNetwork> basicNeuralNetwork = std::make_shared<BrainFramework::BasicNeuralNetwork>();
+            if (!genome->MakeNeuralNetwork(*basicNeuralNetwork))
+            {
+                return false;
+            }
+
+            neuralNetwork = std::move(basicNeuralNetwork);
+            return true;
+        };
+        job.describeGenome = [genome = &genome, key = Genome::MakeKey(m_GenomeHashes[evaluationIndex])](BrainFramework::GenomeDescription& description, bool writeBytes)
+        {
+            genome->Describe(description, key, writeBytes);
+        };
+        job.evaluationSeeds.assign(1, GetEvaluationSeed(evaluationIndex));
+        job.results.clear();
+        job.slot = evaluationIndex;
+        job.key = GetJobKey(evaluationIndex);
+    }
+
+    // The generation, the birth and the structure of the genome, the same key means the same genome playing the same episode
+    std::uint64_t GetJobKey(int evaluationIndex) const
+    {
+        const BrainFramework::Hash128& hash = m_GenomeHashes[evaluationIndex];
+        return BrainFramework::DeriveSeed(BrainFramework::DeriveSeed(hash.low ^ hash.high, static_cast<std::uint64_t>(m_Generation)), static_cast<std::uint64_t>(m_GenomeBirths[evaluationIndex]));
+    }
+
+    bool IsAwaited(int slot, std::uint64_t key) const
+    {
+        return slot >= 0 && slot < static_cast<int>(m_GenomeStates.size())
+            && m_GenomeStates[slot] == GenomeState::Running && key == GetJobKey(slot);
+    }
+
+    // Every genome, in evaluation order
+    std::vector<Genome*> GetGenomes()
+    {
+        std::vector<Genome*> genomes;
+        genomes.reserve(k_Population);
+        for (Species& species : m_Species)
+        {
+            for (Genome& genome : species.GetGenomes())
+            {
+                genomes.push_back(&genome);
+            }
+        }
+        return genomes;
+    }
+
+    Genome& GetGenome(int evaluationIndex)
+    {
+        for (Species& species : m_Species)
+        {
+            std::vector<Genome>& genomes = species.GetGenomes();
+            if (evaluationIndex < static_cast<int>(genomes.size()))
+                return genomes[evaluationIndex];
+            evaluationIndex -= static_cast<int>(genomes.size());
+        }
+        return m_BestGenome;
+    }
+
+    // Everything the end of the generation reads, the copy is then bred on its own
+    void CopyGenerationFrom(const NEATModel& other)
+    {
+        m_Seed = other.m_Seed;
+        m_BestGenome.CopyFrom(other.m_BestGenome);
+        m_Species = other.m_Species;
+        m_ScoredSpecies = other.m_ScoredSpecies;
+        m_MaxScore = other.m_MaxScore;
+        m_Generation = other.m_Generation;
+        m_CurrentSpecies = static_cast<int>(m_Species.size());
+        m_FitnessCache = other.m_FitnessCache;
+        m_GenomeHashes = other.m_GenomeHashes;
+        m_GenomeBirths = other.m_GenomeBirths;
+        m_GenomeStates = other.m_GenomeStates;
+        m_FitnessCacheEvaluations = other.m_FitnessCacheEvaluations;
+        m_GenerationCacheEvaluations = other.m_GenerationCacheEvaluations;
+        m_CachedGenomes = other.m_CachedGenomes;
+        m_PendingGenomes = other.m_PendingGenomes;
+        m_Pipelined = false;
+        m_Speculative = true;
+    }
+
+    // Each genome joins the first species close enough to it, or starts a new one
+    // The first genome of every species is indexed once for all of them
+    void AddToSpecies(std::vector<Genome>& genomes)
+    {
+        BrainFramework::PerfScope perfScope("NEAT::AddToSpecies");
+
+        std::vector<GeneIndex> firstGenomes;
+        firstGenomes.reserve(m_Species.size() + genomes.size());
+        for (const Species& species : m_Species)
+            firstGenomes.emplace_back(species.GetGenomes()[0]);
+
+        for (Genome& genome : genomes)
+        {
+            GeneIndex geneIndex(genome);
+            auto it = std::find_if(firstGenomes.begin(), firstGenomes.end(), [&](const GeneIndex& firstGenome) {
+                return Species::SameSpecies(geneIndex, firstGenome);
+            });
+            if (it != firstGenomes.end())
+            {
+                m_Species[it - firstGenomes.begin()].GetGenomes().push_back(std::move(genome));
+                continue;
+            }
+
+            m_Species.emplace_back().GetGenomes().push_back(std::move(genome));
+            firstGenomes.push_back(std::move(geneIndex));
+        }
     }
 
     void NewGeneration()
     {
+        BrainFramework::PerfScope perfScope("NEAT::NewGeneration");
+
+        // Generation wide decisions draw from the generation node, each child from its own node
+        const std::uint64_t generationSeed = GetGenerationSeed(m_Generation + 1);
+        BrainFramework::RandomScope generationScope(generationSeed);
+
         m_MaxScore = k_ResetMaxScore;
         for (Species& species : m_Species)
         {
@@ -661,6 +1386,10 @@ public:
         for (Species& species : m_Species)
             species.CullSpecies(false);
 
+        // Children are born at the place of their species in this generation, whichever species the selection removes
+        std::vector<int> speciesPlaces(m_Species.size());
+        std::iota(speciesPlaces.begin(), speciesPlaces.end(), 0);
+
         // Remove Stale Species
         constexpr int k_StaleSpecies = 15;
         for (int i = static_cast<int>(m_Species.size()) - 1; i >= 0; --i)
@@ -669,6 +1398,7 @@ public:
             if (species.GetStaleness() >= k_StaleSpecies && species.GetTopScore() < m_MaxScore)
             {
                 m_Species.erase(m_Species.begin() + i);
+                speciesPlaces.erase(speciesPlaces.begin() + i);
             }
         }
 
@@ -684,6 +1414,7 @@ public:
             if (breedCount <= 0 && m_Species.size() > 1)
             {
                 m_Species.erase(m_Species.begin() + i);
+                speciesPlaces.erase(speciesPlaces.begin() + i);
             }
         }
 
@@ -692,14 +1423,21 @@ public:
         totalAverageFitness = 0.0f;
         for (Species& species : m_Species)
             totalAverageFitness += species.CalculateAverageFitness();
+        // A speculation of this very generation hands over the children it bred the same way
+        const NEATModel* speculation = m_Speculation != nullptr && m_Speculation->m_Generation == m_Generation + 1 ? m_Speculation.get() : nullptr;
+        m_BredParents.clear();
+        m_BredChildren.clear();
+        m_AdoptedChildren = 0;
+
         std::vector<Genome> children;
-        for (const Species& species : m_Species)
+        for (int i = 0; i < static_cast<int>(m_Species.size()); ++i)
         {
+            const Species& species = m_Species[i];
             const int breedCount = static_cast<int>(std::floor(species.GetAverageFitness() / totalAverageFitness * k_Population) - 1);
-            for (int i = 0; i < breedCount; ++i)
+            const int parents = breedCount > 0 ? AddParents(species) : -1;
+            for (int j = 0; j < breedCount; ++j)
             {
-                Genome& child = children.emplace_back();
-                species.BreedChild(child);
+                BreedChild(children, species, parents, speciesPlaces[i] * k_Population + j, generationSeed, speculation);
             }
         }
 
@@ -708,20 +1446,61 @@ public:
             species.CullSpecies(true);
 
         // Complete from the very best
-        while (static_cast<int>(children.size() + m_Species.size()) < k_Population)
+        std::vector<int> championParents(m_Species.size(), -1);
+        for (int completion = 0; static_cast<int>(children.size() + m_Species.size()) < k_Population; ++completion)
         {
             const int speciesIndex = BrainFramework::RandomIndex(m_Species);
-            Genome& child = children.emplace_back();
-            m_Species[speciesIndex].BreedChild(child);
+            if (championParents[speciesIndex] < 0)
+                championParents[speciesIndex] = AddParents(m_Species[speciesIndex]);
+            BreedChild(children, m_Species[speciesIndex], championParents[speciesIndex], k_FirstCompletionBirth + completion, generationSeed, speculation);
         }
 
-        // Add to the species
-        for (Genome& genome : children)
+        // The champions play again, on episodes born after every child
+        for (int i = 0; i < static_cast<int>(m_Species.size()); ++i)
+            m_Species[i].GetGenomes()[0].SetBirth(k_FirstChampionBirth + i);
+
+        // Add to the species, the champions keep the score they were selected on
+        m_ScoredSpecies = static_cast<int>(m_Species.size());
+        AddToSpecies(children);
+
+        m_Generation++;
+    }
+
+    // Birth and score of every genome a child of the species may be bred from, in the order it picks them
+    int AddParents(const Species& species)
+    {
+        std::vector<std::pair<int, float>>& parents = m_BredParents.emplace_back();
+        for (const Genome& genome : species.GetGenomes())
         {
-            AddToSpecies(genome);
+            parents.emplace_back(genome.GetBirth(), genome.GetScore());
         }
+        return static_cast<int>(m_BredParents.size()) - 1;
+    }
 
-        m_Generation++;
+    // Breeds a child of the generation, or takes the one the speculation bred at the same birth from the same parents
+    // The seed of a child only depends on its birth, the taken child gets the innovations it would have drawn here
+    void BreedChild(std::vector<Genome>& children, const Species& species, int parents, int birth, std::uint64_t generationSeed, const NEATModel* speculation)
+    {
+        const int firstInnovation = Genome::GetInnovation();
+        Genome& child = children.emplace_back();
+
+        auto bredChild = speculation != nullptr ? speculation->m_BredChildren.find(birth) : m_BredChildren.end();
+        if (speculation != nullptr && bredChild != speculation->m_BredChildren.end() && speculation->m_BredParents[bredChild->second.parents] == m_BredParents[parents])
+        {
+            child = bredChild->second.genome;
+            child.ShiftInnovations(bredChild->second.firstInnovation, firstInnovation - bredChild->second.firstInnovation);
+            Genome::RestoreInnovation(firstInnovation + bredChild->second.innovations);
+            m_AdoptedChildren++;
+        }
+        else
+        {
+            BrainFramework::RandomScope childScope(BrainFramework::DeriveSeed(generationSeed, birth));
+            species.BreedChild(child);
+            child.SetBirth(birth);
+        }
+
+        if (m_Speculative)
+            m_BredChildren.emplace(birth, BredChild{ parents, firstInnovation, Genome::GetInnovation() - firstInnovation, child });
     }
 
     void RankGlobally()
@@ -736,7 +1515,8 @@ public:
             }
         }
 
-        std::sort(allGenomes.begin(), allGenomes.end(), [](const Genome* a, const Genome* b) {
+        // Stable so ties keep the species order, whatever order the scores came in
+        std::stable_sort(allGenomes.begin(), allGenomes.end(), [](const Genome* a, const Genome* b) {
             return a->GetScore() < b->GetScore();
         });
 
@@ -752,18 +1532,104 @@ public:
 
     float GetMaxScore() const { return m_MaxScore; }
     int GetGeneration() const { return m_Generation; }
+
+    // 0 simulates every genome every generation, 1 fits deterministic simulations, noisy ones average up to that many results
+    void SetFitnessCacheEvaluations(int fitnessCacheEvaluations) { m_FitnessCacheEvaluations = fitnessCacheEvaluations; }
+    int GetFitnessCacheEvaluations() const { return m_FitnessCacheEvaluations; }
+    int GetCachedGenomes() const { return m_CachedGenomes; }
+    void SetPipelined(bool pipelined) { m_Pipelined = pipelined; }
+    bool IsPipelined() const { return m_Pipelined; }
+    // Children of the last generation taken from its speculative breeding, and the genomes whose results came with them
+    int GetAdoptedChildren() const { return m_AdoptedChildren; }
+    int GetReusedGenomes() const { return m_ReusedGenomes; }
     const std::vector<Species>& GetSpecies() const { return m_Species; }
 
     static constexpr int k_Population = 300;
     static constexpr float k_ResetMaxScore = -100000.0f;
+    static constexpr int k_FitnessCacheEvaluations = 4; // Results a structure gathers over generations before it stops being simulated
 
 private:
+    struct CachedFitness
+    {
+        float scoreSum{ 0.0f };
+        int evaluations{ 0 };
+    };
+
+    // Settings DisplayImGui can change
+    struct DisplaySettings
+    {
+        int fitnessCacheEvaluations{ 0 };
+        bool pipelined{ false };
+    };
+
+    // What DisplayImGui shows, the training thread publishes a new copy and never changes a published one
+    struct Stats
+    {
+        float maxScore{ 0.0f };
+        int generation{ 0 };
+        int species{ 0 };
+        int genomes{ 0 };
+        int innovations{ 0 };
+        int cachedGenomes{ 0 };
+        int adoptedChildren{ 0 };
+        int reusedGenomes{ 0 };
+        DisplaySettings settings;
+    };
+
+    // A child the speculative generation bred, with what the final selection must breed it from to take it
+    struct BredChild
+    {
+        int parents{ 0 }; // In m_BredParents
+        int firstInnovation{ 0 };
+        int innovations{ 0 }; // Drawn by its breeding
+        Genome genome;
+    };
+
+    // The children of the species at place s are born from s * k_Population on, the other genomes after all of them
+    static constexpr int k_FirstCompletionBirth = k_Population * k_Population;
+    static constexpr int k_FirstChampionBirth = k_FirstCompletionBirth + k_Population;
+    static constexpr int k_FirstArrivalBirth = k_FirstChampionBirth + k_Population;
+
+    enum class GenomeState : std::uint8_t
+    {
+        Cached, // Scored from the fitness cache, never simulated this generation
+        Pending,
+        Running,
+        Done
+    };
+
     Genome m_BestGenome;
     std::vector<Species> m_Species;
+    int m_ScoredSpecies{ 0 }; // Species that outlived the last generation, their first genome is its champion
     float m_MaxScore{ k_ResetMaxScore };
     int m_Generation{ 0 };
     int m_CurrentSpecies{ 0 };
     int m_CurrentGenome{ 0 };
+    int m_EvaluationIndex{ 0 };
+
+    // Keyed on Genome::GetStructureHash, the per genome vectors are indexed like the evaluations
+    std::unordered_map<BrainFramework::Hash128, CachedFitness, BrainFramework::Hash128::Hasher> m_FitnessCache;
+    std::vector<BrainFramework::Hash128> m_GenomeHashes;
+    std::vector<int> m_GenomeBirths;
+    std::vector<GenomeState> m_GenomeStates;
+    int m_FitnessCacheEvaluations{ k_FitnessCacheEvaluations };
+    int m_GenerationCacheEvaluations{ 0 };
+    int m_CachedGenomes{ 0 };
+    int m_PendingGenomes{ 0 }; // Simulated genomes still waiting for their result
+
+    // Async jobs go through the mutex, the sequential and batch APIs don't
+    std::mutex m_Mutex;
+    bool m_Pipelined{ false };
+    std::shared_ptr<NEATModel> m_Speculation; // Next generation, bred while the slowest genomes of this one play
+    bool m_Speculative{ false }; // Keeps the children it breeds in m_BredChildren
+    std::vector<std::vector<std::pair<int, float>>> m_BredParents;
+    std::unordered_map<int, BredChild> m_BredChildren; // By birth
+    std::unordered_map<std::uint64_t, int> m_AdoptedJobs; // Speculative jobs still playing a genome of this generation, by key
+    int m_AdoptedChildren{ 0 };
+    int m_ReusedGenomes{ 0 };
+
+    BrainFramework::AtomicSnapshot<Stats> m_Stats;
+    BrainFramework::AtomicSnapshot<DisplaySettings> m_RequestedSettings;
 };
 
 } // namespace NEAT
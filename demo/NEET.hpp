@@ -75,6 +75,8 @@ public:
 
     void CopyFrom(const Genome& other)
     {
+        m_NeuralNetwork.reset();
+
         m_Inputs = other.m_Inputs;
         m_Outputs = other.m_Outputs;
         m_MaxNeurons = other.m_MaxNeurons;
@@ -93,6 +95,8 @@ public:
         m_MutationChances[Mutations::Enable] = other.m_MutationChances.at(Mutations::Enable);
         m_MutationChances[Mutations::Disable] = other.m_MutationChances.at(Mutations::Disable);
         m_MutationChances[Mutations::Step] = other.m_MutationChances.at(Mutations::Step);
+
+        m_Key = other.m_Key;
     }
 
     void Crossover(const Genome& genome1, const Genome& genome2)
@@ -107,6 +111,8 @@ public:
         assert(genome1.m_Inputs == genome2.m_Inputs);
         assert(genome1.m_Outputs == genome2.m_Outputs);
 
+        m_NeuralNetwork.reset();
+
         m_Inputs = genome1.m_Inputs;
         m_Outputs = genome1.m_Outputs;
         m_MaxNeurons = (genome1.m_MaxNeurons > genome2.m_MaxNeurons) ? genome1.m_MaxNeurons : genome2.m_MaxNeurons;
@@ -148,10 +154,14 @@ public:
             const Mutations mut = static_cast<Mutations>(i);
             m_MutationChances[mut] = BrainFramework::RandomBool() ? genome1.m_MutationChances.at(mut) : genome2.m_MutationChances.at(mut);
         }
+
+        OnChanged();
     }
 
     void Initialize(int inputs, int outputs)
     {
+        m_NeuralNetwork.reset();
+
         m_Inputs = inputs;
         m_Outputs = outputs;
         m_MaxNeurons = m_Inputs + m_Outputs;
@@ -163,14 +173,18 @@ public:
                 if (BrainFramework::RandomBool())
                     m_Genes.emplace_back(i, o + m_Inputs, BrainFramework::RandomFloat() * 4.0f - 2.0f, true);
         */
+
+        OnChanged();
     }
 
     void Mutate()
     {
+        m_NeuralNetwork.reset();
+
         // Alterate mutation chances
         for (auto& mutationChance : m_MutationChances)
         {
-            mutationChance.second *= (rand() % 2 == 0) ? 0.95f : 1.05263f;
+            mutationChance.second *= BrainFramework::RandomBool() ? 0.95f : 1.05263f;
         }
 
         if (BrainFramework::RandomFloat() < m_MutationChances[Mutations::Connections])
@@ -215,6 +229,8 @@ public:
                 EnableDisableMutate(false);
             p -= 1.0f;
         }
+
+        OnChanged();
     }
 
     bool MakeNeuralNetwork(BrainFramework::BasicNeuralNetwork& neuralNetwork) const
@@ -259,6 +275,23 @@ public:
         return neuralNetwork.Make(m_Inputs, m_Outputs, std::move(neurons));
     }
 
+    // Built on first use and kept until the genes change, callers clear its values before each episode
+    // Only one thread at a time may use the network of a genome
+    std::shared_ptr<BrainFramework::BasicNeuralNetwork> GetNeuralNetwork() const
+    {
+        if (!m_NeuralNetwork)
+        {
+            std::shared_ptr<BrainFramework::BasicNeuralNetwork> neuralNetwork = std::make_shared<BrainFramework::BasicNeuralNetwork>();
+            if (!MakeNeuralNetwork(*neuralNetwork))
+            {
+                return nullptr;
+            }
+
+            m_NeuralNetwork = std::move(neuralNetwork);
+        }
+        return m_NeuralNetwork;
+    }
+
     void EndBatch(float score)
     {
         m_Score = score;
@@ -266,6 +299,107 @@ public:
         m_AverageScore = ((m_Lifetime - 1) * m_AverageScore + score) / m_Lifetime;
     }
 
+    // Everything but the scores, read back by a genome of the same build
+    // Neurons go as varint deltas from the previous gene, usually a byte each, the enabled flag rides on the out delta
+    void Write(BrainFramework::ByteWriter& writer) const
+    {
+        writer.WriteVarint(static_cast<std::uint64_t>(m_Inputs));
+        writer.WriteVarint(static_cast<std::uint64_t>(m_Outputs));
+        writer.WriteVarint(static_cast<std::uint64_t>(m_MaxNeurons));
+        for (int i = 0; i < static_cast<int>(Mutations::COUNT); ++i)
+        {
+            writer.Write(m_MutationChances.at(static_cast<Mutations>(i)));
+        }
+
+        writer.WriteVarint(m_Genes.size());
+        std::int64_t in = 0;
+        std::int64_t out = 0;
+        for (const Gene& gene : m_Genes)
+        {
+            writer.WriteSignedVarint(gene.GetIn() - in);
+            writer.WriteVarint(BrainFramework::ZigZagEncode(gene.GetOut() - out) << 1 | static_cast<std::uint64_t>(gene.IsEnabled()));
+            writer.Write(gene.GetWeight());
+            in = gene.GetIn();
+            out = gene.GetOut();
+        }
+    }
+
+    // Hash of the encoding, kept up to date by every change, names the genome to the worker processes
+    std::uint64_t GetKey() const { return m_Key; }
+
+    // The bytes are only written when asked for
+    void Describe(BrainFramework::GenomeDescription& description, bool writeBytes) const
+    {
+        description.key = m_Key;
+        description.bytes.Clear();
+        if (writeBytes)
+            Write(description.bytes);
+    }
+
+    // False, leaving the genome as it was, when the bytes don't hold a genome whose genes link its own neurons
+    // A genome read is a newcomer, with no score and no lifetime
+    bool Read(BrainFramework::ByteReader& reader)
+    {
+        int inputs = 0;
+        int outputs = 0;
+        int maxNeurons = 0;
+        if (!reader.ReadVarint(inputs, k_MaxReadNeurons) || !reader.ReadVarint(outputs, k_MaxReadNeurons) || !reader.ReadVarint(maxNeurons, k_MaxReadNeurons))
+            return false;
+        if (inputs <= 0 || outputs <= 0 || maxNeurons < inputs + outputs)
+            return false;
+
+        std::array<float, static_cast<std::size_t>(Mutations::COUNT)> mutationChances;
+        for (float& mutationChance : mutationChances)
+        {
+            if (!reader.Read(mutationChance))
+                return false;
+        }
+
+        std::uint64_t genesCount = 0;
+        if (!reader.ReadVarint(genesCount) || genesCount > reader.GetRemaining() / k_MinGeneBytes)
+            return false;
+
+        std::vector<Gene> genes;
+        genes.reserve(static_cast<std::size_t>(genesCount));
+        std::int64_t in = 0;
+        std::int64_t out = 0;
+        for (std::uint64_t i = 0; i < genesCount; ++i)
+        {
+            std::int64_t inDelta = 0;
+            std::uint64_t outAndEnabled = 0;
+            float weight = 0.0f;
+            if (!reader.ReadSignedVarint(inDelta) || !reader.ReadVarint(outAndEnabled) || !reader.Read(weight))
+                return false;
+
+            // Deltas are bounded before they are added, so a damaged one can't overflow
+            const std::int64_t outDelta = BrainFramework::ZigZagDecode(outAndEnabled >> 1);
+            if (inDelta < -maxNeurons || inDelta > maxNeurons || outDelta < -maxNeurons || outDelta > maxNeurons)
+                return false;
+
+            in += inDelta;
+            out += outDelta;
+            if (in < 0 || in >= maxNeurons || out < 0 || out >= maxNeurons)
+                return false;
+
+            genes.emplace_back(static_cast<int>(in), static_cast<int>(out), weight, (outAndEnabled & 1) != 0);
+        }
+
+        m_NeuralNetwork.reset();
+        m_Inputs = inputs;
+        m_Outputs = outputs;
+        m_MaxNeurons = maxNeurons;
+        m_Genes.swap(genes);
+        for (int i = 0; i < static_cast<int>(Mutations::COUNT); ++i)
+        {
+            m_MutationChances[static_cast<Mutations>(i)] = mutationChances[i];
+        }
+        m_Score = 0.0f;
+        m_AverageScore = 0.0f;
+        m_Lifetime = 0;
+        OnChanged();
+        return true;
+    }
+
     const std::vector<Gene>& GetGenes() const { return m_Genes; }
     const std::unordered_map<Mutations, float>& GetMutationChances() const { return m_MutationChances; }
     int GetInputs() const { return m_Inputs; }
@@ -276,20 +410,20 @@ public:
     int GetLifetime() const { return m_Lifetime; }
 
 private:
+    // Every change gives the genome a new key
+    void OnChanged()
+    {
+        thread_local BrainFramework::ByteWriter writer;
+        writer.Clear();
+        Write(writer);
+        m_Key = BrainFramework::MakeGenomeKey(writer.GetBytes());
+    }
+
     void PointMutate()
     {
-        float step = m_MutationChances[Mutations::Step];
-        for (Gene& gene : m_Genes)
-        {
-            if (BrainFramework::RandomFloat() < k_PerturbChance)
-            {
-                gene.SetWeight(gene.GetWeight() + BrainFramework::RandomFloat() * step * 2.0f - step);
-            }
-            else
-            {
-                gene.SetWeight(BrainFramework::RandomFloat() * 4.0f - 2.0f);
-            }
-        }
+        BrainFramework::MutateWeights(m_Genes.size(), k_PerturbChance, m_MutationChances[Mutations::Step],
+            [this](std::size_t i) { return m_Genes[i].GetWeight(); },
+            [this](std::size_t i, float weight) { m_Genes[i].SetWeight(weight); });
     }
 
     void LinkMutate(bool forceInputBias)
@@ -384,6 +518,8 @@ private:
 private:
     std::vector<Gene> m_Genes;
     std::unordered_map<Mutations, float> m_MutationChances;
+    mutable std::shared_ptr<BrainFramework::BasicNeuralNetwork> m_NeuralNetwork;
+    std::uint64_t m_Key{ 0 };
     int m_Inputs{ 0 };
     int m_Outputs{ 0 };
     int m_MaxNeurons{ 0 };
@@ -399,11 +535,13 @@ private:
     static constexpr float k_EnableMutationChance = 0.2f;
     static constexpr float k_DisableMutationChance = 0.4f;
     static constexpr float k_StepSize = 0.1f;
+    static constexpr int k_MaxReadNeurons = 1 << 20;
+    static constexpr std::size_t k_MinGeneBytes = 2 + sizeof(float); // Two one byte varints and the weight
 
     static inline int ms_Innovation = 0;
 };
 
-class NEETModel : public BrainFramework::Model
+class NEETModel : public BrainFramework::PopulationModel<NEETModel, Genome, BrainFramework::BasicNeuralNetwork>
 {
 public:
     NEETModel() = default;
@@ -412,88 +550,9 @@ public:
 
     const char* GetName() const override { return "NEET"; }
 
-    void DisplayImGui() override
-    {
-        ImGui::Text("Generation: %d", GetGeneration());
-        ImGui::Text("maxLifetime: %d", m_MaxLifetime);
-        ImGui::Text("averageScoreTop5: %f", m_AverageScoreTop5);
-        ImGui::Text("averageScoreTop10: %f", m_AverageScoreTop10);
-        ImGui::Text("averageScore: %f", m_AverageScore);
-
-        ImGui::PlotHistogram("MaxLifetime", m_LifetimeArray.data(), static_cast<int>(m_LifetimeArray.size()), 0, NULL, FLT_MAX, FLT_MAX, ImVec2(0, 80));
-        ImGui::PlotHistogram("AverageScoreTop5", m_AverageScoreTop5Array.data(), static_cast<int>(m_AverageScoreTop5Array.size()), 0, NULL, FLT_MAX, FLT_MAX, ImVec2(0, 80));
-        ImGui::PlotHistogram("AverageScoreTop10", m_AverageScoreTop10Array.data(), static_cast<int>(m_AverageScoreTop10Array.size()), 0, NULL, FLT_MAX, FLT_MAX, ImVec2(0, 80));
-        ImGui::PlotHistogram("AverageScore", m_AverageScoreArray.data(), static_cast<int>(m_AverageScoreArray.size()), 0, NULL, FLT_MAX, FLT_MAX, ImVec2(0, 80));
-
-        ImGui::Text("BestGenome:");
-        ImGui::Indent();
-        ImGui::Text("Neurons: %d", m_BestGenome.GetMaxNeurons());
-        int genes = 0;
-        for (const Gene& gene : m_BestGenome.GetGenes())
-            if (gene.IsEnabled() && gene.GetWeight() != 0.0f)
-                genes++;
-        ImGui::Text("Genes: %d", genes);
-        ImGui::Unindent();
-    }
-
-    bool PrepareTraining(const BrainFramework::ISimulation& simulation) override
+    bool MakeBestNeuralNetwork(std::shared_ptr<BrainFramework::NeuralNetwork>& neuralNetwork, int /*index*/ = 0) override
     {
-        if (m_Genomes.empty())
-        {
-            for (int i = 0; i < k_Population; ++i)
-            {
-                Genome& genome = m_Genomes.emplace_back();
-                genome.Initialize(simulation.GetRLInputsCount(), simulation.GetRLOutputsCount());
-                genome.Mutate();
-            }
-        }
-
-        m_CurrentGenome = 0;
-        m_CurrentGenomeEvaluation = 0;
-        m_CurrentGenomeScoreSum = 0.0f;
-
-        return true;
-    }
-
-    bool StartEvaluation(std::unique_ptr<BrainFramework::NeuralNetwork>& neuralNetwork) override
-    {
-        Genome& genome = m_Genomes[m_CurrentGenome];
-
-        std::unique_ptr<BrainFramework::BasicNeuralNetwork> basicNeuralNetwork = std::make_unique<BrainFramework::BasicNeuralNetwork>();
-        if (!genome.MakeNeuralNetwork(*basicNeuralNetwork))
-        {
-            return false;
-        }
-
-        neuralNetwork = std::move(basicNeuralNetwork);
-
-        return true;
-    }
-
-    bool EndEvalutation(float result) override
-    {
-        Genome& genome = m_Genomes[m_CurrentGenome];
-
-        m_CurrentGenomeEvaluation++;
-        m_CurrentGenomeScoreSum += result;
-
-        constexpr int batchSize = 5;
-        if (m_CurrentGenomeEvaluation >= batchSize)
-        {
-            genome.EndBatch(m_CurrentGenomeScoreSum / batchSize);
-
-            m_CurrentGenomeEvaluation = 0;
-            m_CurrentGenomeScoreSum = 0.0f;
-
-            NextGenome();
-        }
-
-        return true;
-    }
-
-    bool MakeBestNeuralNetwork(std::unique_ptr<BrainFramework::NeuralNetwork>& neuralNetwork, int index = 0) override
-    {
-        std::unique_ptr<BrainFramework::BasicNeuralNetwork> basicNeuralNetwork = std::make_unique<BrainFramework::BasicNeuralNetwork>();
+        std::shared_ptr<BrainFramework::BasicNeuralNetwork> basicNeuralNetwork = std::make_shared<BrainFramework::BasicNeuralNetwork>();
         const bool result = m_BestGenome.MakeNeuralNetwork(*basicNeuralNetwork);
 
         neuralNetwork = std::move(basicNeuralNetwork);
@@ -501,114 +560,39 @@ public:
         return result;
     }
 
-    void NextGenome()
-    {
-        m_CurrentGenome++;
-        if (m_CurrentGenome >= static_cast<int>(m_Genomes.size()))
-        {
-            m_CurrentGenome = 0;
-            NewGeneration();
-        }
-    }
+private:
+    using Base = BrainFramework::PopulationModel<NEETModel, Genome, BrainFramework::BasicNeuralNetwork>;
+    friend Base;
 
-    void NewGeneration()
+    void MakeChild(Genome& child, const Genome& parent1, const Genome* parent2)
     {
-        m_MaxLifetime = 0;
-        m_AverageScore = 0.0f;
-        for (Genome& genome : m_Genomes)
+        if (parent2 != nullptr)
         {
-            if (genome.GetLifetime() > m_MaxLifetime) m_MaxLifetime = genome.GetLifetime();
-            m_AverageScore += genome.GetAverageScore();
+            child.Crossover(parent1, *parent2);
         }
-
-        std::sort(m_Genomes.begin(), m_Genomes.end(), [&](const Genome& a, const Genome& b)
-        {
-            return a.GetAverageScore() > b.GetAverageScore();
-        });
-
-        // Save our best
-        m_BestGenome.CopyFrom(m_Genomes[0]);
-
-        // Cull the bottom
-        m_Genomes.erase(m_Genomes.begin() + m_Genomes.size() / k_Cut, m_Genomes.end());
-
-        const int size = static_cast<int>(m_Genomes.size());
-
-        // Compute health
-        m_AverageScore = 0.0f; // Recompute with removed ones
-        m_AverageScoreTop5 = 0.0f;
-        m_AverageScoreTop10 = 0.0f;
-        for (int i = 0; i < size; ++i)
+        else
         {
-            const float avg = m_Genomes[i].GetAverageScore();
-            if (i < 5) m_AverageScoreTop5 += avg;
-            if (i < 10) m_AverageScoreTop10 += avg;
-            m_AverageScore += avg;
+            child.CopyFrom(parent1);
         }
-        m_AverageScore /= size;
-        m_AverageScoreTop5 /= 5;
-        m_AverageScoreTop10 /= 10;
-
-        // Add to histograms
-        m_LifetimeArray.push_back(static_cast<float>(m_MaxLifetime));
-        if (m_LifetimeArray.size() > k_HistogramValues) m_LifetimeArray.erase(m_LifetimeArray.begin());
-        m_AverageScoreTop5Array.push_back(m_AverageScoreTop5);
-        if (m_AverageScoreTop5Array.size() > k_HistogramValues) m_AverageScoreTop5Array.erase(m_AverageScoreTop5Array.begin());
-        m_AverageScoreTop10Array.push_back(m_AverageScoreTop10);
-        if (m_AverageScoreTop10Array.size() > k_HistogramValues) m_AverageScoreTop10Array.erase(m_AverageScoreTop10Array.begin());
-        m_AverageScoreArray.push_back(m_AverageScore);
-        if (m_AverageScoreArray.size() > k_HistogramValues) m_AverageScoreArray.erase(m_AverageScoreArray.begin());
-
-        // Breed from any adults
-        for (int i = size; i < k_Population; ++i)
-        {
-            int parent1Index = BrainFramework::RandomInt(0, size / 2);
-            int parent2Index = BrainFramework::RandomInt(0, size / 2);
 
-            Genome& child = m_Genomes.emplace_back();
+        child.Mutate();
+    }
 
-            constexpr float k_CrossoverChance = 0.75f;
-            if (BrainFramework::RandomFloat() < k_CrossoverChance && parent1Index != parent2Index)
-            {
-                child.Crossover(m_Genomes[parent1Index], m_Genomes[parent2Index]);
-            }
-            else
-            {
-                child.CopyFrom(m_Genomes[parent1Index]);
-            }
+    void SaveBest(const Genome& best) { m_BestGenome.CopyFrom(best); }
 
-            child.Mutate();
+    void AddStatsDetails(Stats& stats) const
+    {
+        int bestGenes = 0;
+        for (const Gene& gene : m_BestGenome.GetGenes())
+        {
+            if (gene.IsEnabled() && gene.GetWeight() != 0.0f)
+                bestGenes++;
         }
-
-        m_Generation++;
+        stats.details.emplace_back("BestNeurons", static_cast<float>(m_BestGenome.GetMaxNeurons()));
+        stats.details.emplace_back("BestGenes", static_cast<float>(bestGenes)); // Enabled and non zero
     }
 
-    int GetGeneration() const { return m_Generation; }
-    const std::vector<Genome>& GetGenomes() const { return m_Genomes; }
-
-    static constexpr int k_Population = 300;
-    static constexpr int k_Cut = 3;
-
-    static constexpr int k_HistogramValues = 300;
-
-    static constexpr float k_ResetMaxScore = -100000.0f;
-
-private:
     Genome m_BestGenome;
-    std::vector<Genome> m_Genomes;
-    int m_CurrentGenome{ 0 };
-    int m_CurrentGenomeEvaluation{ 0 };
-    float m_CurrentGenomeScoreSum{ 0 };
-
-    int m_Generation{ 0 };
-    int m_MaxLifetime{ 0 };
-    float m_AverageScoreTop5{ 0.0f };
-    float m_AverageScoreTop10{ 0.0f };
-    float m_AverageScore{ 0.0f };
-    std::vector<float> m_LifetimeArray;
-    std::vector<float> m_AverageScoreTop5Array;
-    std::vector<float> m_AverageScoreTop10Array;
-    std::vector<float> m_AverageScoreArray;
 };
 
 } // namespace NEET
@@ -26,6 +26,7 @@ namespace NEETL
         static constexpr float k_AlterateWeightsChance = 1.1f;
         static constexpr float k_StepSize = 0.1f;
         static constexpr int k_InitialIntermediateLayers = 3;
+        static constexpr int k_MaxReadLayerSize = 1 << 16;
 
         Genome()
         {
@@ -42,6 +43,8 @@ namespace NEETL
 
         void CopyFrom(const Genome& other)
         {
+            m_NeuralNetwork.reset();
+
             m_Inputs = other.m_Inputs;
             m_Outputs = other.m_Outputs;
 
@@ -56,6 +59,10 @@ namespace NEETL
             m_MutationChances[Mutations::AddLayer] = other.m_MutationChances.at(Mutations::AddLayer);
             m_MutationChances[Mutations::AlterateWeights] = other.m_MutationChances.at(Mutations::AlterateWeights);
             m_MutationChances[Mutations::Step] = other.m_MutationChances.at(Mutations::Step);
+
+            m_Key = other.m_Key;
+            m_ParentKeys = other.m_ParentKeys;
+            m_BreedSeed = other.m_BreedSeed;
         }
 
         void Crossover(const Genome& genome1, const Genome& genome2)
@@ -70,6 +77,8 @@ namespace NEETL
             assert(genome1.m_Inputs == genome2.m_Inputs);
             assert(genome1.m_Outputs == genome2.m_Outputs);
 
+            m_NeuralNetwork.reset();
+
             m_Inputs = genome1.m_Inputs;
             m_Outputs = genome1.m_Outputs;
 
@@ -86,10 +95,37 @@ namespace NEETL
                 const Mutations mut = static_cast<Mutations>(i);
                 m_MutationChances[mut] = (BrainFramework::RandomBool()) ? genome1.m_MutationChances.at(mut) : genome2.m_MutationChances.at(mut);
             }
+
+            OnChanged();
+        }
+
+        // A child of one parent, or of two with crossover, drawing all its randomness from the seed
+        // So a worker holding the parents breeds it again from the parent keys and the seed alone
+        void Breed(const Genome& parent1, const Genome* parent2, std::uint64_t seed)
+        {
+            // Crossover favors the fitter parent, which is settled here since a worker doesn't know the scores
+            const Genome* first = &parent1;
+            const Genome* second = parent2;
+            if (second != nullptr && second->m_AverageScore > first->m_AverageScore)
+                std::swap(first, second);
+
+            {
+                BrainFramework::RandomScope breedScope(seed);
+                if (second != nullptr)
+                    Crossover(*first, *second);
+                else
+                    CopyFrom(*first);
+                Mutate();
+            }
+
+            m_ParentKeys = { first->m_Key, second != nullptr ? second->m_Key : 0 };
+            m_BreedSeed = seed;
         }
 
         void Initialize(int inputs, int outputs)
         {
+            m_NeuralNetwork.reset();
+
             m_Inputs = inputs;
             m_Outputs = outputs;
 
@@ -98,23 +134,20 @@ namespace NEETL
             m_LayerSizes[1] = outputs;
 
             m_Weights.resize(inputs * outputs);
-            int index = 0;
-            for (int i = 0; i < m_Inputs; ++i)
-            {
-                for (int o = 0; o < m_Outputs; ++o, ++index)
-                {
-                    m_Weights[index] = BrainFramework::RandomFloat() * 4.0f - 2.0f;
-                }
-            }
+            BrainFramework::FillUniform(m_Weights, -2.0f, 2.0f);
 
             for (int j = 0; j < k_InitialIntermediateLayers; ++j)
             {
                 BrainFramework::LayeredNeuralNetwork::AddLayer(m_LayerSizes, m_Weights, 1);
             }
+
+            OnChanged();
         }
 
         void Mutate()
         {
+            m_NeuralNetwork.reset();
+
             // Alterate mutation chances
             for (auto& mutationChance : m_MutationChances)
             {
@@ -127,18 +160,9 @@ namespace NEETL
                 if (BrainFramework::RandomFloat() < p)
                 {
                     // Alterate Weights
-                    float step = m_MutationChances[Mutations::Step];
-                    for (float& v : m_Weights)
-                    {
-                        if (BrainFramework::RandomFloat() < k_PerturbChance)
-                        {
-                            v += (BrainFramework::RandomFloat() * step * 2.0f - step);
-                        }
-                        else
-                        {
-                            v = BrainFramework::RandomFloat() * 4.0f - 2.0f;
-                        }
-                    }
+                    BrainFramework::MutateWeights(m_Weights.size(), k_PerturbChance, m_MutationChances[Mutations::Step],
+                        [this](std::size_t i) { return m_Weights[i]; },
+                        [this](std::size_t i, float weight) { m_Weights[i] = weight; });
                 }
                 p -= 1.0f;
             }
@@ -180,6 +204,8 @@ namespace NEETL
                 }
                 p -= 1.0f;
             }
+
+            OnChanged();
         }
 
         bool MakeNeuralNetwork(BrainFramework::LayeredNeuralNetwork& neuralNetwork) const
@@ -187,6 +213,36 @@ namespace NEETL
             return neuralNetwork.Make(m_LayerSizes, m_Weights);
         }
 
+        // Built on first use and kept until the weights change
+        // Only one thread at a time may use the network of a genome
+        std::shared_ptr<BrainFramework::LayeredNeuralNetwork> GetNeuralNetwork() const
+        {
+            if (!m_NeuralNetwork)
+            {
+                std::shared_ptr<BrainFramework::LayeredNeuralNetwork> neuralNetwork = std::make_shared<BrainFramework::LayeredNeuralNetwork>();
+                if (!MakeNeuralNetwork(*neuralNetwork))
+                {
+                    return nullptr;
+                }
+
+                m_NeuralNetwork = std::move(neuralNetwork);
+            }
+            return m_NeuralNetwork;
+        }
+
+        // Lamarckian refinement, the trained weights are written back into the genome
+        // The scores were earned by the old weights, the refined genome is judged again from its next evaluation
+        float Refine(BrainFramework::LayeredBackpropagation& backpropagation, const std::vector<BrainFramework::LayeredBackpropagation::Sample>& samples)
+        {
+            m_NeuralNetwork.reset();
+            const float loss = backpropagation.Train(m_LayerSizes, m_Weights, samples);
+            m_Score = 0.0f;
+            m_AverageScore = 0.0f;
+            m_Lifetime = 0;
+            OnChanged();
+            return loss;
+        }
+
         void EndBatch(float score)
         {
             m_Score = score;
@@ -194,6 +250,93 @@ namespace NEETL
             m_AverageScore = ((m_Lifetime - 1) * m_AverageScore + m_Score) / m_Lifetime;
         }
 
+        // Everything but the scores, read back by a genome of the same build
+        void Write(BrainFramework::ByteWriter& writer) const
+        {
+            writer.WriteVarint(static_cast<std::uint64_t>(m_Inputs));
+            writer.WriteVarint(static_cast<std::uint64_t>(m_Outputs));
+            for (int i = 0; i < static_cast<int>(Mutations::COUNT); ++i)
+            {
+                writer.Write(m_MutationChances.at(static_cast<Mutations>(i)));
+            }
+
+            // The weights count follows from the layer sizes
+            writer.WriteVarint(m_LayerSizes.size());
+            for (int layerSize : m_LayerSizes)
+            {
+                writer.WriteVarint(static_cast<std::uint64_t>(layerSize));
+            }
+            writer.WriteBytes(m_Weights.data(), m_Weights.size() * sizeof(float));
+        }
+
+        // Hash of the encoding, kept up to date by every change, names the genome to the worker processes
+        std::uint64_t GetKey() const { return m_Key; }
+
+        // A bred genome is described by its parents too, the bytes are only written when asked for
+        void Describe(BrainFramework::GenomeDescription& description, bool writeBytes) const
+        {
+            description.key = m_Key;
+            description.parentKeys = m_ParentKeys;
+            description.breedSeed = m_BreedSeed;
+            description.bytes.Clear();
+            if (writeBytes)
+                Write(description.bytes);
+        }
+
+        // False, leaving the genome as it was, when the bytes don't hold a valid network
+        // A genome read is a newcomer, with no score and no lifetime
+        bool Read(BrainFramework::ByteReader& reader)
+        {
+            int inputs = 0;
+            int outputs = 0;
+            if (!reader.ReadVarint(inputs, k_MaxReadLayerSize) || !reader.ReadVarint(outputs, k_MaxReadLayerSize))
+                return false;
+
+            std::array<float, static_cast<std::size_t>(Mutations::COUNT)> mutationChances;
+            for (float& mutationChance : mutationChances)
+            {
+                if (!reader.Read(mutationChance))
+                    return false;
+            }
+
+            std::uint64_t layersCount = 0;
+            if (!reader.ReadVarint(layersCount) || layersCount < 2 || layersCount > reader.GetRemaining())
+                return false;
+
+            std::vector<int> layerSizes(static_cast<std::size_t>(layersCount));
+            std::uint64_t linksCount = 0;
+            for (std::size_t i = 0; i < layerSizes.size(); ++i)
+            {
+                if (!reader.ReadVarint(layerSizes[i], k_MaxReadLayerSize) || layerSizes[i] <= 0)
+                    return false;
+                if (i > 0)
+                    linksCount += static_cast<std::uint64_t>(layerSizes[i - 1]) * layerSizes[i];
+            }
+            if (layerSizes[0] != inputs || layerSizes.back() != outputs || linksCount > reader.GetRemaining() / sizeof(float))
+                return false;
+
+            std::vector<float> weights(linksCount);
+            if (!reader.ReadBytes(weights.data(), weights.size() * sizeof(float)))
+                return false;
+            if (BrainFramework::LayeredNeuralNetwork::Validate(layerSizes, weights) != BrainFramework::LayeredNeuralNetwork::ValidateResult::Valid)
+                return false;
+
+            m_NeuralNetwork.reset();
+            m_Inputs = inputs;
+            m_Outputs = outputs;
+            m_LayerSizes.swap(layerSizes);
+            m_Weights.swap(weights);
+            for (int i = 0; i < static_cast<int>(Mutations::COUNT); ++i)
+            {
+                m_MutationChances[static_cast<Mutations>(i)] = mutationChances[i];
+            }
+            m_Score = 0.0f;
+            m_AverageScore = 0.0f;
+            m_Lifetime = 0;
+            OnChanged();
+            return true;
+        }
+
         const std::unordered_map<Mutations, float>& GetMutationChances() const { return m_MutationChances; }
         int GetInputs() const { return m_Inputs; }
         int GetOutputs() const { return m_Outputs; }
@@ -223,9 +366,24 @@ namespace NEETL
         int GetLayersCount() const { return static_cast<int>(m_LayerSizes.size()); }
 
     private:
+        // Every change gives the genome a new key, and makes it a genome no breeding describes
+        void OnChanged()
+        {
+            thread_local BrainFramework::ByteWriter writer;
+            writer.Clear();
+            Write(writer);
+            m_Key = BrainFramework::MakeGenomeKey(writer.GetBytes());
+            m_ParentKeys = { 0, 0 };
+            m_BreedSeed = 0;
+        }
+
         std::vector<int> m_LayerSizes;
         std::vector<float> m_Weights;
         std::unordered_map<Mutations, float> m_MutationChances;
+        mutable std::shared_ptr<BrainFramework::LayeredNeuralNetwork> m_NeuralNetwork;
+        std::uint64_t m_Key{ 0 };
+        std::array<std::uint64_t, 2> m_ParentKeys{ 0, 0 }; // Set by Breed, the second one is 0 without crossover
+        std::uint64_t m_BreedSeed{ 0 };
         int m_Inputs{ 0 };
         int m_Outputs{ 0 };
         float m_Score{ 0.0f };
@@ -235,101 +393,83 @@ namespace NEETL
         static inline int ms_Innovation = 0;
     };
 
-    class NEETLModel : public BrainFramework::Model
+    // Plays through another network and keeps what it was shown and what it answered, until enough samples are kept
+    class RecordingNeuralNetwork : public BrainFramework::NeuralNetwork
     {
     public:
-        NEETLModel() = default;
-        NEETLModel(const NEETLModel&) = delete;
-        NEETLModel& operator=(const NEETLModel&) = delete;
-
-        const char* GetName() const override { return "NEETLModel"; }
-
-        void DisplayImGui() override
+        RecordingNeuralNetwork(BrainFramework::NeuralNetwork& neuralNetwork, std::vector<BrainFramework::LayeredBackpropagation::Sample>& samples, int maxSamples)
+            : m_NeuralNetwork(neuralNetwork)
+            , m_Samples(samples)
+            , m_MaxSamples(maxSamples)
         {
-            ImGui::Text("Generation: %d", GetGeneration());
-            ImGui::Text("MaxLifetime: %d", m_MaxLifetime);
-            ImGui::Text("AverageScoreTop5: %f", m_AverageScoreTop5);
-            ImGui::Text("AverageScoreTop10: %f", m_AverageScoreTop10);
-            ImGui::Text("AverageScore: %f", m_AverageScore);
-
-            ImGui::PlotHistogram("MaxLifetime", m_LifetimeArray.data(), static_cast<int>(m_LifetimeArray.size()), 0, NULL, FLT_MAX, FLT_MAX, ImVec2(0, 80));
-            ImGui::PlotHistogram("AverageScoreTop5", m_AverageScoreTop5Array.data(), static_cast<int>(m_AverageScoreTop5Array.size()), 0, NULL, FLT_MAX, FLT_MAX, ImVec2(0, 80));
-            ImGui::PlotHistogram("AverageScoreTop10", m_AverageScoreTop10Array.data(), static_cast<int>(m_AverageScoreTop10Array.size()), 0, NULL, FLT_MAX, FLT_MAX, ImVec2(0, 80));
-            ImGui::PlotHistogram("AverageScore", m_AverageScoreArray.data(), static_cast<int>(m_AverageScoreArray.size()), 0, NULL, FLT_MAX, FLT_MAX, ImVec2(0, 80));
-
-            if (!m_Bests.empty())
-            {
-                ImGui::Text("BestGenome:");
-                ImGui::Indent();
-                ImGui::Text("Neurons: %d", m_Bests[0].GetNeuronsCount());
-                ImGui::Text("Links: %d", m_Bests[0].GetLinksCount());
-                ImGui::Unindent();
-            }
         }
 
-        bool PrepareTraining(const BrainFramework::ISimulation& simulation) override
+        bool Evaluate(const std::vector<float>& inputs, std::vector<float>& outputs) override
         {
-            if (m_Genomes.empty())
-            {
-                for (int i = 0; i < k_Population; ++i)
-                {
-                    Genome& genome = m_Genomes.emplace_back();
-                    genome.Initialize(simulation.GetRLInputsCount(), simulation.GetRLOutputsCount());
-                    genome.Mutate();
-                }
-            }
-
-            m_Bests.clear();
-            m_Bests.resize(k_BestCount);
-
-            m_CurrentGenome = 0;
-            m_CurrentGenomeEvaluation = 0;
-            m_CurrentGenomeScoreSum = 0.0f;
+            if (!m_NeuralNetwork.Evaluate(inputs, outputs))
+                return false;
 
+            if (static_cast<int>(m_Samples.size()) < m_MaxSamples)
+                m_Samples.push_back({ inputs, outputs });
             return true;
         }
 
-        bool StartEvaluation(std::unique_ptr<BrainFramework::NeuralNetwork>& neuralNetwork) override
+        bool EvaluateBatch(std::span<const float> inputs, std::span<float> outputs, int lanes) override
         {
-            Genome& genome = m_Genomes[m_CurrentGenome];
+            if (!m_NeuralNetwork.EvaluateBatch(inputs, outputs, lanes))
+                return false;
 
-            std::unique_ptr<BrainFramework::LayeredNeuralNetwork> layeredNeuralNetwork = std::make_unique<BrainFramework::LayeredNeuralNetwork>();
-            if (!genome.MakeNeuralNetwork(*layeredNeuralNetwork))
+            const std::size_t inputsCount = inputs.size() / lanes;
+            const std::size_t outputsCount = outputs.size() / lanes;
+            for (int lane = 0; lane < lanes && static_cast<int>(m_Samples.size()) < m_MaxSamples; ++lane)
             {
-                return false;
+                BrainFramework::LayeredBackpropagation::Sample& sample = m_Samples.emplace_back();
+                sample.inputs.assign(inputs.begin() + lane * inputsCount, inputs.begin() + (lane + 1) * inputsCount);
+                sample.targets.assign(outputs.begin() + lane * outputsCount, outputs.begin() + (lane + 1) * outputsCount);
             }
-
-            neuralNetwork = std::move(layeredNeuralNetwork);
-
             return true;
         }
 
-        bool EndEvalutation(float result) override
-        {
-            Genome& genome = m_Genomes[m_CurrentGenome];
+        void ResetState() override { m_NeuralNetwork.ResetState(); }
+        void ResetBatchState(int lane) override { m_NeuralNetwork.ResetBatchState(lane); }
 
-            m_CurrentGenomeEvaluation++;
-            m_CurrentGenomeScoreSum += result;
+        int GetInputsCount() override { return m_NeuralNetwork.GetInputsCount(); }
+        int GetOutputsCount() override { return m_NeuralNetwork.GetOutputsCount(); }
+        int GetNeuronsCount() override { return m_NeuralNetwork.GetNeuronsCount(); }
+        int GetLinksCount() override { return m_NeuralNetwork.GetLinksCount(); }
 
-            constexpr int batchSize = 5;
-            if (m_CurrentGenomeEvaluation >= batchSize)
-            {
-                genome.EndBatch(m_CurrentGenomeScoreSum / batchSize);
+        bool LoadFromFile(const std::string& /*filename*/) override { return false; }
+        bool SaveToFile(const std::string& filename) override { return m_NeuralNetwork.SaveToFile(filename); }
 
-                m_CurrentGenomeEvaluation = 0;
-                m_CurrentGenomeScoreSum = 0.0f;
+    private:
+        BrainFramework::NeuralNetwork& m_NeuralNetwork;
+        std::vector<BrainFramework::LayeredBackpropagation::Sample>& m_Samples;
+        int m_MaxSamples;
+    };
 
-                NextGenome();
-            }
+    class NEETLModel : public BrainFramework::PopulationModel<NEETLModel, Genome, BrainFramework::LayeredNeuralNetwork>
+    {
+    public:
+        NEETLModel() = default;
+        NEETLModel(const NEETLModel&) = delete;
+        NEETLModel& operator=(const NEETLModel&) = delete;
 
-            return true;
+        const char* GetName() const override { return "NEETL"; }
+
+        bool PrepareTraining(const BrainFramework::ISimulation& simulation) override
+        {
+            m_Bests.clear();
+            m_Bests.resize(k_BestCount);
+            m_RefinementSimulation = simulation.Clone();
+
+            return Base::PrepareTraining(simulation);
         }
 
-        bool MakeBestNeuralNetwork(std::unique_ptr<BrainFramework::NeuralNetwork>& neuralNetwork, int index = 0) override
+        bool MakeBestNeuralNetwork(std::shared_ptr<BrainFramework::NeuralNetwork>& neuralNetwork, int index = 0) override
         {
             index = index % k_BestCount;
 
-            std::unique_ptr<BrainFramework::LayeredNeuralNetwork> layeredNeuralNetwork = std::make_unique<BrainFramework::LayeredNeuralNetwork>();
+            std::shared_ptr<BrainFramework::LayeredNeuralNetwork> layeredNeuralNetwork = std::make_shared<BrainFramework::LayeredNeuralNetwork>();
             const bool result = m_Bests[index].MakeNeuralNetwork(*layeredNeuralNetwork);
 
             neuralNetwork = std::move(layeredNeuralNetwork);
@@ -337,116 +477,124 @@ namespace NEETL
             return result;
         }
 
-        void NextGenome()
+        // Children are bred again from parents the worker already holds, a breeding seed instead of every weight
+        std::shared_ptr<BrainFramework::RemoteGenome> BreedRemoteGenome(const BrainFramework::RemoteGenome& parent1, const BrainFramework::RemoteGenome* parent2, std::uint64_t seed) const override
         {
-            m_CurrentGenome++;
-            if (m_CurrentGenome >= static_cast<int>(m_Genomes.size()))
-            {
-                m_CurrentGenome = 0;
-                NewGeneration();
-            }
+            std::shared_ptr<PopulationRemoteGenome> remoteGenome = std::make_shared<PopulationRemoteGenome>();
+            remoteGenome->genome.Breed(static_cast<const PopulationRemoteGenome&>(parent1).genome, parent2 != nullptr ? &static_cast<const PopulationRemoteGenome*>(parent2)->genome : nullptr, seed);
+            return remoteGenome;
         }
 
-        void NewGeneration()
-        {
-            m_MaxLifetime = 0;
-            for (Genome& genome : m_Genomes)
-            {
-                if (genome.GetLifetime() > m_MaxLifetime) m_MaxLifetime = genome.GetLifetime();
-            }
+        BrainFramework::LayeredBackpropagation& GetBackpropagation() { return m_Backpropagation; }
 
-            std::sort(m_Genomes.begin(), m_Genomes.end(), [&](const Genome& a, const Genome& b)
-                {
-                    return a.GetAverageScore() > b.GetAverageScore();
-                });
+        // Off by default: the elites distill the champion, no better than plain evolution on the demo simulations
+        void SetRefinement(bool refinement) { m_Refinement = refinement; }
+        bool IsRefinement() const { return m_Refinement; }
 
-            // Save our best
-            for (int i = 0; i < k_BestCount; ++i)
-            {
-                m_Bests[i].CopyFrom(m_Genomes[0]);
-            }
+        static constexpr int k_BestCount = 10;
+        static constexpr int k_RefinedElites = 5; // Besides the champion teaching them
+        static constexpr int k_RefinementEpisodes = 4; // Episodes of the champion recorded each generation
+        static constexpr int k_MaxRefinementSamples = 1024;
 
-            // Cull the bottom
-            m_Genomes.erase(m_Genomes.begin() + m_Genomes.size() / k_Cut, m_Genomes.end());
+    private:
+        using Base = BrainFramework::PopulationModel<NEETLModel, Genome, BrainFramework::LayeredNeuralNetwork>;
+        friend Base;
 
-            const int size = static_cast<int>(m_Genomes.size());
+        void MakeChild(Genome& child, const Genome& parent1, const Genome* parent2)
+        {
+            child.Breed(parent1, parent2, BrainFramework::Random::GetThreadStream().NextUInt64());
+        }
 
-            // Compute health
-            m_AverageScore = 0.0f; // Recompute with removed ones
-            m_AverageScoreTop5 = 0.0f;
-            m_AverageScoreTop10 = 0.0f;
-            for (int i = 0; i < size; ++i)
+        void SaveBest(const Genome& best)
+        {
+            for (int i = 0; i < k_BestCount; ++i)
             {
-                const float avg = m_Genomes[i].GetAverageScore();
-                if (i < 5) m_AverageScoreTop5 += avg;
-                if (i < 10) m_AverageScoreTop10 += avg;
-                m_AverageScore += avg;
+                m_Bests[i].CopyFrom(best);
             }
-            m_AverageScore /= size;
-            m_AverageScoreTop5 /= 5;
-            m_AverageScoreTop10 /= 10;
-
-            // Add to histograms
-            m_LifetimeArray.push_back(static_cast<float>(m_MaxLifetime));
-            if (m_LifetimeArray.size() > k_HistogramValues) m_LifetimeArray.erase(m_LifetimeArray.begin());
-            m_AverageScoreTop5Array.push_back(m_AverageScoreTop5);
-            if (m_AverageScoreTop5Array.size() > k_HistogramValues) m_AverageScoreTop5Array.erase(m_AverageScoreTop5Array.begin());
-            m_AverageScoreTop10Array.push_back(m_AverageScoreTop10);
-            if (m_AverageScoreTop10Array.size() > k_HistogramValues) m_AverageScoreTop10Array.erase(m_AverageScoreTop10Array.begin());
-            m_AverageScoreArray.push_back(m_AverageScore);
-            if (m_AverageScoreArray.size() > k_HistogramValues) m_AverageScoreArray.erase(m_AverageScoreArray.begin());
-
-            // Breed from any adults
-            for (int i = size; i < k_Population; ++i)
-            {
-                int parent1Index = BrainFramework::RandomInt(0, size / 2);
-                int parent2Index = BrainFramework::RandomInt(0, size / 2);
+        }
 
-                Genome& child = m_Genomes.emplace_back();
+        // The champion teaches the next elites before they breed: they take a few gradient steps toward its answers over a few episodes
+        void OnRanked()
+        {
+            if (!m_Refinement || m_Ranking.size() < 2 || !RecordChampion(m_Ranking[0]))
+                return;
 
-                constexpr float k_CrossoverChance = 0.75f;
-                if (BrainFramework::RandomFloat() < k_CrossoverChance && parent1Index != parent2Index)
+            const int elites = std::min(k_RefinedElites + 1, static_cast<int>(m_Ranking.size()));
+            float lossSum = 0.0f;
+            int refined = 0;
+            for (int i = 1; i < elites; ++i)
+            {
+                // In steady state, an elite another thread holds waits for the next census
+                const int genomeIndex = m_Ranking[i];
+                if (m_SteadyState && !m_SteadyStatePopulation.TryAcquireWrite(genomeIndex))
+                    continue;
+
+                const float loss = m_Genomes[genomeIndex].Refine(m_Backpropagation, m_RefinementSamples);
+                if (m_SteadyState)
                 {
-                    child.Crossover(m_Genomes[parent1Index], m_Genomes[parent2Index]);
+                    m_SteadyStatePopulation.SetScore(genomeIndex, m_Genomes[genomeIndex].GetAverageScore(), m_Genomes[genomeIndex].GetLifetime());
+                    m_SteadyStatePopulation.ReleaseWrite(genomeIndex);
                 }
-                else
+
+                if (loss >= 0.0f)
                 {
-                    child.CopyFrom(m_Genomes[parent1Index]);
+                    lossSum += loss;
+                    refined++;
                 }
-
-                child.Mutate();
             }
 
-            m_Generation++;
+            if (refined > 0)
+                m_RefinementLoss = lossSum / refined;
         }
 
-        int GetGeneration() const { return m_Generation; }
-        const std::vector<Genome>& GetGenomes() const { return m_Genomes; }
+        // Episodes drawn from the generation node on a simulation of its own, whatever runs the jobs, so the samples are the same in every mode
+        bool RecordChampion(int genomeIndex)
+        {
+            if (m_RefinementSimulation == nullptr)
+                return false;
 
-        static constexpr int k_Population = 300;
-        static constexpr int k_Cut = 3;
-        static constexpr int k_BestCount = 10;
+            // In steady state, a champion another thread holds waits for the next census
+            if (m_SteadyState && !m_SteadyStatePopulation.TryAcquireRead(genomeIndex))
+                return false;
 
-        static constexpr int k_HistogramValues = 300;
+            BrainFramework::LayeredNeuralNetwork neuralNetwork;
+            const bool made = m_Genomes[genomeIndex].MakeNeuralNetwork(neuralNetwork);
+            if (m_SteadyState)
+                m_SteadyStatePopulation.ReleaseRead(genomeIndex);
+            if (!made)
+                return false;
 
-        static constexpr float k_ResetMaxScore = -100000.0f;
+            m_RefinementSamples.clear();
+            RecordingNeuralNetwork recordingNeuralNetwork(neuralNetwork, m_RefinementSamples, k_MaxRefinementSamples);
+            for (int episode = 0; episode < k_RefinementEpisodes && static_cast<int>(m_RefinementSamples.size()) < k_MaxRefinementSamples; ++episode)
+            {
+                recordingNeuralNetwork.ResetState();
+                BrainFramework::BatchEvaluator::RunEpisode(*m_RefinementSimulation, recordingNeuralNetwork, BrainFramework::Random::GetThreadStream().NextUInt64());
+            }
+            return !m_RefinementSamples.empty();
+        }
+
+        void AddStatsDetails(Stats& stats) const
+        {
+            if (!m_Bests.empty())
+            {
+                stats.details.emplace_back("BestNeurons", static_cast<float>(m_Bests[0].GetNeuronsCount()));
+                stats.details.emplace_back("BestLinks", static_cast<float>(m_Bests[0].GetLinksCount()));
+            }
+            if (m_Refinement)
+            {
+                stats.details.emplace_back("RefinementSamples", static_cast<float>(m_RefinementSamples.size()));
+                stats.details.emplace_back("RefinementLoss", m_RefinementLoss);
+            }
+        }
 
-    private:
         std::vector<Genome> m_Bests;
-        std::vector<Genome> m_Genomes;
-        int m_CurrentGenome{ 0 };
-        int m_CurrentGenomeEvaluation{ 0 };
-        float m_CurrentGenomeScoreSum{ 0 };
-
-        int m_Generation{ 0 };
-        int m_MaxLifetime{ 0 };
-        float m_AverageScoreTop5{ 0.0f };
-        float m_AverageScoreTop10{ 0.0f };
-        float m_AverageScore{ 0.0f };
-        std::vector<float> m_LifetimeArray;
-        std::vector<float> m_AverageScoreTop5Array;
-        std::vector<float> m_AverageScoreTop10Array;
-        std::vector<float> m_AverageScoreArray;
+
+        bool m_Refinement{ false };
+        BrainFramework::LayeredBackpropagation m_Backpropagation;
+        std::unique_ptr<BrainFramework::ISimulation> m_RefinementSimulation; // Left null by the models of the worker processes
+        std::vector<BrainFramework::LayeredBackpropagation::Sample> m_RefinementSamples; // Of the last recorded champion
+        float m_RefinementLoss{ 0.0f };
     };
 
 } // namespace NEETL
@@ -1,8 +1,11 @@
 #include "Application.hpp"
 
+#include <atomic>
 #include <ctime>
+#include <functional>
 #include <memory>
 #include <iostream>
+#include <thread>
 
 #include "../src/BrainFramework.hpp"
 
@@ -42,11 +45,177 @@ struct Player
     Player() = default;
 
     std::unique_ptr<BrainFramework::Model> model;
-    std::unique_ptr<BrainFramework::NeuralNetwork> neuralNetwork;
+    std::shared_ptr<BrainFramework::NeuralNetwork> neuralNetwork;
     BrainFramework::AgentInterface* agent;
     VectorLogger logger;
 };
 
+void DisplayPerfProfiler(BrainFramework::PerfProfiler& profiler)
+{
+    bool enabled = BrainFramework::PerfProfiler::GetActive() == &profiler;
+    if (ImGui::Checkbox("Enabled", &enabled))
+    {
+        BrainFramework::PerfProfiler::SetActive(enabled ? &profiler : nullptr);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Reset"))
+    {
+        profiler.Reset();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Dump"))
+    {
+        std::ofstream file("perf.json");
+        profiler.WriteJson(file);
+    }
+
+    const BrainFramework::PerfCounters& counters = BrainFramework::PerfCounters::GetThreadCounters();
+    if (ImGui::BeginTable("PerfPhases", 4 + BrainFramework::PerfCounters::COUNT, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Phase");
+        ImGui::TableSetupColumn("Calls");
+        ImGui::TableSetupColumn("ns/call");
+        for (int i = 0; i < BrainFramework::PerfCounters::COUNT; ++i)
+        {
+            ImGui::TableSetupColumn(BrainFramework::PerfCounters::GetCounterName(static_cast<BrainFramework::PerfCounters::Counter>(i)));
+        }
+        ImGui::TableSetupColumn("counted %"); // Below 100, the kernel multiplexed the counters and they are scaled estimates
+        ImGui::TableHeadersRow();
+
+        for (const auto& entry : profiler.GetPhases())
+        {
+            const BrainFramework::PerfProfiler::Phase& phase = entry.second;
+            const double calls = static_cast<double>(phase.calls);
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", entry.first.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(phase.calls));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", phase.timeNs / calls);
+            for (int i = 0; i < BrainFramework::PerfCounters::COUNT; ++i)
+            {
+                ImGui::TableNextColumn();
+                if (counters.IsAvailable(static_cast<BrainFramework::PerfCounters::Counter>(i)))
+                    ImGui::Text("%.1f", phase.counters[i] / calls);
+                else
+                    ImGui::TextDisabled("n/a");
+            }
+            ImGui::TableNextColumn();
+            if (phase.countersEnabledNs > 0)
+            {
+                const double counted = 100.0 * phase.countersRunningNs / phase.countersEnabledNs;
+                if (phase.IsMultiplexed())
+                    ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "%.1f", counted);
+                else
+                    ImGui::Text("%.1f", counted);
+            }
+            else
+                ImGui::TextDisabled("n/a");
+        }
+        ImGui::EndTable();
+    }
+}
+
+void DisplayLatencyHistograms()
+{
+    bool enabled = BrainFramework::LatencyHistogram::IsEnabled();
+    if (ImGui::Checkbox("Enabled##Latency", &enabled))
+    {
+        BrainFramework::LatencyHistogram::SetEnabled(enabled);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Reset##Latency"))
+    {
+        for (BrainFramework::LatencyHistogram* histogram : BrainFramework::LatencyHistogram::GetAll())
+        {
+            histogram->Reset();
+        }
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Export text"))
+    {
+        std::ofstream file("latency.txt");
+        BrainFramework::LatencyHistogram::WriteText(file);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Export JSON"))
+    {
+        std::ofstream file("latency.json");
+        BrainFramework::LatencyHistogram::WriteJson(file);
+    }
+
+    if (ImGui::BeginTable("LatencyHistograms", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Histogram");
+        ImGui::TableSetupColumn("Count");
+        ImGui::TableSetupColumn("Mean ns");
+        ImGui::TableSetupColumn("p50 ns");
+        ImGui::TableSetupColumn("p99 ns");
+        ImGui::TableSetupColumn("p99.9 ns");
+        ImGui::TableSetupColumn("Max ns");
+        ImGui::TableHeadersRow();
+
+        for (const BrainFramework::LatencyHistogram* histogram : BrainFramework::LatencyHistogram::GetAll())
+        {
+            const BrainFramework::LatencyHistogram::Snapshot snapshot = histogram->GetSnapshot();
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", histogram->GetName().c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(snapshot.count));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", snapshot.GetMean());
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(snapshot.GetPercentile(0.5)));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(snapshot.GetPercentile(0.99)));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(snapshot.GetPercentile(0.999)));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(snapshot.max));
+        }
+        ImGui::EndTable();
+    }
+}
+
+// Runs training steps in a loop away from the UI frame, so training goes as fast as the workers allow
+class TrainingThread
+{
+public:
+    TrainingThread() = default;
+    TrainingThread(const TrainingThread&) = delete;
+    TrainingThread& operator=(const TrainingThread&) = delete;
+    ~TrainingThread() { Stop(); }
+
+    void Start(std::function<void()> step)
+    {
+        Stop();
+        m_Stopping.store(false, std::memory_order_relaxed);
+        m_Thread = std::thread([this, step = std::move(step)]()
+        {
+            while (!m_Stopping.load(std::memory_order_relaxed))
+            {
+                step();
+            }
+        });
+    }
+
+    // Returns once the step in progress is done
+    void Stop()
+    {
+        m_Stopping.store(true, std::memory_order_relaxed);
+        if (m_Thread.joinable())
+            m_Thread.join();
+    }
+
+private:
+    std::thread m_Thread;
+    std::atomic<bool> m_Stopping{ false };
+};
+
 enum class State
 {
     Config,
@@ -57,17 +226,126 @@ enum class State
 
 int main()
 {
-    std::srand(static_cast<unsigned int>(std::time(nullptr)));
+    BrainFramework::Random::SetRunSeed(static_cast<std::uint64_t>(std::time(nullptr)));
+
+    BrainFramework::TaskScheduler taskScheduler;
+    BrainFramework::LayeredNeuralNetwork::SetTaskScheduler(&taskScheduler);
+
+    const std::string kernelTuningFilename = "kernels.tuning";
+    BrainFramework::PerfProfiler perfProfiler;
+
+    BrainFramework::KernelTuner kernelTuner(&taskScheduler);
+    kernelTuner.LoadFromFile(kernelTuningFilename);
+    BrainFramework::LayeredNeuralNetwork::SetKernelTuner(&kernelTuner);
 
     std::unique_ptr<BrainFramework::ISimulation> simulationPtr = nullptr;
     std::vector<Player> players;
 
+    // Single player training of a model supporting it evaluates whole generations in parallel
+    std::unique_ptr<BrainFramework::BatchEvaluator> batchEvaluator;
+    std::vector<BrainFramework::EvaluationJob> evaluationJobs;
+
     State state = State::Config;
 
-    int trainingSteps = 10;
+    // Written by the UI, read by the training thread
+    std::atomic<int> trainingSteps{ 10 };
+    std::atomic<int> episodeMode{ static_cast<int>(BrainFramework::BatchEvaluator::EpisodeMode::Auto) };
     bool isTraining = false;
     bool isPlaying = false;
 
+    // Every player trains for a few steps, in a loop on the training thread
+    // Settings requested from the UI take effect between two of these
+    auto train = [&]()
+    {
+        for (Player& player : players)
+        {
+            player.model->ApplySettings();
+        }
+
+        // Nothing runs on the scheduler between two training steps, the shapes met during the last one are measured now
+        kernelTuner.TunePending();
+
+        const int steps = trainingSteps.load(std::memory_order_relaxed);
+
+        // Each training step is the rest of a generation
+        if (batchEvaluator != nullptr)
+        {
+            batchEvaluator->SetEpisodeMode(static_cast<BrainFramework::BatchEvaluator::EpisodeMode>(episodeMode.load(std::memory_order_relaxed)));
+
+            Player& player = players[0];
+
+            // An async model never waits for a whole generation, each training step is a fixed count of jobs
+            if (player.model->SupportsAsync())
+            {
+                constexpr int k_AsyncJobsPerTrainingStep = 100;
+                batchEvaluator->EvaluateAsync(*player.model, steps * k_AsyncJobsPerTrainingStep);
+                return;
+            }
+
+            for (int trainingStep = 0; trainingStep < steps; ++trainingStep)
+            {
+                if (!player.model->PrepareBatch(evaluationJobs))
+                    break;
+
+                batchEvaluator->Evaluate(evaluationJobs);
+                player.model->EndBatch(evaluationJobs);
+            }
+            return;
+        }
+
+        BrainFramework::LatencyHistogram& stepLatency = BrainFramework::LatencyHistogram::Get(std::string(simulationPtr->GetName()) + "::Step");
+
+        for (int trainingStep = 0; trainingStep < steps; ++trainingStep)
+        {
+            // The episode is drawn from the evaluation nodes of every player sharing it
+            std::uint64_t episodeSeed = BrainFramework::Random::GetRunSeed();
+            for (const Player& player : players)
+            {
+                episodeSeed = BrainFramework::DeriveSeed(episodeSeed, player.model->GetEvaluationSeed());
+            }
+            BrainFramework::RandomScope episodeScope(episodeSeed);
+
+            simulationPtr->Initialize();
+
+            for (Player& player : players)
+            {
+                player.model->StartEvaluation(player.neuralNetwork);
+                player.agent = simulationPtr->CreateRLAgent(*player.neuralNetwork);
+                player.agent->Initialize();
+            }
+
+            bool simualtionShouldContinue = true;
+            bool someAgentIsStillPlaying = true;
+
+            do
+            {
+                simualtionShouldContinue = !simulationPtr->IsFinished();
+                someAgentIsStillPlaying = false;
+
+                for (Player& player : players)
+                {
+                    BrainFramework::LatencyScope latencyScope(stepLatency);
+                    auto result = player.agent->Step();
+                    if (result == BrainFramework::AgentInterface::Result::Ongoing)
+                    {
+                        someAgentIsStillPlaying = true;
+                    }
+                }
+
+            } while (simualtionShouldContinue && someAgentIsStillPlaying);
+
+            for (Player& player : players)
+            {
+                player.model->EndEvalutation(player.agent->GetReward());
+                simulationPtr->RemoveAgent(player.agent);
+                player.agent = nullptr;
+            }
+        }
+    };
+
+    // Declared after everything it trains, so it stops first
+    TrainingThread trainingThread;
+
     Application app;
     app.Run([&]()
     {  
@@ -132,6 +410,16 @@ int main()
                     }
                 }
 
+                if (state == State::Train && ImGui::CollapsingHeader("PerfCounters"))
+                {
+                    DisplayPerfProfiler(perfProfiler);
+                }
+
+                if (state == State::Train && ImGui::CollapsingHeader("Latency"))
+                {
+                    DisplayLatencyHistograms();
+                }
+
                 switch (state)
                 {
                 case State::Config:
@@ -171,10 +459,18 @@ int main()
                     if (ImGui::Button("Train"))
                     {
                         state = State::Train;
-                        for (Player& player : players)
+                        for (std::size_t i = 0; i < players.size(); ++i)
                         {
-                            player.model->PrepareTraining(*simulationPtr);
+                            players[i].model->SetSeed(BrainFramework::DeriveSeed(BrainFramework::Random::GetRunSeed(), i));
+                            players[i].model->PrepareTraining(*simulationPtr);
                         }
+
+                        if (players.size() == 1 && players[0].model->SupportsBatch())
+                        {
+                            batchEvaluator = std::make_unique<BrainFramework::BatchEvaluator>(&taskScheduler, *simulationPtr);
+                        }
+
+                        trainingThread.Start(train);
                     }
                     ImGui::SameLine();
                     if (ImGui::Button("Play"))
@@ -196,53 +492,24 @@ int main()
 
                 case State::Train:
                 {
-                    ImGui::InputInt("TrainingSteps", &trainingSteps);
-                    if (trainingSteps < 1)
-                        trainingSteps = 1;
+                    int steps = trainingSteps.load(std::memory_order_relaxed);
+                    if (ImGui::InputInt("TrainingSteps", &steps))
+                        trainingSteps.store(std::max(steps, 1), std::memory_order_relaxed);
 
                     if (ImGui::Button("Stop training"))
                     {
+                        trainingThread.Stop();
                         state = State::Menu;
+                        batchEvaluator.reset();
                     }
 
-                    for (int trainingStep = 0; trainingStep < trainingSteps; ++trainingStep)
+                    if (batchEvaluator != nullptr)
                     {
-                        simulationPtr->Initialize();
-
-                        for (Player& player : players)
-                        {
-                            player.model->StartEvaluation(player.neuralNetwork);
-                            player.agent = simulationPtr->CreateRLAgent(*player.neuralNetwork);
-                            player.agent->Initialize();
-                        }
-
-                        bool simualtionShouldContinue = true;
-                        bool someAgentIsStillPlaying = true;
-
-                        do
-                        {
-                            simualtionShouldContinue = !simulationPtr->IsFinished();
-                            someAgentIsStillPlaying = false;
-
-                            for (Player& player : players)
-                            {
-                                auto result = player.agent->Step();
-                                if (result == BrainFramework::AgentInterface::Result::Ongoing)
-                                {
-                                    someAgentIsStillPlaying = true;
-                                }
-                            }
-
-                        } while (simualtionShouldContinue && someAgentIsStillPlaying);
-
-                        for (Player& player : players)
-                        {
-                            player.model->EndEvalutation(player.agent->GetReward());
-                            simulationPtr->RemoveAgent(player.agent); // TODO : Reset agent on Initialize ?
-                            player.agent = nullptr;
-                        }
+                        const char* episodeModes[] = { "Auto", "Scalar", "Vector", "Coroutine" };
+                        int mode = episodeMode.load(std::memory_order_relaxed);
+                        if (ImGui::Combo("Episodes", &mode, episodeModes, IM_ARRAYSIZE(episodeModes)))
+                            episodeMode.store(mode, std::memory_order_relaxed);
                     }
-
                 } break;
 
                 case State::Play:
@@ -274,7 +541,7 @@ int main()
                             for (Player& player : players)
                             {
                                 player.model->EndEvalutation(player.agent->GetReward());
-                                simulationPtr->RemoveAgent(player.agent); // TODO : Reset agent on Initialize ?
+                                simulationPtr->RemoveAgent(player.agent);
                                 player.agent = nullptr;
                             }
                         }
@@ -302,5 +569,8 @@ int main()
         ImGui::End();
     });
 
+    trainingThread.Stop();
+    kernelTuner.SaveToFile(kernelTuningFilename);
+
     return 0;
 }
@@ -18,6 +18,8 @@ public:
         Ongoing
     };
 
+    virtual ~AgentInterface() = default;
+
     virtual void Initialize() = 0;
     virtual Result Step() = 0;
 
@@ -40,10 +42,24 @@ protected:
     void SetGameScore(float gameScore) { m_GameScore = gameScore; }
     Result MarkResult(Result result) { m_Result = result; return result; }
 
+    // Back to the state of a new agent, for the Initialize of pooled agents
+    void ResetAgent()
+    {
+        m_Result = Result::None;
+        m_GameScore = 0.0f;
+        m_Reward = 0.0f;
+    }
+
     Logger* m_Logger{ nullptr };
     Result m_Result{ Result::None };
     float m_GameScore{ 0.0f };
     float m_Reward{ 0.0f };
+
+private:
+    template <typename BaseAgentType>
+    friend class Simulation;
+
+    int m_Slot{ -1 }; // In the agents of its simulation
 };
 
 } // namespace BrainFramework
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace BrainFramework
+{
+
+// Latest immutable value one thread publishes for the others, swapped in as a whole
+// A reader keeps the value it got for as long as it holds it, whatever gets published meanwhile
+// Values are built and released outside the flag, which only covers a pointer copy, so nobody ever waits on a publisher's work
+template <typename T>
+class AtomicSnapshot
+{
+public:
+    void Publish(T value)
+    {
+        std::shared_ptr<const T> snapshot = std::make_shared<const T>(std::move(value));
+        Lock();
+        m_Value.swap(snapshot);
+        Unlock();
+    }
+
+    // Null until something is published
+    std::shared_ptr<const T> Get() const
+    {
+        Lock();
+        std::shared_ptr<const T> value = m_Value;
+        Unlock();
+        return value;
+    }
+
+    // Clears the value, unless something newer than the expected one was published since
+    void Clear(const std::shared_ptr<const T>& expected)
+    {
+        std::shared_ptr<const T> previous;
+        Lock();
+        if (m_Value == expected)
+            m_Value.swap(previous);
+        Unlock();
+    }
+
+private:
+    void Lock() const
+    {
+        while (m_Locked.exchange(true, std::memory_order_acquire))
+        {
+            while (m_Locked.load(std::memory_order_relaxed))
+                std::this_thread::yield();
+        }
+    }
+
+    void Unlock() const { m_Locked.store(false, std::memory_order_release); }
+
+    std::shared_ptr<const T> m_Value;
+    mutable std::atomic<bool> m_Locked{ false };
+};
+
+} // namespace BrainFramework
@@ -0,0 +1,215 @@
+#include "Backpropagation.hpp"
+
+namespace BrainFramework
+{
+
+namespace
+{
+
+// Derivative of Sigmoid expressed from its output: d/dx (2 / (1 + e^(-4.9x)) - 1) = 2.45 * (1 - y^2)
+inline float SigmoidDerivativeFromOutput(float y)
+{
+    return 2.45f * (1.0f - y * y);
+}
+
+} // namespace
+
+float LayeredBackpropagation::Train(const std::vector<int>& layerSizes, std::vector<float>& weights, const std::vector<Sample>& samples)
+{
+    if (!Prepare(layerSizes, weights, samples))
+    {
+        return -1.0f;
+    }
+
+    // Every call is an independent refinement, nothing is carried from a previous genome
+    std::fill(m_FirstMoments.begin(), m_FirstMoments.end(), 0.0f);
+    std::fill(m_SecondMoments.begin(), m_SecondMoments.end(), 0.0f);
+    m_AdamStep = 0;
+
+    const int samplesCount = static_cast<int>(samples.size());
+    const int batchSize = (m_Settings.batchSize > 0 && m_Settings.batchSize < samplesCount) ? m_Settings.batchSize : samplesCount;
+
+    int sampleIndex = 0;
+    for (int step = 0; step < m_Settings.steps; ++step)
+    {
+        std::fill(m_Gradients.begin(), m_Gradients.end(), 0.0f);
+        for (int i = 0; i < batchSize; ++i)
+        {
+            const Sample& sample = samples[sampleIndex];
+            Forward(layerSizes, weights, sample.inputs);
+            Backward(layerSizes, weights, sample.targets);
+            sampleIndex = (sampleIndex + 1) % samplesCount;
+        }
+        ApplyGradients(weights, batchSize);
+    }
+
+    return ComputeLoss(layerSizes, weights, samples);
+}
+
+float LayeredBackpropagation::ComputeLoss(const std::vector<int>& layerSizes, const std::vector<float>& weights, const std::vector<Sample>& samples)
+{
+    if (!Prepare(layerSizes, weights, samples))
+    {
+        return -1.0f;
+    }
+
+    const int outputs = layerSizes.back();
+    const int outputsStart = m_ValueOffsets.back();
+
+    float loss = 0.0f;
+    for (const Sample& sample : samples)
+    {
+        Forward(layerSizes, weights, sample.inputs);
+        for (int o = 0; o < outputs; ++o)
+        {
+            const float error = m_Values[outputsStart + o] - sample.targets[o];
+            loss += 0.5f * error * error;
+        }
+    }
+    return loss / static_cast<float>(samples.size());
+}
+
+bool LayeredBackpropagation::Prepare(const std::vector<int>& layerSizes, const std::vector<float>& weights, const std::vector<Sample>& samples)
+{
+    if (layerSizes.size() < 2 || samples.empty())
+        return false;
+
+    const int layers = static_cast<int>(layerSizes.size());
+    m_WeightOffsets.assign(layers, 0);
+    m_ValueOffsets.assign(layers, 0);
+    for (int layer = 1; layer < layers; ++layer)
+    {
+        m_WeightOffsets[layer] = m_WeightOffsets[layer - 1] + (layer > 1 ? layerSizes[layer - 1] * layerSizes[layer - 2] : 0);
+        m_ValueOffsets[layer] = m_ValueOffsets[layer - 1] + layerSizes[layer - 1];
+    }
+
+    const int weightsCount = m_WeightOffsets.back() + layerSizes[layers - 1] * layerSizes[layers - 2];
+    if (weightsCount != static_cast<int>(weights.size()))
+        return false;
+
+    for (const Sample& sample : samples)
+    {
+        if (static_cast<int>(sample.inputs.size()) != layerSizes[0] || static_cast<int>(sample.targets.size()) != layerSizes.back())
+            return false;
+    }
+
+    const int neurons = m_ValueOffsets.back() + layerSizes.back();
+    m_Values.resize(neurons);
+    m_Deltas.resize(neurons);
+
+    m_Gradients.resize(weights.size());
+    m_FirstMoments.resize(weights.size());
+    m_SecondMoments.resize(weights.size());
+
+    return true;
+}
+
+void LayeredBackpropagation::Forward(const std::vector<int>& layerSizes, const std::vector<float>& weights, const std::vector<float>& inputs)
+{
+    for (int i = 0; i < layerSizes[0]; ++i)
+    {
+        m_Values[i] = inputs[i];
+    }
+
+    // Same weight indexing as LayeredNeuralNetwork::Evaluate
+    const int layers = static_cast<int>(layerSizes.size());
+    for (int layer = 1; layer < layers; ++layer)
+    {
+        const float* layerWeights = weights.data() + m_WeightOffsets[layer];
+        const float* previousValues = m_Values.data() + m_ValueOffsets[layer - 1];
+        float* values = m_Values.data() + m_ValueOffsets[layer];
+        for (int iOnLayer = 0; iOnLayer < layerSizes[layer]; ++iOnLayer)
+        {
+            float sum = 0.0f;
+            for (int iOnPreviousLayer = 0; iOnPreviousLayer < layerSizes[layer - 1]; ++iOnPreviousLayer)
+            {
+                sum += layerWeights[iOnPreviousLayer + iOnLayer * iOnPreviousLayer] * previousValues[iOnPreviousLayer];
+            }
+            values[iOnLayer] = Sigmoid(sum);
+        }
+    }
+}
+
+void LayeredBackpropagation::Backward(const std::vector<int>& layerSizes, const std::vector<float>& weights, const std::vector<float>& targets)
+{
+    const int layers = static_cast<int>(layerSizes.size());
+
+    // Output deltas
+    const int outputsStart = m_ValueOffsets.back();
+    for (int o = 0; o < layerSizes.back(); ++o)
+    {
+        const float output = m_Values[outputsStart + o];
+        m_Deltas[outputsStart + o] = (output - targets[o]) * SigmoidDerivativeFromOutput(output);
+    }
+
+    // Accumulate gradients and propagate deltas backward, a weight may be read by several links so gradients are summed
+    for (int layer = layers - 1; layer >= 1; --layer)
+    {
+        const int previousLayerSize = layerSizes[layer - 1];
+        const int weightOffset = m_WeightOffsets[layer];
+        const float* previousValues = m_Values.data() + m_ValueOffsets[layer - 1];
+        const float* deltas = m_Deltas.data() + m_ValueOffsets[layer];
+        float* previousDeltas = m_Deltas.data() + m_ValueOffsets[layer - 1];
+
+        for (int iOnPreviousLayer = 0; iOnPreviousLayer < previousLayerSize; ++iOnPreviousLayer)
+        {
+            previousDeltas[iOnPreviousLayer] = 0.0f;
+        }
+
+        for (int iOnLayer = 0; iOnLayer < layerSizes[layer]; ++iOnLayer)
+        {
+            const float delta = deltas[iOnLayer];
+            for (int iOnPreviousLayer = 0; iOnPreviousLayer < previousLayerSize; ++iOnPreviousLayer)
+            {
+                const int weightIndex = weightOffset + iOnPreviousLayer + iOnLayer * iOnPreviousLayer;
+                m_Gradients[weightIndex] += delta * previousValues[iOnPreviousLayer];
+                previousDeltas[iOnPreviousLayer] += weights[weightIndex] * delta;
+            }
+        }
+
+        if (layer > 1)
+        {
+            for (int iOnPreviousLayer = 0; iOnPreviousLayer < previousLayerSize; ++iOnPreviousLayer)
+            {
+                previousDeltas[iOnPreviousLayer] *= SigmoidDerivativeFromOutput(previousValues[iOnPreviousLayer]);
+            }
+        }
+    }
+}
+
+void LayeredBackpropagation::ApplyGradients(std::vector<float>& weights, int batchSize)
+{
+    const float scale = 1.0f / static_cast<float>(batchSize);
+    const int weightsCount = static_cast<int>(weights.size());
+
+    switch (m_Settings.optimizer)
+    {
+    case Optimizer::SGD:
+    {
+        for (int i = 0; i < weightsCount; ++i)
+        {
+            weights[i] -= m_Settings.learningRate * m_Gradients[i] * scale;
+        }
+    } break;
+
+    case Optimizer::Adam:
+    {
+        m_AdamStep++;
+        const float beta1 = m_Settings.beta1;
+        const float beta2 = m_Settings.beta2;
+        const float correction1 = 1.0f - std::pow(beta1, static_cast<float>(m_AdamStep));
+        const float correction2 = 1.0f - std::pow(beta2, static_cast<float>(m_AdamStep));
+        for (int i = 0; i < weightsCount; ++i)
+        {
+            const float gradient = m_Gradients[i] * scale;
+            m_FirstMoments[i] = beta1 * m_FirstMoments[i] + (1.0f - beta1) * gradient;
+            m_SecondMoments[i] = beta2 * m_SecondMoments[i] + (1.0f - beta2) * gradient * gradient;
+            const float firstMoment = m_FirstMoments[i] / correction1;
+            const float secondMoment = m_SecondMoments[i] / correction2;
+            weights[i] -= m_Settings.learningRate * firstMoment / (std::sqrt(secondMoment) + m_Settings.epsilon);
+        }
+    } break;
+    }
+}
+
+} // namespace BrainFramework
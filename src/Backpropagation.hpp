@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Utils.hpp"
+
+namespace BrainFramework
+{
+
+// Gradient descent over the weights of a LayeredNeuralNetwork, using the exact same propagation and Sigmoid
+// Works on the raw layer sizes and weights so genomes can be refined in place without building a network
+class LayeredBackpropagation
+{
+public:
+    enum class Optimizer
+    {
+        SGD,
+        Adam
+    };
+
+    struct Settings
+    {
+        Optimizer optimizer{ Optimizer::Adam };
+        float learningRate{ 0.01f };
+        float beta1{ 0.9f };
+        float beta2{ 0.999f };
+        float epsilon{ 1e-8f };
+        int steps{ 10 };
+        int batchSize{ 0 }; // 0 for the whole samples set on each step
+    };
+
+    struct Sample
+    {
+        std::vector<float> inputs;
+        std::vector<float> targets;
+    };
+
+    LayeredBackpropagation() = default;
+    explicit LayeredBackpropagation(const Settings& settings) : m_Settings(settings) {}
+    LayeredBackpropagation(const LayeredBackpropagation&) = delete;
+    LayeredBackpropagation& operator=(const LayeredBackpropagation&) = delete;
+
+    // Runs the configured amount of optimizer steps and returns the loss after them, or a negative value if samples don't match
+    float Train(const std::vector<int>& layerSizes, std::vector<float>& weights, const std::vector<Sample>& samples);
+
+    // Half mean squared error over the samples
+    float ComputeLoss(const std::vector<int>& layerSizes, const std::vector<float>& weights, const std::vector<Sample>& samples);
+
+    void SetSettings(const Settings& settings) { m_Settings = settings; }
+    const Settings& GetSettings() const { return m_Settings; }
+
+private:
+    bool Prepare(const std::vector<int>& layerSizes, const std::vector<float>& weights, const std::vector<Sample>& samples);
+    void Forward(const std::vector<int>& layerSizes, const std::vector<float>& weights, const std::vector<float>& inputs);
+    void Backward(const std::vector<int>& layerSizes, const std::vector<float>& weights, const std::vector<float>& targets);
+    void ApplyGradients(std::vector<float>& weights, int batchSize);
+
+    Settings m_Settings;
+    std::vector<float> m_Values;
+    std::vector<float> m_Deltas;
+    std::vector<float> m_Gradients;
+    std::vector<float> m_FirstMoments;
+    std::vector<float> m_SecondMoments;
+    std::vector<int> m_WeightOffsets;
+    std::vector<int> m_ValueOffsets;
+    int m_AdamStep{ 0 };
+};
+
+} // namespace BrainFramework
@@ -0,0 +1,287 @@
+#include "BatchEvaluator.hpp"
+
+#include "TaskScheduler.hpp"
+#include "PerfCounters.hpp"
+#include "LatencyHistogram.hpp"
+
+namespace BrainFramework
+{
+
+BatchEvaluator::BatchEvaluator(TaskScheduler* taskScheduler, const ISimulation& simulation)
+    : m_TaskScheduler(taskScheduler)
+    , m_Simulation(simulation)
+    , m_StepLatency(LatencyHistogram::Get(std::string(simulation.GetName()) + "::Step"))
+{
+    // Kept for the first job that needs one
+    if (std::unique_ptr<VectorSimulation> vectorSimulation = m_Simulation.CreateVectorSimulation(k_VectorLanes))
+    {
+        m_HasVectorSimulation = true;
+        m_FreeVectorSimulations.push_back(std::move(vectorSimulation));
+    }
+
+    // The task starts suspended, probing for it runs nothing
+    CoroutineAgent probeAgent;
+    m_HasCoroutineEpisode = static_cast<bool>(m_Simulation.PlayEpisode(probeAgent));
+}
+
+BatchEvaluator::EpisodeMode BatchEvaluator::GetEffectiveEpisodeMode() const
+{
+    if (m_EpisodeMode == EpisodeMode::Scalar)
+        return EpisodeMode::Scalar;
+    if (m_EpisodeMode == EpisodeMode::Coroutine && m_HasCoroutineEpisode)
+        return EpisodeMode::Coroutine;
+    if (m_HasVectorSimulation)
+        return EpisodeMode::Vector;
+    if (m_HasCoroutineEpisode)
+        return EpisodeMode::Coroutine;
+    return EpisodeMode::Scalar;
+}
+
+void BatchEvaluator::Evaluate(std::vector<EvaluationJob>& jobs)
+{
+    PerfScope perfScope("BatchEvaluator::Evaluate");
+
+    const int jobsCount = static_cast<int>(jobs.size());
+    if (m_TaskScheduler == nullptr)
+    {
+        for (EvaluationJob& job : jobs)
+        {
+            RunJob(job);
+        }
+        return;
+    }
+
+    m_TaskScheduler->ParallelFor(0, jobsCount, 1, [&](int jobBegin, int jobEnd)
+    {
+        for (int i = jobBegin; i < jobEnd; ++i)
+        {
+            RunJob(jobs[i]);
+        }
+    });
+}
+
+void BatchEvaluator::EvaluateAsync(Model& model, int jobsCount)
+{
+    PerfScope perfScope("BatchEvaluator::EvaluateAsync");
+
+    std::atomic<int> remainingJobs{ jobsCount };
+    auto work = [&]()
+    {
+        EvaluationJob job;
+        while (remainingJobs.fetch_sub(1, std::memory_order_relaxed) > 0)
+        {
+            // Every genome is taken by another worker, which will finish the remaining jobs
+            if (!model.AcquireJob(job))
+            {
+                remainingJobs.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+
+            RunJob(job);
+            model.CompleteJob(job);
+        }
+    };
+
+    if (m_TaskScheduler == nullptr)
+    {
+        work();
+        return;
+    }
+
+    // One long running task per worker instead of one per job
+    m_TaskScheduler->ParallelFor(0, m_TaskScheduler->GetWorkersCount(), 1, [&](int, int)
+    {
+        work();
+    });
+}
+
+float BatchEvaluator::RunEpisode(ISimulation& simulation, NeuralNetwork& neuralNetwork, std::uint64_t seed, LatencyHistogram* stepLatency)
+{
+    PerfScope perfScope("BatchEvaluator::RunEpisode");
+    RandomScope episodeScope(seed);
+
+    simulation.Initialize();
+
+    AgentInterface* agent = simulation.CreateRLAgent(neuralNetwork);
+    agent->Initialize();
+
+    bool simulationShouldContinue = true;
+    AgentInterface::Result result = AgentInterface::Result::None;
+    do
+    {
+        simulationShouldContinue = !simulation.IsFinished();
+
+        LatencyScope latencyScope(stepLatency);
+        result = agent->Step();
+    } while (simulationShouldContinue && result == AgentInterface::Result::Ongoing);
+
+    const float reward = agent->GetReward();
+    simulation.RemoveAgent(agent);
+    return reward;
+}
+
+bool BatchEvaluator::RunEpisodes(VectorSimulation& simulation, NeuralNetwork& neuralNetwork, std::span<const std::uint64_t> seeds, std::span<float> rewards)
+{
+    PerfScope perfScope("BatchEvaluator::RunEpisodes");
+
+    const int observationsCount = simulation.GetObservationsCount();
+    const int actionsCount = simulation.GetActionsCount();
+    const std::size_t maxLanes = static_cast<std::size_t>(simulation.GetLanesCount());
+
+    thread_local std::vector<float> observations;
+    thread_local std::vector<float> actions;
+    thread_local std::vector<float> stepRewards;
+    thread_local std::vector<std::uint8_t> done;
+    observations.resize(maxLanes * observationsCount);
+    actions.resize(maxLanes * actionsCount);
+    stepRewards.resize(maxLanes);
+    done.resize(maxLanes);
+
+    simulation.Reset(seeds, observations);
+
+    const int lanes = simulation.GetUsedLanesCount();
+    const std::span<const float> laneObservations(observations.data(), static_cast<std::size_t>(lanes) * observationsCount);
+    const std::span<float> laneActions(actions.data(), static_cast<std::size_t>(lanes) * actionsCount);
+    for (int lane = 0; lane < lanes; ++lane)
+    {
+        neuralNetwork.ResetBatchState(lane);
+    }
+
+    while (!simulation.IsFinished())
+    {
+        if (!neuralNetwork.EvaluateBatch(laneObservations, laneActions, lanes))
+            return false;
+
+        simulation.StepBatch(laneActions, observations, stepRewards, done);
+
+        // Lanes that moved on to another episode start it from cleared network values
+        for (int lane = 0; lane < lanes; ++lane)
+        {
+            if (done[lane] && simulation.GetLaneEpisode(lane) >= 0)
+                neuralNetwork.ResetBatchState(lane);
+        }
+    }
+
+    const std::vector<float>& episodeRewards = simulation.GetEpisodeRewards();
+    std::copy(episodeRewards.begin(), episodeRewards.end(), rewards.begin());
+    return true;
+}
+
+std::uint64_t BatchEvaluator::GetEpisodeSeed(std::uint64_t evaluationSeed)
+{
+    return DeriveSeed(Random::GetRunSeed(), evaluationSeed);
+}
+
+void BatchEvaluator::RunJob(EvaluationJob& job)
+{
+    job.results.assign(job.evaluationSeeds.size(), 0.0f);
+
+    std::shared_ptr<NeuralNetwork> neuralNetwork;
+    if (!job.makeNeuralNetwork || !job.makeNeuralNetwork(neuralNetwork))
+    {
+        return;
+    }
+
+    const EpisodeMode episodeMode = GetEffectiveEpisodeMode();
+    if (episodeMode != EpisodeMode::Scalar)
+    {
+        thread_local std::vector<std::uint64_t> episodeSeeds;
+        episodeSeeds.clear();
+        for (std::uint64_t evaluationSeed : job.evaluationSeeds)
+        {
+            episodeSeeds.push_back(GetEpisodeSeed(evaluationSeed));
+        }
+
+        bool succeeded = false;
+        if (episodeMode == EpisodeMode::Vector)
+        {
+            std::unique_ptr<VectorSimulation> vectorSimulation = AcquireVectorSimulation();
+            succeeded = RunEpisodes(*vectorSimulation, *neuralNetwork, episodeSeeds, job.results);
+            ReleaseVectorSimulation(std::move(vectorSimulation));
+        }
+        else
+        {
+            std::unique_ptr<CoroutineScheduler> coroutineScheduler = AcquireCoroutineScheduler();
+            succeeded = coroutineScheduler->Run(m_Simulation, *neuralNetwork, episodeSeeds, job.results);
+            ReleaseCoroutineScheduler(std::move(coroutineScheduler));
+        }
+
+        if (!succeeded)
+        {
+            std::fill(job.results.begin(), job.results.end(), 0.0f);
+        }
+        return;
+    }
+
+    // Released before returning, a task stolen while this job waits gets a simulation of its own
+    std::unique_ptr<ISimulation> simulation = AcquireSimulation();
+    for (std::size_t i = 0; i < job.evaluationSeeds.size(); ++i)
+    {
+        // Every episode starts from cleared network values, as StartEvaluation gives them
+        neuralNetwork->ResetState();
+        job.results[i] = RunEpisode(*simulation, *neuralNetwork, GetEpisodeSeed(job.evaluationSeeds[i]), &m_StepLatency);
+    }
+    ReleaseSimulation(std::move(simulation));
+}
+
+std::unique_ptr<ISimulation> BatchEvaluator::AcquireSimulation()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (!m_FreeSimulations.empty())
+        {
+            std::unique_ptr<ISimulation> simulation = std::move(m_FreeSimulations.back());
+            m_FreeSimulations.pop_back();
+            return simulation;
+        }
+    }
+    return m_Simulation.Clone();
+}
+
+void BatchEvaluator::ReleaseSimulation(std::unique_ptr<ISimulation> simulation)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_FreeSimulations.push_back(std::move(simulation));
+}
+
+std::unique_ptr<VectorSimulation> BatchEvaluator::AcquireVectorSimulation()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (!m_FreeVectorSimulations.empty())
+        {
+            std::unique_ptr<VectorSimulation> simulation = std::move(m_FreeVectorSimulations.back());
+            m_FreeVectorSimulations.pop_back();
+            return simulation;
+        }
+    }
+    return m_Simulation.CreateVectorSimulation(k_VectorLanes);
+}
+
+void BatchEvaluator::ReleaseVectorSimulation(std::unique_ptr<VectorSimulation> simulation)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_FreeVectorSimulations.push_back(std::move(simulation));
+}
+
+std::unique_ptr<CoroutineScheduler> BatchEvaluator::AcquireCoroutineScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (!m_FreeCoroutineSchedulers.empty())
+        {
+            std::unique_ptr<CoroutineScheduler> coroutineScheduler = std::move(m_FreeCoroutineSchedulers.back());
+            m_FreeCoroutineSchedulers.pop_back();
+            return coroutineScheduler;
+        }
+    }
+    return std::make_unique<CoroutineScheduler>(k_VectorLanes);
+}
+
+void BatchEvaluator::ReleaseCoroutineScheduler(std::unique_ptr<CoroutineScheduler> coroutineScheduler)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_FreeCoroutineSchedulers.push_back(std::move(coroutineScheduler));
+}
+
+} // namespace BrainFramework
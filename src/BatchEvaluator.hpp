@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Model.hpp"
+
+#include <mutex>
+
+namespace BrainFramework
+{
+
+class TaskScheduler;
+class LatencyHistogram;
+
+// Runs the evaluation jobs of a model across the task scheduler, one job per task
+// Every running job gets a clone of the simulation, created on demand and reused by the next jobs
+// Simulations with a vectorized version or coroutine episodes play all the episodes of a job at once, one lane each
+class BatchEvaluator
+{
+public:
+    // How the episodes of a job are played, every mode gives the same results
+    enum class EpisodeMode
+    {
+        Auto, // Vector, then Coroutine, then Scalar, whichever the simulation supports first
+        Scalar,
+        Vector,
+        Coroutine
+    };
+
+    BatchEvaluator(TaskScheduler* taskScheduler, const ISimulation& simulation);
+    BatchEvaluator(const BatchEvaluator&) = delete;
+    BatchEvaluator& operator=(const BatchEvaluator&) = delete;
+
+    // Modes the simulation doesn't support fall back to Auto
+    void SetEpisodeMode(EpisodeMode episodeMode) { m_EpisodeMode = episodeMode; }
+    EpisodeMode GetEpisodeMode() const { return m_EpisodeMode; }
+    EpisodeMode GetEffectiveEpisodeMode() const;
+
+    // Fills the results of every job, returns once all of them are done
+    void Evaluate(std::vector<EvaluationJob>& jobs);
+
+    // Runs jobsCount jobs of an async model, each worker acquires its next job as soon as it completed the last one
+    // Only this call waits for the slowest job, returns early when the model has no free genome left
+    void EvaluateAsync(Model& model, int jobsCount);
+
+    // One agent driven through one episode of the simulation, returns its reward
+    // The episode draws all its randomness from the seed, its steps are recorded in stepLatency when given
+    static float RunEpisode(ISimulation& simulation, NeuralNetwork& neuralNetwork, std::uint64_t seed, LatencyHistogram* stepLatency = nullptr);
+
+    // Every episode played with the same network, evaluated on all lanes at once, writes the reward of each
+    static bool RunEpisodes(VectorSimulation& simulation, NeuralNetwork& neuralNetwork, std::span<const std::uint64_t> seeds, std::span<float> rewards);
+
+    // Lanes of the vectorized simulations, jobs with fewer episodes only use some of them
+    static constexpr int k_VectorLanes = 64;
+
+    // Seed of the episode of a single player evaluation, derived from the run seed
+    static std::uint64_t GetEpisodeSeed(std::uint64_t evaluationSeed);
+
+private:
+    void RunJob(EvaluationJob& job);
+
+    std::unique_ptr<ISimulation> AcquireSimulation();
+    void ReleaseSimulation(std::unique_ptr<ISimulation> simulation);
+    std::unique_ptr<VectorSimulation> AcquireVectorSimulation();
+    void ReleaseVectorSimulation(std::unique_ptr<VectorSimulation> simulation);
+    std::unique_ptr<CoroutineScheduler> AcquireCoroutineScheduler();
+    void ReleaseCoroutineScheduler(std::unique_ptr<CoroutineScheduler> coroutineScheduler);
+
+    TaskScheduler* m_TaskScheduler;
+    const ISimulation& m_Simulation;
+    LatencyHistogram& m_StepLatency; // Looked up once, the registry is locked
+    EpisodeMode m_EpisodeMode{ EpisodeMode::Auto };
+    bool m_HasVectorSimulation{ false };
+    bool m_HasCoroutineEpisode{ false };
+    std::vector<std::unique_ptr<ISimulation>> m_FreeSimulations;
+    std::vector<std::unique_ptr<VectorSimulation>> m_FreeVectorSimulations;
+    std::vector<std::unique_ptr<CoroutineScheduler>> m_FreeCoroutineSchedulers;
+    std::mutex m_Mutex;
+};
+
+} // namespace BrainFramework
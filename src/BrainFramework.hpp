@@ -1,7 +1,25 @@
 #pragma once
 
+#include "Random.hpp"
+#include "Hash.hpp"
+#include "ByteStream.hpp"
+#include "AtomicSnapshot.hpp"
 #include "Utils.hpp"
 #include "NeuralNetwork.hpp"
+#include "TaskScheduler.hpp"
+#include "KernelTuner.hpp"
+#include "PerfCounters.hpp"
+#include "LatencyHistogram.hpp"
+#include "Backpropagation.hpp"
 #include "AgentInterface.hpp"
+#include "VectorSimulation.hpp"
+#include "CoroutineAgent.hpp"
 #include "Simulation.hpp"
-#include "Model.hpp"
\ No newline at end of file
+#include "ScenarioSet.hpp"
+#include "EvaluationRace.hpp"
+#include "SteadyStatePopulation.hpp"
+#include "MigrationMailbox.hpp"
+#include "Model.hpp"
+#include "PopulationModel.hpp"
+#include "BatchEvaluator.hpp"
+#include "RemoteEvaluation.hpp"
\ No newline at end of file
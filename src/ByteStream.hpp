@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace BrainFramework
+{
+
+// Small values of either sign map to small unsigned ones: 0, -1, 1, -2... to 0, 1, 2, 3...
+inline std::uint64_t ZigZagEncode(std::int64_t value) { return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63); }
+inline std::int64_t ZigZagDecode(std::uint64_t value) { return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1); }
+
+// Genomes and messages as flat bytes, in the byte order of the machine: they only travel between builds running on the same kind
+// Integers go as varints where they are usually small, floats as they are
+class ByteWriter
+{
+public:
+    template <typename T>
+    void Write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        WriteBytes(&value, sizeof(T));
+    }
+
+    // Fills in a value written earlier as a placeholder, such as a size known once what follows is written
+    template <typename T>
+    void WriteAt(std::size_t offset, const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        std::memcpy(m_Bytes.data() + offset, &value, sizeof(T));
+    }
+
+    // LEB128, 7 bits per byte, values below 128 take one
+    void WriteVarint(std::uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            m_Bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        m_Bytes.push_back(static_cast<std::uint8_t>(value));
+    }
+
+    void WriteSignedVarint(std::int64_t value) { WriteVarint(ZigZagEncode(value)); }
+
+    void WriteString(const std::string& value)
+    {
+        WriteVarint(value.size());
+        WriteBytes(value.data(), value.size());
+    }
+
+    void WriteBytes(const void* data, std::size_t size)
+    {
+        const std::size_t offset = m_Bytes.size();
+        m_Bytes.resize(offset + size);
+        std::memcpy(m_Bytes.data() + offset, data, size);
+    }
+
+    void Clear() { m_Bytes.clear(); }
+
+    const std::vector<std::uint8_t>& GetBytes() const { return m_Bytes; }
+
+private:
+    std::vector<std::uint8_t> m_Bytes;
+};
+
+// Reads what a ByteWriter wrote, a read past the end fails and so does every later one
+class ByteReader
+{
+public:
+    ByteReader(const std::uint8_t* data, std::size_t size) : m_Data(data), m_Size(size) {}
+    explicit ByteReader(const std::vector<std::uint8_t>& bytes) : ByteReader(bytes.data(), bytes.size()) {}
+
+    template <typename T>
+    bool Read(T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        return ReadBytes(&value, sizeof(T));
+    }
+
+    bool ReadVarint(std::uint64_t& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            std::uint8_t byte = 0;
+            if (!Read(byte))
+                return false;
+
+            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                return true;
+        }
+
+        m_Failed = true;
+        return false;
+    }
+
+    bool ReadSignedVarint(std::int64_t& value)
+    {
+        std::uint64_t encoded = 0;
+        if (!ReadVarint(encoded))
+            return false;
+
+        value = ZigZagDecode(encoded);
+        return true;
+    }
+
+    // Fails on values above max, so a count read is checked before anything is sized on it
+    bool ReadVarint(int& value, int max)
+    {
+        std::uint64_t encoded = 0;
+        if (!ReadVarint(encoded) || encoded > static_cast<std::uint64_t>(max))
+        {
+            m_Failed = true;
+            return false;
+        }
+
+        value = static_cast<int>(encoded);
+        return true;
+    }
+
+    bool ReadString(std::string& value)
+    {
+        std::uint64_t size = 0;
+        if (!ReadVarint(size) || size > GetRemaining())
+        {
+            m_Failed = true;
+            return false;
+        }
+
+        value.resize(static_cast<std::size_t>(size));
+        return ReadBytes(value.data(), value.size());
+    }
+
+    bool ReadBytes(void* data, std::size_t size)
+    {
+        if (m_Failed || size > m_Size - m_Offset)
+        {
+            m_Failed = true;
+            return false;
+        }
+
+        std::memcpy(data, m_Data + m_Offset, size);
+        m_Offset += size;
+        return true;
+    }
+
+    // Bounds the counts read from the bytes before anything is allocated for them
+    std::size_t GetRemaining() const { return m_Size - m_Offset; }
+    bool HasFailed() const { return m_Failed; }
+
+private:
+    const std::uint8_t* m_Data{ nullptr };
+    std::size_t m_Size{ 0 };
+    std::size_t m_Offset{ 0 };
+    bool m_Failed{ false };
+};
+
+} // namespace BrainFramework
@@ -0,0 +1,111 @@
+#include "CoroutineAgent.hpp"
+
+#include "Simulation.hpp"
+#include "PerfCounters.hpp"
+
+namespace BrainFramework
+{
+
+CoroutineScheduler::CoroutineScheduler(int lanes)
+    : m_Slots(std::max(lanes, 1))
+{
+}
+
+bool CoroutineScheduler::Run(const ISimulation& simulation, NeuralNetwork& neuralNetwork, std::span<const std::uint64_t> seeds, std::span<float> rewards)
+{
+    PerfScope perfScope("CoroutineScheduler::Run");
+
+    const int inputsCount = neuralNetwork.GetInputsCount();
+    const int outputsCount = neuralNetwork.GetOutputsCount();
+    const int episodes = static_cast<int>(seeds.size());
+    const int lanes = std::min(GetLanesCount(), episodes);
+    if (lanes == 0)
+        return true;
+
+    m_Inputs.resize(static_cast<std::size_t>(lanes) * inputsCount);
+    m_Outputs.resize(static_cast<std::size_t>(lanes) * outputsCount);
+
+    int nextEpisode = 0;
+    int activeLanes = 0;
+    bool succeeded = true;
+
+    // Runs the episode of the lane up to its next decision, the lane moves on to the next episodes as the previous ones end
+    auto advance = [&](int lane)
+    {
+        Slot& slot = m_Slots[lane];
+        while (true)
+        {
+            if (slot.episode < 0)
+            {
+                if (nextEpisode >= episodes)
+                    return true;
+
+                slot.episode = nextEpisode++;
+                slot.agent.Start(seeds[slot.episode], inputsCount, outputsCount);
+                slot.task = simulation.PlayEpisode(slot.agent);
+                if (!slot.task)
+                    return false;
+
+                neuralNetwork.ResetBatchState(lane);
+                activeLanes++;
+            }
+
+            slot.agent.m_Pending = false;
+            slot.task.Resume();
+            if (!slot.task.IsDone())
+                return true;
+
+            rewards[slot.episode] = slot.agent.GetReward();
+            slot.task = EpisodeTask();
+            slot.episode = -1;
+            activeLanes--;
+        }
+    };
+
+    for (int lane = 0; lane < lanes && succeeded; ++lane)
+    {
+        succeeded = advance(lane);
+    }
+
+    while (succeeded && activeLanes > 0)
+    {
+        // Idle lanes are evaluated on zeros, their rows are ignored
+        for (int lane = 0; lane < lanes; ++lane)
+        {
+            float* inputs = m_Inputs.data() + static_cast<std::size_t>(lane) * inputsCount;
+            const Slot& slot = m_Slots[lane];
+            if (slot.episode >= 0)
+                std::copy(slot.agent.m_Inputs.begin(), slot.agent.m_Inputs.end(), inputs);
+            else
+                std::fill_n(inputs, inputsCount, 0.0f);
+        }
+
+        if (!neuralNetwork.EvaluateBatch(m_Inputs, m_Outputs, lanes))
+        {
+            succeeded = false;
+            break;
+        }
+
+        for (int lane = 0; lane < lanes && succeeded; ++lane)
+        {
+            Slot& slot = m_Slots[lane];
+            if (slot.episode < 0 || !slot.agent.m_Pending)
+                continue;
+
+            const float* outputs = m_Outputs.data() + static_cast<std::size_t>(lane) * outputsCount;
+            std::copy(outputs, outputs + outputsCount, slot.agent.m_Outputs.begin());
+            succeeded = advance(lane);
+        }
+    }
+
+    // Episodes left suspended by a failure are dropped
+    for (Slot& slot : m_Slots)
+    {
+        slot.task = EpisodeTask();
+        slot.episode = -1;
+    }
+
+    return succeeded;
+}
+
+} // namespace BrainFramework
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "Utils.hpp"
+
+#include <coroutine>
+#include <utility>
+
+namespace BrainFramework
+{
+
+class ISimulation;
+class NeuralNetwork;
+
+// Coroutine of one episode, written as straight-line code that co_awaits the decisions of its agent
+// Starts suspended, the CoroutineScheduler owning it resumes it
+class EpisodeTask
+{
+public:
+    struct promise_type
+    {
+        EpisodeTask get_return_object() { return EpisodeTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    EpisodeTask() = default;
+    explicit EpisodeTask(std::coroutine_handle<promise_type> handle) : m_Handle(handle) {}
+    EpisodeTask(EpisodeTask&& other) noexcept : m_Handle(std::exchange(other.m_Handle, nullptr)) {}
+    EpisodeTask& operator=(EpisodeTask&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Destroy();
+            m_Handle = std::exchange(other.m_Handle, nullptr);
+        }
+        return *this;
+    }
+    ~EpisodeTask() { Destroy(); }
+
+    EpisodeTask(const EpisodeTask&) = delete;
+    EpisodeTask& operator=(const EpisodeTask&) = delete;
+
+    // Empty when the simulation has no coroutine episode
+    explicit operator bool() const { return m_Handle != nullptr; }
+    bool IsDone() const { return m_Handle == nullptr || m_Handle.done(); }
+    void Resume() { m_Handle.resume(); }
+
+private:
+    void Destroy()
+    {
+        if (m_Handle != nullptr)
+        {
+            m_Handle.destroy();
+            m_Handle = nullptr;
+        }
+    }
+
+    std::coroutine_handle<promise_type> m_Handle;
+};
+
+// The agent side of a coroutine episode: its decisions, its reward and the random stream of the episode
+class CoroutineAgent
+{
+public:
+    class DecisionAwaiter
+    {
+    public:
+        explicit DecisionAwaiter(CoroutineAgent& agent) : m_Agent(agent) {}
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<>) noexcept { m_Agent.m_Pending = true; }
+        std::span<const float> await_resume() const noexcept { return m_Agent.m_Outputs; }
+
+    private:
+        CoroutineAgent& m_Agent;
+    };
+
+    // Suspends the episode until the scheduler evaluated the inputs, along with the decisions of every other episode
+    // The outputs stay valid until the next decision
+    DecisionAwaiter Decide(std::span<const float> inputs)
+    {
+        std::copy_n(inputs.begin(), std::min(inputs.size(), m_Inputs.size()), m_Inputs.begin());
+        return DecisionAwaiter(*this);
+    }
+
+    void AddReward(float reward) { m_Reward += reward; }
+    float GetReward() const { return m_Reward; }
+
+    // Every random draw of the episode comes from here, seeded as ISimulation::SeedRandom would be
+    RandomStream& GetRandom() { return m_Random; }
+
+private:
+    friend class CoroutineScheduler;
+
+    void Start(std::uint64_t seed, int inputsCount, int outputsCount)
+    {
+        RandomStream episodeStream(seed);
+        m_Random.Reset(episodeStream.NextUInt64(), 0);
+        m_Inputs.assign(inputsCount, 0.0f);
+        m_Outputs.assign(outputsCount, 0.0f);
+        m_Reward = 0.0f;
+        m_Pending = false;
+    }
+
+    RandomStream m_Random;
+    std::vector<float> m_Inputs;
+    std::vector<float> m_Outputs;
+    float m_Reward{ 0.0f };
+    bool m_Pending{ false };
+};
+
+// Keeps up to lanes coroutine episodes suspended at once and evaluates all their pending decisions in one batch
+class CoroutineScheduler
+{
+public:
+    explicit CoroutineScheduler(int lanes);
+    CoroutineScheduler(const CoroutineScheduler&) = delete;
+    CoroutineScheduler& operator=(const CoroutineScheduler&) = delete;
+
+    // Plays one episode per seed with the network and writes the reward of each
+    // Fails when the simulation has no coroutine episode or an evaluation fails
+    bool Run(const ISimulation& simulation, NeuralNetwork& neuralNetwork, std::span<const std::uint64_t> seeds, std::span<float> rewards);
+
+    int GetLanesCount() const { return static_cast<int>(m_Slots.size()); }
+
+private:
+    struct Slot
+    {
+        CoroutineAgent agent;
+        EpisodeTask task;
+        int episode{ -1 };
+    };
+
+    std::vector<Slot> m_Slots;
+    std::vector<float> m_Inputs;
+    std::vector<float> m_Outputs;
+};
+
+} // namespace BrainFramework
@@ -0,0 +1,225 @@
+#include "EvaluationRace.hpp"
+
+#include <cmath>
+#include <limits>
+
+namespace BrainFramework
+{
+
+void EvaluationRace::Start(int candidates, std::span<const int> cutoffs, const Settings& settings)
+{
+    m_Settings = settings;
+    m_Settings.maxEpisodes = std::max(m_Settings.maxEpisodes, 1);
+    m_Settings.firstRoundEpisodes = std::clamp(m_Settings.firstRoundEpisodes, 1, m_Settings.maxEpisodes);
+
+    m_Candidates.resize(std::max(candidates, 0));
+    for (Candidate& candidate : m_Candidates)
+    {
+        candidate.results.clear();
+        candidate.results.reserve(m_Settings.maxEpisodes);
+        candidate.episodes = 0;
+        candidate.sum = 0.0;
+        candidate.sumSquares = 0.0;
+        candidate.history = 0.0f;
+        candidate.lifetime = 0;
+    }
+    m_ScenarioEffects.assign(m_Settings.maxEpisodes, 0.0);
+
+    // Only cutoffs that split the candidates can be raced for
+    m_Cutoffs.clear();
+    for (int cutoff : cutoffs)
+    {
+        if (cutoff > 0 && cutoff < candidates)
+            m_Cutoffs.push_back(cutoff);
+    }
+    m_Round = 0;
+    m_TotalEpisodes = 0;
+
+    // Everyone plays the first round, even when the budget is too short for it
+    int firstRoundEpisodes = m_Settings.firstRoundEpisodes;
+    if (m_Settings.episodeBudget > 0 && candidates > 0)
+        firstRoundEpisodes = std::clamp(m_Settings.episodeBudget / candidates, 1, firstRoundEpisodes);
+
+    m_RoundCandidates.resize(m_Candidates.size());
+    for (int i = 0; i < static_cast<int>(m_RoundCandidates.size()); ++i)
+    {
+        m_RoundCandidates[i] = i;
+    }
+    m_RoundEpisodes.assign(m_Candidates.size(), firstRoundEpisodes);
+    m_FirstRoundEpisodes = firstRoundEpisodes;
+}
+
+void EvaluationRace::SetHistory(int candidate, float averageScore, int lifetime)
+{
+    m_Candidates[candidate].history = averageScore;
+    m_Candidates[candidate].lifetime = lifetime;
+}
+
+float EvaluationRace::GetMean(int candidate) const
+{
+    const Candidate& entry = m_Candidates[candidate];
+    return entry.episodes > 0 ? static_cast<float>(entry.sum / entry.episodes) : 0.0f;
+}
+
+void EvaluationRace::UpdateStatistics()
+{
+    // Paired estimate of how much easier each scenario was than the first round ones, from the candidates that played both
+    std::fill(m_ScenarioEffects.begin(), m_ScenarioEffects.end(), 0.0);
+    if (m_Settings.commonScenarios)
+    {
+        const int scenarios = static_cast<int>(m_ScenarioEffects.size());
+        thread_local std::vector<double> sums;
+        thread_local std::vector<int> counts;
+        sums.assign(scenarios, 0.0);
+        counts.assign(scenarios, 0);
+
+        double firstRoundSum = 0.0;
+        int firstRoundCount = 0;
+        for (const Candidate& candidate : m_Candidates)
+        {
+            const int firstRound = std::min(static_cast<int>(candidate.results.size()), m_FirstRoundEpisodes);
+            if (firstRound == 0)
+                continue;
+
+            double firstRoundMean = 0.0;
+            for (int e = 0; e < firstRound; ++e)
+            {
+                firstRoundMean += candidate.results[e];
+            }
+            firstRoundMean /= firstRound;
+            firstRoundSum += firstRoundMean;
+            firstRoundCount++;
+
+            for (int e = 0; e < std::min(static_cast<int>(candidate.results.size()), scenarios); ++e)
+            {
+                sums[e] += e < m_FirstRoundEpisodes ? candidate.results[e] : candidate.results[e] - firstRoundMean;
+                counts[e]++;
+            }
+        }
+
+        const double firstRoundMean = firstRoundCount > 0 ? firstRoundSum / firstRoundCount : 0.0;
+        for (int e = 0; e < scenarios; ++e)
+        {
+            if (counts[e] > 0)
+                m_ScenarioEffects[e] = e < m_FirstRoundEpisodes ? sums[e] / counts[e] - firstRoundMean : sums[e] / counts[e];
+        }
+    }
+
+    for (Candidate& candidate : m_Candidates)
+    {
+        candidate.episodes = static_cast<int>(candidate.results.size());
+        candidate.sum = 0.0;
+        candidate.sumSquares = 0.0;
+        for (int e = 0; e < candidate.episodes; ++e)
+        {
+            const double result = candidate.results[e] - (e < static_cast<int>(m_ScenarioEffects.size()) ? m_ScenarioEffects[e] : 0.0);
+            candidate.sum += result;
+            candidate.sumSquares += result * result;
+        }
+    }
+}
+
+double EvaluationRace::GetVariance(const Candidate& candidate, double pooledVariance) const
+{
+    if (candidate.episodes < 2)
+        return pooledVariance;
+
+    // Few episodes often agree by chance, so the own estimate is shrunk toward the pooled one
+    const double mean = candidate.sum / candidate.episodes;
+    const double squares = std::max(0.0, candidate.sumSquares - candidate.episodes * mean * mean);
+    return (squares + k_PriorDegrees * pooledVariance) / (candidate.episodes - 1 + k_PriorDegrees);
+}
+
+bool EvaluationRace::NextRound()
+{
+    m_Round++;
+    m_RoundCandidates.clear();
+    m_RoundEpisodes.clear();
+
+    UpdateStatistics();
+
+    const int count = static_cast<int>(m_Candidates.size());
+    if (m_Cutoffs.empty())
+        return false;
+
+    // Candidates with a single episode borrow the noise of the others
+    double squaresSum = 0.0;
+    int degrees = 0;
+    for (const Candidate& candidate : m_Candidates)
+    {
+        if (candidate.episodes >= 2)
+        {
+            const double mean = candidate.sum / candidate.episodes;
+            squaresSum += std::max(0.0, candidate.sumSquares - candidate.episodes * mean * mean);
+            degrees += candidate.episodes - 1;
+        }
+    }
+    const double pooledVariance = degrees > 0 ? squaresSum / degrees : std::numeric_limits<double>::infinity();
+
+    // Ranked on the score the caller will sort on, the race result averaged with the history
+    thread_local std::vector<double> scores;
+    thread_local std::vector<int> order;
+    scores.resize(count);
+    order.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        const Candidate& candidate = m_Candidates[i];
+        scores[i] = (candidate.lifetime * static_cast<double>(candidate.history) + candidate.sum / std::max(candidate.episodes, 1)) / (candidate.lifetime + 1);
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return scores[a] > scores[b]; });
+
+    thread_local std::vector<double> cutoffScores;
+    cutoffScores.clear();
+    for (int cutoff : m_Cutoffs)
+    {
+        cutoffScores.push_back(0.5 * (scores[order[cutoff - 1]] + scores[order[cutoff]]));
+    }
+
+    // Contenders are still undecided, the closest to a cutoff relative to their interval come first
+    thread_local std::vector<std::pair<double, int>> contenders;
+    contenders.clear();
+    for (int i = 0; i < count; ++i)
+    {
+        const Candidate& candidate = m_Candidates[i];
+        if (candidate.episodes >= m_Settings.maxEpisodes)
+            continue;
+
+        const double standardError = std::sqrt(GetVariance(candidate, pooledVariance) / std::max(candidate.episodes, 1)) / (candidate.lifetime + 1);
+        const double halfWidth = m_Settings.confidence * standardError;
+        double gap = std::numeric_limits<double>::infinity();
+        for (double cutoffScore : cutoffScores)
+        {
+            gap = std::min(gap, std::abs(scores[i] - cutoffScore));
+        }
+        if (halfWidth > 0.0 && gap <= halfWidth)
+            contenders.emplace_back(gap / halfWidth, i);
+    }
+    std::stable_sort(contenders.begin(), contenders.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    thread_local std::vector<std::pair<int, int>> selected;
+    selected.clear();
+    int remainingBudget = m_Settings.episodeBudget > 0 ? m_Settings.episodeBudget - m_TotalEpisodes : std::numeric_limits<int>::max();
+    for (const auto& [closeness, candidate] : contenders)
+    {
+        const int played = m_Candidates[candidate].episodes;
+        const int episodes = std::min({ std::max(played, 1), m_Settings.maxEpisodes - played, remainingBudget });
+        if (episodes <= 0)
+            break;
+
+        selected.emplace_back(candidate, episodes);
+        remainingBudget -= episodes;
+    }
+
+    // Played in population order, so the order of the episodes does not depend on the closeness ranking
+    std::sort(selected.begin(), selected.end());
+    for (const auto& [candidate, episodes] : selected)
+    {
+        m_RoundCandidates.push_back(candidate);
+        m_RoundEpisodes.push_back(episodes);
+    }
+
+    return !m_RoundCandidates.empty();
+}
+
+} // namespace BrainFramework
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Utils.hpp"
+
+namespace BrainFramework
+{
+
+// Spreads the episodes of a generation over candidates whose scores are noisy, racing them against the selection cutoffs
+// Every candidate plays a first cheap round, after which only those whose confidence interval still holds a cutoff play more
+// Each further round doubles the episodes of those candidates, the closest calls are served first when the budget runs short
+class EvaluationRace
+{
+public:
+    struct Settings
+    {
+        int firstRoundEpisodes{ 2 };
+        int maxEpisodes{ 8 }; // Per candidate
+        int episodeBudget{ 0 }; // Per race, 0 only bounds it by maxEpisodes
+        float confidence{ 1.96f }; // Half width of the interval, in standard errors
+        bool commonScenarios{ false }; // Episode k of every candidate plays the same scenario, see ScenarioSet
+    };
+
+    // Candidates are ranked on their score, each cutoff is a count of best candidates the caller tells apart from the rest
+    // (survivors, parents, the best one...) once the race is over
+    void Start(int candidates, std::span<const int> cutoffs, const Settings& settings);
+
+    // Score the race result gets averaged with once it is over, as a lifetime average would be
+    void SetHistory(int candidate, float averageScore, int lifetime);
+
+    // Candidates of the current round in increasing order, and the episodes each one plays in it
+    const std::vector<int>& GetRoundCandidates() const { return m_RoundCandidates; }
+    int GetRoundEpisodes(int roundIndex) const { return m_RoundEpisodes[roundIndex]; }
+
+    // Results of a candidate come in episode order
+    void AddResult(int candidate, float result)
+    {
+        m_Candidates[candidate].results.push_back(result);
+        m_TotalEpisodes++;
+    }
+
+    // Ends the current round and picks the candidates of the next one, false once the race is over
+    bool NextRound();
+
+    const Settings& GetSettings() const { return m_Settings; }
+    int GetCandidatesCount() const { return static_cast<int>(m_Candidates.size()); }
+    int GetEpisodes(int candidate) const { return static_cast<int>(m_Candidates[candidate].results.size()); }
+
+    // Mean result as of the last NextRound, with common scenarios it is corrected for how hard the scenarios played were
+    float GetMean(int candidate) const;
+    int GetTotalEpisodes() const { return m_TotalEpisodes; }
+    int GetRound() const { return m_Round; }
+
+private:
+    struct Candidate
+    {
+        std::vector<float> results;
+        int episodes{ 0 };
+        double sum{ 0.0 };
+        double sumSquares{ 0.0 };
+        float history{ 0.0f };
+        int lifetime{ 0 };
+    };
+
+    void UpdateStatistics();
+    double GetVariance(const Candidate& candidate, double pooledVariance) const;
+
+    static constexpr double k_PriorDegrees = 4.0; // Weight of the pooled variance, in episodes
+
+    Settings m_Settings;
+    std::vector<Candidate> m_Candidates;
+    std::vector<int> m_Cutoffs;
+    std::vector<double> m_ScenarioEffects;
+    int m_FirstRoundEpisodes{ 0 };
+    int m_Round{ 0 };
+    int m_TotalEpisodes{ 0 };
+
+    std::vector<int> m_RoundCandidates;
+    std::vector<int> m_RoundEpisodes;
+};
+
+} // namespace BrainFramework
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Random.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+namespace BrainFramework
+{
+
+// 128 bits are enough for a few million keys to never collide in practice, so equal hashes are taken as equal keys
+struct Hash128
+{
+    std::uint64_t low{ 0 };
+    std::uint64_t high{ 0 };
+
+    bool operator==(const Hash128& other) const = default;
+
+    // For std::unordered_map, the halves are already well mixed
+    struct Hasher
+    {
+        std::size_t operator()(const Hash128& hash) const { return static_cast<std::size_t>(hash.low ^ hash.high); }
+    };
+};
+
+// Order dependent hash of a sequence of values, two independent lanes of SplitMix64
+class Hash128Builder
+{
+public:
+    void Add(std::uint64_t value)
+    {
+        m_Hash.low = SplitMix64(m_Hash.low ^ value);
+        m_Hash.high = SplitMix64(m_Hash.high + value * k_HighMultiplier);
+        m_Count++;
+    }
+
+    void Add(std::int64_t value) { Add(static_cast<std::uint64_t>(value)); }
+    void Add(int value) { Add(static_cast<std::uint64_t>(static_cast<std::int64_t>(value))); }
+
+    // The length is folded in, so sequences that are prefixes of one another differ
+    Hash128 Get() const
+    {
+        return { SplitMix64(m_Hash.low ^ m_Count), SplitMix64(m_Hash.high + m_Count * k_HighMultiplier) };
+    }
+
+private:
+    static constexpr std::uint64_t k_HighMultiplier = 0xD6E8FEB86659FD93ull;
+
+    Hash128 m_Hash{ 0x6A09E667F3BCC908ull, 0xBB67AE8584CAA73Bull };
+    std::uint64_t m_Count{ 0 };
+};
+
+// Hash of raw bytes, read as 8 byte words, the byte count is folded in so trailing zeros count
+inline Hash128 HashBytes(std::span<const std::uint8_t> bytes)
+{
+    Hash128Builder builder;
+    builder.Add(static_cast<std::uint64_t>(bytes.size()));
+    for (std::size_t offset = 0; offset < bytes.size(); offset += sizeof(std::uint64_t))
+    {
+        std::uint64_t word = 0;
+        std::memcpy(&word, bytes.data() + offset, std::min(sizeof(std::uint64_t), bytes.size() - offset));
+        builder.Add(word);
+    }
+    return builder.Get();
+}
+
+} // namespace BrainFramework
@@ -0,0 +1,202 @@
+#include "KernelTuner.hpp"
+
+#include "NeuralNetwork.hpp"
+#include "TaskScheduler.hpp"
+
+#include <chrono>
+#include <thread>
+
+namespace BrainFramework
+{
+
+namespace
+{
+
+int Log2Bucket(long long value)
+{
+    int bucket = 0;
+    while (value > 1)
+    {
+        value >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+} // namespace
+
+KernelTuner::KernelTuner(TaskScheduler* taskScheduler)
+    : m_TaskScheduler(taskScheduler)
+{
+}
+
+std::uint32_t KernelTuner::GetShapeClass(const std::vector<int>& layerSizes)
+{
+    int maxWidth = 0;
+    long long links = 0;
+    const int layers = static_cast<int>(layerSizes.size());
+    for (int i = 1; i < layers; ++i)
+    {
+        maxWidth = std::max(maxWidth, layerSizes[i]);
+        links += static_cast<long long>(layerSizes[i - 1]) * layerSizes[i];
+    }
+    const int depth = std::min(layers - 1, 8);
+
+    return (static_cast<std::uint32_t>(Log2Bucket(maxWidth)) << 16) | (static_cast<std::uint32_t>(Log2Bucket(links)) << 8) | static_cast<std::uint32_t>(depth);
+}
+
+int KernelTuner::Select(const std::vector<int>& layerSizes)
+{
+    if (m_TaskScheduler == nullptr || m_TaskScheduler->GetWorkersCount() <= 1)
+        return 1;
+
+    // Too small for any layer to be split, no need to measure
+    long long maxLayerLinks = 0;
+    for (std::size_t i = 1; i < layerSizes.size(); ++i)
+        maxLayerLinks = std::max(maxLayerLinks, static_cast<long long>(layerSizes[i - 1]) * layerSizes[i]);
+    if (maxLayerLinks < 2 * LayeredNeuralNetwork::k_MinParallelLinksPerWorker)
+        return 1;
+
+    const std::uint32_t shapeClass = GetShapeClass(layerSizes);
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = m_Table.find(shapeClass);
+    if (it != m_Table.end())
+        return it->second.workers;
+
+    m_Pending.try_emplace(shapeClass, layerSizes);
+    return 0;
+}
+
+KernelTuner::Choice KernelTuner::Tune(const std::vector<int>& layerSizes)
+{
+    Choice best;
+    if (m_TaskScheduler == nullptr || m_TaskScheduler != LayeredNeuralNetwork::GetTaskScheduler() || layerSizes.size() < 2)
+        return best;
+
+    // Own stream, tuning must not shift the draws of the work that triggered it
+    RandomScope tuningScope(GetShapeClass(layerSizes));
+
+    std::vector<float> weights;
+    for (std::size_t i = 1; i < layerSizes.size(); ++i)
+        weights.resize(weights.size() + static_cast<std::size_t>(layerSizes[i - 1]) * layerSizes[i]);
+    for (float& weight : weights)
+        weight = RandomFloat(-1.0f, 1.0f);
+
+    LayeredNeuralNetwork network;
+    if (network.Make(layerSizes, weights))
+    {
+        std::vector<float> inputs(network.GetInputsCount());
+        std::vector<float> outputs(network.GetOutputsCount());
+        for (float& input : inputs)
+            input = RandomFloat(-1.0f, 1.0f);
+
+        // Serial, then powers of two up to the whole scheduler
+        std::vector<int> candidates = { 1 };
+        for (int workers = 2; workers < m_TaskScheduler->GetWorkersCount(); workers *= 2)
+            candidates.push_back(workers);
+        if (m_TaskScheduler->GetWorkersCount() > 1)
+            candidates.push_back(m_TaskScheduler->GetWorkersCount());
+
+        using Clock = std::chrono::steady_clock;
+        for (int workers : candidates)
+        {
+            network.SetMaxWorkers(workers);
+            network.Evaluate(inputs, outputs);
+
+            int evaluations = 0;
+            const Clock::time_point start = Clock::now();
+            float elapsedMs = 0.0f;
+            do
+            {
+                network.Evaluate(inputs, outputs);
+                evaluations++;
+                elapsedMs = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+            } while (elapsedMs < m_MeasureTimeMs);
+
+            const float nsPerEvaluation = elapsedMs * 1e6f / static_cast<float>(evaluations);
+            if (best.nsPerEvaluation <= 0.0f || nsPerEvaluation < best.nsPerEvaluation)
+            {
+                best.workers = workers;
+                best.nsPerEvaluation = nsPerEvaluation;
+            }
+        }
+    }
+
+    // The network measured went through Select too, its class is no longer pending
+    const std::uint32_t shapeClass = GetShapeClass(layerSizes);
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Table[shapeClass] = best;
+    m_Pending.erase(shapeClass);
+    return best;
+}
+
+int KernelTuner::TunePending()
+{
+    std::unordered_map<std::uint32_t, std::vector<int>> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        pending.swap(m_Pending);
+    }
+
+    for (const auto& entry : pending)
+    {
+        Tune(entry.second);
+    }
+    return static_cast<int>(pending.size());
+}
+
+bool KernelTuner::LoadFromFile(const std::string& filename)
+{
+    std::ifstream file(filename);
+    if (!file)
+        return false;
+
+    std::string line;
+    if (!std::getline(file, line) || line != GetHostSignature())
+        return false;
+
+    std::unordered_map<std::uint32_t, Choice> table;
+    while (std::getline(file, line))
+    {
+        std::stringstream lineStream(line);
+        std::uint32_t shapeClass = 0;
+        Choice choice;
+        if (lineStream >> shapeClass >> choice.workers >> choice.nsPerEvaluation)
+            table[shapeClass] = choice;
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (const auto& entry : table)
+        m_Table[entry.first] = entry.second;
+    return true;
+}
+
+bool KernelTuner::SaveToFile(const std::string& filename) const
+{
+    std::ofstream file(filename);
+    if (!file)
+        return false;
+
+    file << GetHostSignature() << std::endl;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (const auto& entry : m_Table)
+        file << entry.first << " " << entry.second.workers << " " << entry.second.nsPerEvaluation << std::endl;
+
+    file.close();
+    return true;
+}
+
+int KernelTuner::GetTunedClassesCount() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return static_cast<int>(m_Table.size());
+}
+
+std::string KernelTuner::GetHostSignature() const
+{
+    const int workers = m_TaskScheduler != nullptr ? m_TaskScheduler->GetWorkersCount() : 1;
+    return "BrainFrameworkKernels threads=" + std::to_string(std::thread::hardware_concurrency()) + " workers=" + std::to_string(workers) + " l2=" + std::to_string(TaskScheduler::GetL2CacheSize());
+}
+
+} // namespace BrainFramework
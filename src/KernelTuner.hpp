@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Utils.hpp"
+
+#include <mutex>
+
+namespace BrainFramework
+{
+
+class TaskScheduler;
+
+// Picks the evaluation kernel of LayeredNeuralNetwork per shape class, by measuring the candidates on this host
+// The task scheduler must be the one set on LayeredNeuralNetwork
+// Results are kept in a tuning table that can be saved and reloaded so a machine only pays the measurements once
+// Measuring needs the scheduler to itself, so it never happens while networks are built, only when the owner asks for it
+class KernelTuner
+{
+public:
+    struct Choice
+    {
+        int workers{ 1 }; // 1 for the serial kernel, more for the row-split parallel kernel
+        float nsPerEvaluation{ 0.0f };
+    };
+
+    explicit KernelTuner(TaskScheduler* taskScheduler);
+    KernelTuner(const KernelTuner&) = delete;
+    KernelTuner& operator=(const KernelTuner&) = delete;
+
+    // Networks of the same class have close max layer width, links count and depth
+    static std::uint32_t GetShapeClass(const std::vector<int>& layerSizes);
+
+    // Maximum amount of workers the network should use, only reads the tuning table, safe from any thread
+    // Returns 0 when the shape class isn't tuned yet, leaving the decision to the cost model, the class is then kept for TunePending
+    int Select(const std::vector<int>& layerSizes);
+
+    // Both measure on the task scheduler, they must be called from outside its tasks while it runs nothing else
+    // Before training starts for the shapes known up front, and between training steps for the classes Select missed
+    Choice Tune(const std::vector<int>& layerSizes);
+    int TunePending();
+
+    void SetMeasureTime(float measureTimeMs) { m_MeasureTimeMs = measureTimeMs; }
+
+    // The file starts with a host signature, results measured on another kind of machine are ignored
+    bool LoadFromFile(const std::string& filename);
+    bool SaveToFile(const std::string& filename) const;
+
+    int GetTunedClassesCount() const;
+
+private:
+    std::string GetHostSignature() const;
+
+    TaskScheduler* m_TaskScheduler;
+    std::unordered_map<std::uint32_t, Choice> m_Table;
+    std::unordered_map<std::uint32_t, std::vector<int>> m_Pending; // Layer sizes of a network of each class Select missed
+    mutable std::mutex m_Mutex;
+    float m_MeasureTimeMs{ 2.0f };
+};
+
+} // namespace BrainFramework
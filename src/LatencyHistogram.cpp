@@ -0,0 +1,163 @@
+#include "LatencyHistogram.hpp"
+
+#include <map>
+
+namespace BrainFramework
+{
+
+namespace
+{
+
+struct Registry
+{
+    std::mutex mutex;
+    std::map<std::string, std::unique_ptr<LatencyHistogram>> histograms;
+};
+
+Registry& GetRegistry()
+{
+    static Registry* registry = new Registry(); // Never destroyed, histograms may still be recorded into from static destructors
+    return *registry;
+}
+
+} // namespace
+
+std::uint64_t LatencyHistogram::Snapshot::GetPercentile(double quantile) const
+{
+    if (count == 0)
+        return 0;
+
+    const std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(std::clamp(quantile, 0.0, 1.0) * static_cast<double>(count)));
+    std::uint64_t seen = 0;
+    for (int i = 0; i < k_BucketsCount; ++i)
+    {
+        seen += buckets[i];
+        if (seen >= rank && seen > 0)
+            return std::min(GetBucketUpperBound(i), max);
+    }
+    return max;
+}
+
+LatencyHistogram::LatencyHistogram(const std::string& name)
+    : m_Name(name)
+    , m_Id(ms_NextId.fetch_add(1, std::memory_order_relaxed))
+{
+    m_Slot = static_cast<int>((m_Id - 1) % k_MaxHistograms);
+}
+
+LatencyHistogram::~LatencyHistogram() = default;
+
+LatencyHistogram::Snapshot LatencyHistogram::GetSnapshot() const
+{
+    Snapshot snapshot;
+    snapshot.buckets.assign(k_BucketsCount, 0);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (const std::unique_ptr<Shard>& shard : m_Shards)
+    {
+        for (int i = 0; i < k_BucketsCount; ++i)
+            snapshot.buckets[i] += shard->buckets[i].load(std::memory_order_relaxed);
+        snapshot.count += shard->count.load(std::memory_order_relaxed);
+        snapshot.sum += shard->sum.load(std::memory_order_relaxed);
+        snapshot.max = std::max(snapshot.max, shard->max.load(std::memory_order_relaxed));
+    }
+    return snapshot;
+}
+
+void LatencyHistogram::Reset()
+{
+    // Samples recorded concurrently with a reset may be partially kept, which is fine for monitoring
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (const std::unique_ptr<Shard>& shard : m_Shards)
+    {
+        for (int i = 0; i < k_BucketsCount; ++i)
+            shard->buckets[i].store(0, std::memory_order_relaxed);
+        shard->count.store(0, std::memory_order_relaxed);
+        shard->sum.store(0, std::memory_order_relaxed);
+        shard->max.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::uint64_t LatencyHistogram::GetBucketUpperBound(int index)
+{
+    if (index < k_SubBuckets)
+        return static_cast<std::uint64_t>(index);
+    const int shift = (index >> k_SubBucketBits) - 1;
+    const std::uint64_t lower = static_cast<std::uint64_t>(k_SubBuckets + (index & (k_SubBuckets - 1))) << shift;
+    return lower + ((std::uint64_t(1) << shift) - 1);
+}
+
+void LatencyHistogram::RegisterThread(ThreadCacheEntry& entry)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Shard*& shard = m_ThreadShards[std::this_thread::get_id()];
+    if (shard == nullptr)
+    {
+        shard = m_Shards.emplace_back(std::make_unique<Shard>()).get();
+    }
+    entry.shard = shard;
+    entry.id = m_Id;
+}
+
+LatencyHistogram& LatencyHistogram::Get(const std::string& name)
+{
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::unique_ptr<LatencyHistogram>& histogram = registry.histograms[name];
+    if (histogram == nullptr)
+    {
+        histogram = std::make_unique<LatencyHistogram>(name);
+    }
+    return *histogram;
+}
+
+std::vector<LatencyHistogram*> LatencyHistogram::GetAll()
+{
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    std::vector<LatencyHistogram*> histograms;
+    histograms.reserve(registry.histograms.size());
+    for (const auto& entry : registry.histograms)
+    {
+        histograms.push_back(entry.second.get());
+    }
+    return histograms;
+}
+
+void LatencyHistogram::WriteText(std::ostream& stream)
+{
+    for (const LatencyHistogram* histogram : GetAll())
+    {
+        const Snapshot snapshot = histogram->GetSnapshot();
+        stream << histogram->GetName() << " count=" << snapshot.count << " mean=" << snapshot.GetMean()
+            << "ns p50=" << snapshot.GetPercentile(0.5) << "ns p99=" << snapshot.GetPercentile(0.99)
+            << "ns p99.9=" << snapshot.GetPercentile(0.999) << "ns max=" << snapshot.max << "ns" << std::endl;
+    }
+}
+
+void LatencyHistogram::WriteJson(std::ostream& stream)
+{
+    const std::vector<LatencyHistogram*> histograms = GetAll();
+    stream << "{\n  \"histograms\": [\n";
+    for (std::size_t i = 0; i < histograms.size(); ++i)
+    {
+        const Snapshot snapshot = histograms[i]->GetSnapshot();
+        stream << "    { \"name\": \"" << histograms[i]->GetName() << "\", \"count\": " << snapshot.count << ", \"meanNs\": " << snapshot.GetMean()
+            << ", \"p50Ns\": " << snapshot.GetPercentile(0.5) << ", \"p99Ns\": " << snapshot.GetPercentile(0.99)
+            << ", \"p999Ns\": " << snapshot.GetPercentile(0.999) << ", \"maxNs\": " << snapshot.max << ", \"buckets\": [";
+
+        // Sparse [upperBoundNs, count] pairs
+        bool first = true;
+        for (int b = 0; b < k_BucketsCount; ++b)
+        {
+            if (snapshot.buckets[b] == 0)
+                continue;
+            stream << (first ? "" : ", ") << "[" << GetBucketUpperBound(b) << ", " << snapshot.buckets[b] << "]";
+            first = false;
+        }
+        stream << "] }" << (i + 1 < histograms.size() ? "," : "") << "\n";
+    }
+    stream << "  ]\n}\n";
+}
+
+} // namespace BrainFramework
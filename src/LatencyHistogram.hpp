@@ -0,0 +1,143 @@
+#pragma once
+
+#include "Utils.hpp"
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+namespace BrainFramework
+{
+
+// Log-bucketed latency histogram in nanoseconds, cheap enough to stay on while training
+// Each thread records into its own buckets without any atomic read-modify-write, buckets are merged on read
+class LatencyHistogram
+{
+public:
+    // 16 linear sub-buckets per power of two, so every bucket is within ~6% of the value it holds
+    static constexpr int k_SubBucketBits = 4;
+    static constexpr int k_SubBuckets = 1 << k_SubBucketBits;
+    static constexpr int k_BucketsCount = (64 - k_SubBucketBits + 1) * k_SubBuckets;
+
+    struct Snapshot
+    {
+        std::vector<std::uint64_t> buckets;
+        std::uint64_t count{ 0 };
+        std::uint64_t sum{ 0 };
+        std::uint64_t max{ 0 };
+
+        // Upper bound of the bucket holding the given quantile, in [0, 1]
+        std::uint64_t GetPercentile(double quantile) const;
+        double GetMean() const { return count > 0 ? static_cast<double>(sum) / static_cast<double>(count) : 0.0; }
+    };
+
+    explicit LatencyHistogram(const std::string& name);
+    ~LatencyHistogram();
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void Record(std::uint64_t ns)
+    {
+        Shard& shard = GetThreadShard();
+        const int index = GetBucketIndex(ns);
+        shard.buckets[index].store(shard.buckets[index].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        shard.count.store(shard.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        shard.sum.store(shard.sum.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+        if (ns > shard.max.load(std::memory_order_relaxed))
+            shard.max.store(ns, std::memory_order_relaxed);
+    }
+
+    Snapshot GetSnapshot() const;
+    void Reset();
+
+    const std::string& GetName() const { return m_Name; }
+
+    static int GetBucketIndex(std::uint64_t value)
+    {
+        if (value < k_SubBuckets)
+            return static_cast<int>(value);
+        const int shift = std::bit_width(value) - 1 - k_SubBucketBits;
+        return ((shift + 1) << k_SubBucketBits) + static_cast<int>((value >> shift) & (k_SubBuckets - 1));
+    }
+    static std::uint64_t GetBucketUpperBound(int index);
+
+    // Histograms live for the whole process and are shared by name
+    static LatencyHistogram& Get(const std::string& name);
+    static std::vector<LatencyHistogram*> GetAll();
+
+    static void SetEnabled(bool enabled) { ms_Enabled.store(enabled, std::memory_order_relaxed); }
+    static bool IsEnabled() { return ms_Enabled.load(std::memory_order_relaxed); }
+
+    // p50 / p99 / p99.9 / max, one histogram per line
+    static void WriteText(std::ostream& stream);
+    static void WriteJson(std::ostream& stream);
+
+private:
+    struct Shard
+    {
+        std::atomic<std::uint64_t> buckets[k_BucketsCount] = {};
+        std::atomic<std::uint64_t> count{ 0 };
+        std::atomic<std::uint64_t> sum{ 0 };
+        std::atomic<std::uint64_t> max{ 0 };
+    };
+
+    static constexpr int k_MaxHistograms = 64;
+
+    // Plain aggregate, thread_local storage is zero initialized
+    struct ThreadCacheEntry
+    {
+        Shard* shard;
+        std::uint64_t id;
+    };
+
+    Shard& GetThreadShard()
+    {
+        ThreadCacheEntry& entry = t_Cache[m_Slot];
+        if (entry.id != m_Id)
+            RegisterThread(entry);
+        return *entry.shard;
+    }
+
+    void RegisterThread(ThreadCacheEntry& entry);
+
+    std::string m_Name;
+    std::vector<std::unique_ptr<Shard>> m_Shards;
+    std::unordered_map<std::thread::id, Shard*> m_ThreadShards;
+    mutable std::mutex m_Mutex;
+    std::uint64_t m_Id;
+    int m_Slot;
+
+    static inline std::atomic<bool> ms_Enabled{ true };
+    static inline std::atomic<std::uint64_t> ms_NextId{ 1 };
+    static inline thread_local ThreadCacheEntry t_Cache[k_MaxHistograms];
+};
+
+// Records the lifetime of the scope, nothing is measured while histograms are disabled or without a histogram
+class LatencyScope
+{
+public:
+    explicit LatencyScope(LatencyHistogram& histogram) : LatencyScope(&histogram) {}
+    explicit LatencyScope(LatencyHistogram* histogram)
+        : m_Histogram(LatencyHistogram::IsEnabled() ? histogram : nullptr)
+    {
+        if (m_Histogram != nullptr)
+            m_Start = std::chrono::steady_clock::now();
+    }
+
+    ~LatencyScope()
+    {
+        if (m_Histogram != nullptr)
+            m_Histogram->Record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_Start).count()));
+    }
+
+    LatencyScope(const LatencyScope&) = delete;
+    LatencyScope& operator=(const LatencyScope&) = delete;
+
+private:
+    LatencyHistogram* m_Histogram;
+    std::chrono::steady_clock::time_point m_Start;
+};
+
+} // namespace BrainFramework
@@ -0,0 +1,197 @@
+#include "MigrationMailbox.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace BrainFramework
+{
+
+MigrationMailbox::~MigrationMailbox()
+{
+    Destroy();
+}
+
+bool MigrationMailbox::Create(int islands, std::size_t slotBytes)
+{
+    Destroy();
+    if (islands <= 0)
+        return false;
+
+    const std::size_t slotWords = (slotBytes + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+    const std::size_t slotStride = (sizeof(SlotHeader) + slotWords * sizeof(std::uint64_t) + alignof(SlotHeader) - 1) / alignof(SlotHeader) * alignof(SlotHeader);
+    const std::size_t memorySize = slotStride * islands;
+
+    // Anonymous and shared, the mapping is inherited by the processes forked afterwards
+#if defined(_WIN32)
+    HANDLE handle = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<std::uint64_t>(memorySize) >> 32), static_cast<DWORD>(memorySize), nullptr);
+    if (handle == nullptr)
+        return false;
+
+    void* memory = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, memorySize);
+    if (memory == nullptr)
+    {
+        CloseHandle(handle);
+        return false;
+    }
+    m_Handle = handle;
+#else
+    void* memory = mmap(nullptr, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+        return false;
+#endif
+
+    m_Memory = memory;
+    m_MemorySize = memorySize;
+    m_SlotStride = slotStride;
+    m_SlotWords = slotWords;
+    m_Islands = islands;
+
+    for (int island = 0; island < islands; ++island)
+    {
+        new (&GetSlot(island)) SlotHeader();
+        std::atomic<std::uint64_t>* words = GetWords(island);
+        for (std::size_t word = 0; word < slotWords; ++word)
+        {
+            new (&words[word]) std::atomic<std::uint64_t>(0);
+        }
+    }
+    return true;
+}
+
+void MigrationMailbox::Destroy()
+{
+    if (m_Memory == nullptr)
+        return;
+
+#if defined(_WIN32)
+    UnmapViewOfFile(m_Memory);
+    CloseHandle(static_cast<HANDLE>(m_Handle));
+#else
+    munmap(m_Memory, m_MemorySize);
+#endif
+
+    m_Memory = nullptr;
+    m_Handle = nullptr;
+    m_MemorySize = 0;
+    m_SlotStride = 0;
+    m_SlotWords = 0;
+    m_Islands = 0;
+}
+
+bool MigrationMailbox::Post(int island, const std::vector<std::uint8_t>& message)
+{
+    const std::size_t words = (message.size() + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+    if (island < 0 || island >= m_Islands || words > m_SlotWords)
+        return false;
+
+    SlotHeader& slot = GetSlot(island);
+    std::atomic<std::uint64_t>* slotWords = GetWords(island);
+
+    // Only the island writes its slot, the odd sequence tells readers the words are changing
+    const std::uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (std::size_t word = 0; word < words; ++word)
+    {
+        std::uint64_t value = 0;
+        const std::size_t offset = word * sizeof(std::uint64_t);
+        std::memcpy(&value, message.data() + offset, std::min(sizeof(std::uint64_t), message.size() - offset));
+        slotWords[word].store(value, std::memory_order_relaxed);
+    }
+    slot.size.store(message.size(), std::memory_order_relaxed);
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    return true;
+}
+
+bool MigrationMailbox::Receive(int island, std::uint64_t& lastSequence, std::vector<std::uint8_t>& message) const
+{
+    if (island < 0 || island >= m_Islands)
+        return false;
+
+    const SlotHeader& slot = GetSlot(island);
+    const std::atomic<std::uint64_t>* slotWords = GetWords(island);
+
+    for (int attempt = 0; attempt < k_ReadAttempts; ++attempt)
+    {
+        const std::uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence == lastSequence)
+            return false;
+
+        if ((sequence & 1) != 0)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        const std::size_t size = static_cast<std::size_t>(slot.size.load(std::memory_order_relaxed));
+        if (size > m_SlotWords * sizeof(std::uint64_t))
+            continue;
+
+        message.resize(size);
+        for (std::size_t offset = 0; offset < size; offset += sizeof(std::uint64_t))
+        {
+            const std::uint64_t value = slotWords[offset / sizeof(std::uint64_t)].load(std::memory_order_relaxed);
+            std::memcpy(message.data() + offset, &value, std::min(sizeof(std::uint64_t), size - offset));
+        }
+
+        // The copy is whole only if the island didn't start another message meanwhile
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+        {
+            lastSequence = sequence;
+            return true;
+        }
+    }
+    return false;
+}
+
+void MigrationMailbox::GetSources(MigrationTopology topology, int island, int islands, std::uint64_t migrationSeed, std::vector<int>& sources)
+{
+    sources.clear();
+    if (islands <= 1)
+        return;
+
+    switch (topology)
+    {
+    case MigrationTopology::Ring:
+        sources.push_back((island + islands - 1) % islands);
+        break;
+    case MigrationTopology::Full:
+        for (int source = 0; source < islands; ++source)
+        {
+            if (source != island)
+                sources.push_back(source);
+        }
+        break;
+    case MigrationTopology::Random:
+    {
+        const int offset = 1 + static_cast<int>(DeriveSeed(migrationSeed, static_cast<std::uint64_t>(island)) % static_cast<std::uint64_t>(islands - 1));
+        sources.push_back((island + offset) % islands);
+        break;
+    }
+    }
+}
+
+MigrationMailbox::SlotHeader& MigrationMailbox::GetSlot(int island) const
+{
+    return *reinterpret_cast<SlotHeader*>(static_cast<std::uint8_t*>(m_Memory) + m_SlotStride * island);
+}
+
+std::atomic<std::uint64_t>* MigrationMailbox::GetWords(int island) const
+{
+    return reinterpret_cast<std::atomic<std::uint64_t>*>(reinterpret_cast<std::uint8_t*>(&GetSlot(island)) + sizeof(SlotHeader));
+}
+
+} // namespace BrainFramework
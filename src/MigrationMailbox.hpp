@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Random.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace BrainFramework
+{
+
+enum class MigrationTopology
+{
+    Ring, // Island i receives from island i - 1
+    Full, // Every island receives from all the others
+    Random, // Every island receives from one other, drawn again at each migration
+};
+
+// Latest emigrants of every island of an island model, in memory shared with the processes forked after Create
+// Each island posts to its own slot and reads the slots of its sources whenever it migrates, no island ever waits for another
+// A slot is a seqlock over atomic words: a reader that raced the writer copies again, and skips a slot rewritten too often
+class MigrationMailbox
+{
+public:
+    MigrationMailbox() = default;
+    ~MigrationMailbox();
+    MigrationMailbox(const MigrationMailbox&) = delete;
+    MigrationMailbox& operator=(const MigrationMailbox&) = delete;
+
+    // Messages of up to slotBytes bytes
+    bool Create(int islands, std::size_t slotBytes);
+    void Destroy();
+
+    // Replaces the last message of the island, false when the message doesn't fit its slot
+    bool Post(int island, const std::vector<std::uint8_t>& message);
+
+    // Copies the last message of the island if it's not the one last read, false when there is nothing new
+    // lastSequence starts at 0 and is kept by the caller between receives
+    bool Receive(int island, std::uint64_t& lastSequence, std::vector<std::uint8_t>& message) const;
+
+    int GetIslandsCount() const { return m_Islands; }
+    std::size_t GetSlotBytes() const { return m_SlotWords * sizeof(std::uint64_t); }
+
+    // Islands the island receives from, the seed draws the random topology of one migration
+    static void GetSources(MigrationTopology topology, int island, int islands, std::uint64_t migrationSeed, std::vector<int>& sources);
+
+private:
+    // Lock free atomics work the same in memory mapped by several processes
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+
+    struct alignas(64) SlotHeader
+    {
+        std::atomic<std::uint64_t> sequence{ 0 }; // Odd while the island writes its message
+        std::atomic<std::uint64_t> size{ 0 };
+    };
+
+    SlotHeader& GetSlot(int island) const;
+    std::atomic<std::uint64_t>* GetWords(int island) const;
+
+    static constexpr int k_ReadAttempts = 16;
+
+    void* m_Memory{ nullptr };
+    void* m_Handle{ nullptr };
+    std::size_t m_MemorySize{ 0 };
+    std::size_t m_SlotStride{ 0 };
+    std::size_t m_SlotWords{ 0 };
+    int m_Islands{ 0 };
+};
+
+} // namespace BrainFramework
@@ -2,21 +2,147 @@
 
 #include "Simulation.hpp"
 #include "NeuralNetwork.hpp"
+#include "ByteStream.hpp"
+#include "Hash.hpp"
+
+#include <array>
 
 namespace BrainFramework
 {
 
+// Names a genome after its encoding, 0 stands for no genome
+inline std::uint64_t MakeGenomeKey(const std::vector<std::uint8_t>& bytes)
+{
+    const std::uint64_t key = HashBytes(bytes).low;
+    return key != 0 ? key : 1;
+}
+
+// What a job ships of its genome to a worker process, which rebuilds it from the bytes or breeds it again from its parents
+struct GenomeDescription
+{
+    std::uint64_t key{ 0 }; // RemoteGenome::GetKey of the genome the bytes rebuild
+    ByteWriter bytes; // Only written when asked for, or when the model needs them for the key anyway
+    std::array<std::uint64_t, 2> parentKeys{ 0, 0 }; // Left at 0 when the genome wasn't bred, the second one when it had a single parent
+    std::uint64_t breedSeed{ 0 };
+};
+
+// A genome a worker process rebuilt, shared by all the jobs playing it
+class RemoteGenome
+{
+public:
+    virtual ~RemoteGenome() = default;
+
+    // A new network at every call, jobs playing the same genome run concurrently
+    virtual bool MakeNeuralNetwork(std::shared_ptr<NeuralNetwork>& neuralNetwork) const = 0;
+    // The key the coordinator named the genome with, a genome rebuilt to another one is not kept
+    virtual std::uint64_t GetKey() const = 0;
+};
+
+// The usual RemoteGenome, a genome of the model with its own network type
+template <typename TGenome, typename TNeuralNetwork>
+class RemoteGenomeOf : public RemoteGenome
+{
+public:
+    bool MakeNeuralNetwork(std::shared_ptr<NeuralNetwork>& neuralNetwork) const override
+    {
+        std::shared_ptr<TNeuralNetwork> network = std::make_shared<TNeuralNetwork>();
+        if (!genome.MakeNeuralNetwork(*network))
+            return false;
+
+        neuralNetwork = std::move(network);
+        return true;
+    }
+
+    std::uint64_t GetKey() const override { return genome.GetKey(); }
+
+    TGenome genome;
+};
+
+// One genome to evaluate over a few episodes, filled by the model and run by a BatchEvaluator on any thread
+struct EvaluationJob
+{
+    // Hands out the genome network, called on the thread running the job
+    std::function<bool(std::shared_ptr<NeuralNetwork>&)> makeNeuralNetwork;
+    // Fills the description of the genome for a worker process, the bytes only when writeBytes is set
+    // Called on the thread handing out the jobs, set by models supporting remote evaluation
+    std::function<void(GenomeDescription& description, bool writeBytes)> describeGenome;
+    std::vector<std::uint64_t> evaluationSeeds; // One per episode
+    std::vector<float> results; // One per episode, in the same order
+    int slot{ -1 }; // Set by AcquireJob, the genome CompleteJob scores
+    std::uint64_t key{ 0 }; // Set by AcquireJob, tells CompleteJob whether the slot still holds the same genome
+};
+
 class Model
 {
 public:
+    virtual ~Model() = default;
+
     virtual const char* GetName() const = 0;
+
+    // Drawn by the UI thread while another thread trains, it only reads the stats the model last published
+    // Settings changed there are requested, and take effect at the next ApplySettings
     virtual void DisplayImGui() {};
+    // Called by the training thread between training steps, while no job is running
+    virtual void ApplySettings() {}
 
-    virtual bool PrepareTraining(const ISimulation& simulation) { return true; }
-    virtual bool StartEvaluation(std::unique_ptr<NeuralNetwork>& neuralNetwork) = 0;
+    virtual bool PrepareTraining(const ISimulation& /*simulation*/) { return true; }
+    // The network may be shared with the model, which keeps it across the evaluations of a genome
+    virtual bool StartEvaluation(std::shared_ptr<NeuralNetwork>& neuralNetwork) = 0;
     virtual bool EndEvalutation(float result) = 0;
 
-    virtual bool MakeBestNeuralNetwork(std::unique_ptr<NeuralNetwork>& neuralNetwork, int index = 0) = 0;
+    virtual bool MakeBestNeuralNetwork(std::shared_ptr<NeuralNetwork>& neuralNetwork, int index = 0) = 0;
+
+    // Batch API: the rest of the current generation, or of its current evaluation round, is handed out at once
+    // Its jobs can run concurrently
+    // Jobs keep pointers into the population, nothing may change the model until EndBatch
+    virtual bool SupportsBatch() const { return false; }
+    virtual bool PrepareBatch(std::vector<EvaluationJob>& /*jobs*/) { return false; }
+
+    // Results are consumed in job and episode order, the same order StartEvaluation would have used
+    virtual bool EndBatch(const std::vector<EvaluationJob>& jobs)
+    {
+        for (const EvaluationJob& job : jobs)
+        {
+            for (float result : job.results)
+            {
+                if (!EndEvalutation(result))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // Async API: jobs are acquired and completed one at a time, from any thread and in any order
+    // Completing a job may replace genomes or start the next generation right away, no worker waits for the slowest job
+    virtual bool SupportsAsync() const { return false; }
+    // False when no genome is free to evaluate
+    virtual bool AcquireJob(EvaluationJob& /*job*/) { return false; }
+    virtual bool CompleteJob(EvaluationJob& /*job*/) { return false; }
+
+    // Island API: between training steps, the best genomes leave for the other populations and arrivals take the place of the worst
+    // Arrivals are scored from scratch, and change the genomes the current generation or evaluation round walks
+    virtual bool SupportsMigration() const { return false; }
+    virtual void WriteMigrants(int /*count*/, ByteWriter& /*writer*/) const {}
+    // Returns how many genomes arrived, a message from a different simulation or a damaged one brings none
+    virtual int ReadMigrants(ByteReader& /*reader*/) { return 0; }
+
+    // Remote API, on the worker side: a model of the same kind, never trained, rebuilds the genomes jobs describe
+    // Null when the bytes are damaged
+    virtual std::shared_ptr<RemoteGenome> ReadRemoteGenome(ByteReader& /*reader*/) const { return nullptr; }
+    // Breeds again a genome described by its parents and seed, both parents came from this model
+    // Null when the model can't, the coordinator then sends the bytes
+    virtual std::shared_ptr<RemoteGenome> BreedRemoteGenome(const RemoteGenome& /*parent1*/, const RemoteGenome* /*parent2*/, std::uint64_t /*seed*/) const { return nullptr; }
+
+    // Root of the model seed tree, every generation, genome and episode seed derives from it
+    void SetSeed(std::uint64_t seed) { m_Seed = seed; }
+    std::uint64_t GetSeed() const { return m_Seed; }
+    std::uint64_t GetGenerationSeed(int generation) const { return DeriveSeed(m_Seed, static_cast<std::uint64_t>(generation)); }
+
+    // Seed of the evaluation StartEvaluation is about to run, the simulation episode is drawn from it
+    virtual std::uint64_t GetEvaluationSeed() const { return m_Seed; }
+
+protected:
+    std::uint64_t m_Seed{ 0 };
 };
 
 } // namespace BrainFramework
\ No newline at end of file
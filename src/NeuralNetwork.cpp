@@ -1,6 +1,10 @@
 #include "NeuralNetwork.hpp"
 
 #include "Utils.hpp"
+#include "TaskScheduler.hpp"
+#include "KernelTuner.hpp"
+#include "LatencyHistogram.hpp"
+#include "PerfCounters.hpp"
 
 namespace BrainFramework
 {
@@ -106,6 +110,9 @@ bool BasicNeuralNetwork::Make(int inputs, int outputs, std::vector<Neuron>&& neu
 
 bool BasicNeuralNetwork::Evaluate(const std::vector<float>& inputs, std::vector<float>& outputs)
 {
+    static LatencyHistogram& s_Latency = LatencyHistogram::Get("BasicNeuralNetwork::Evaluate");
+    LatencyScope latencyScope(s_Latency);
+
     if (inputs.size() != m_Inputs || outputs.size() != m_Outputs)
     {
         return false;
@@ -147,6 +154,90 @@ bool BasicNeuralNetwork::Evaluate(const std::vector<float>& inputs, std::vector<
     return true;
 }
 
+bool BasicNeuralNetwork::EvaluateBatch(std::span<const float> inputs, std::span<float> outputs, int lanes)
+{
+    if (lanes <= 0 || inputs.size() != static_cast<std::size_t>(lanes) * m_Inputs || outputs.size() != static_cast<std::size_t>(lanes) * m_Outputs)
+    {
+        return false;
+    }
+
+    const int size = static_cast<int>(m_Neurons.size());
+    const int outputsStart = size - m_Outputs;
+
+    if (m_BatchLanes != lanes)
+    {
+        m_BatchValues.assign(static_cast<std::size_t>(size) * lanes, 0.0f);
+        m_BatchSums.resize(lanes);
+        m_BatchLanes = lanes;
+    }
+
+    // Fill inputs
+    for (int i = 0; i < m_Inputs; ++i)
+    {
+        float* values = m_BatchValues.data() + static_cast<std::size_t>(i) * lanes;
+        for (int lane = 0; lane < lanes; ++lane)
+        {
+            values[lane] = inputs[lane * m_Inputs + i];
+        }
+    }
+
+    // Propagate, sums are kept apart so a link to the neuron itself still reads its previous value
+    // Output neurons keep their values untouched, as Evaluate does
+    float* sums = m_BatchSums.data();
+    for (int i = m_Inputs; i < size; ++i)
+    {
+        std::fill(sums, sums + lanes, 0.0f);
+        for (const Link& link : m_Neurons[i].links)
+        {
+            const float weight = link.weight;
+            const float* values = m_BatchValues.data() + static_cast<std::size_t>(link.neuronIndex) * lanes;
+            for (int lane = 0; lane < lanes; ++lane)
+            {
+                sums[lane] += weight * values[lane];
+            }
+        }
+
+        if (i < outputsStart)
+        {
+            float* values = m_BatchValues.data() + static_cast<std::size_t>(i) * lanes;
+            for (int lane = 0; lane < lanes; ++lane)
+            {
+                values[lane] = Sigmoid(sums[lane]);
+            }
+        }
+        else
+        {
+            for (int lane = 0; lane < lanes; ++lane)
+            {
+                outputs[lane * m_Outputs + i - outputsStart] = Sigmoid(sums[lane]);
+            }
+        }
+    }
+
+    return true;
+}
+
+void BasicNeuralNetwork::ResetState()
+{
+    for (Neuron& neuron : m_Neurons)
+    {
+        neuron.value = 0.0f;
+    }
+    std::fill(m_BatchValues.begin(), m_BatchValues.end(), 0.0f);
+}
+
+void BasicNeuralNetwork::ResetBatchState(int lane)
+{
+    if (lane < 0 || lane >= m_BatchLanes)
+        return;
+
+    const int size = static_cast<int>(m_Neurons.size());
+    for (int i = 0; i < size; ++i)
+    {
+        m_BatchValues[static_cast<std::size_t>(i) * m_BatchLanes + lane] = 0.0f;
+    }
+}
+
 LayeredNeuralNetwork::ValidateResult LayeredNeuralNetwork::Validate(const std::vector<int>& layerSizes, const std::vector<float>& weights)
 {
     // Format
@@ -173,6 +264,17 @@ bool LayeredNeuralNetwork::Make(const std::vector<int>& layerSizes, const std::v
         m_LayerSizes = layerSizes;
         m_Weights = weights;
         m_Values.resize(GetNeuronsCount());
+
+        const int layers = static_cast<int>(m_LayerSizes.size());
+        m_WeightOffsets.assign(layers, 0);
+        m_ValueOffsets.assign(layers, 0);
+        for (int layer = 1; layer < layers; ++layer)
+        {
+            m_WeightOffsets[layer] = m_WeightOffsets[layer - 1] + (layer > 1 ? m_LayerSizes[layer - 1] * m_LayerSizes[layer - 2] : 0);
+            m_ValueOffsets[layer] = m_ValueOffsets[layer - 1] + m_LayerSizes[layer - 1];
+        }
+
+        m_MaxWorkers = (ms_KernelTuner != nullptr) ? ms_KernelTuner->Select(m_LayerSizes) : 0;
         return true;
     }
     return false;
@@ -180,54 +282,147 @@ bool LayeredNeuralNetwork::Make(const std::vector<int>& layerSizes, const std::v
 
 bool LayeredNeuralNetwork::Evaluate(const std::vector<float>& inputs, std::vector<float>& outputs)
 {
+    static LatencyHistogram& s_Latency = LatencyHistogram::Get("LayeredNeuralNetwork::Evaluate");
+    LatencyScope latencyScope(s_Latency);
+    SampledPerfScope<k_EvaluateSampling> perfScope("LayeredNeuralNetwork::Evaluate");
+
     if (inputs.size() != GetInputsCount() || outputs.size() != GetOutputsCount())
     {
         return false;
     }
 
     // Fill inputs
-    int i = 0;
-    for (; i < m_LayerSizes[0]; ++i)
+    for (int i = 0; i < m_LayerSizes[0]; ++i)
     {
         m_Values[i] = inputs[i];
     }
 
-    // Propagate
-    int previousLayerWeightBeginIndex = 0;
-    int previousLayerValueBeginIndex = 0;
-    const int intermediateLayers = static_cast<int>(m_LayerSizes.size() - 1);
-    for (int layer = 1; layer < intermediateLayers; ++layer)
+    // The last layer is written straight into the outputs
+    const int layers = static_cast<int>(m_LayerSizes.size());
+    auto getDestination = [&](int layer)
+    {
+        return layer == layers - 1 ? outputs.data() : m_Values.data() + m_ValueOffsets[layer];
+    };
+
+    // Propagate, wide layers are split in row ranges across the scheduler, one layer after the other
+    if (ms_TaskScheduler != nullptr && m_MaxWorkers != 1)
+    {
+        const int maxWorkers = m_MaxWorkers > 0 ? std::min(m_MaxWorkers, ms_TaskScheduler->GetWorkersCount()) : ms_TaskScheduler->GetWorkersCount();
+        for (int layer = 1; layer < layers; ++layer)
+        {
+            const int rows = m_LayerSizes[layer];
+            const int layerWorkers = GetLayerWorkersCount(layer, maxWorkers);
+            float* destination = getDestination(layer);
+            ms_TaskScheduler->ParallelFor(0, rows, (rows + layerWorkers - 1) / layerWorkers, [&](int rowBegin, int rowEnd)
+            {
+                EvaluateRows(layer, rowBegin, rowEnd, destination);
+            });
+        }
+
+        return true;
+    }
+
+    for (int layer = 1; layer < layers; ++layer)
+    {
+        EvaluateRows(layer, 0, m_LayerSizes[layer], getDestination(layer));
+    }
+
+    return true;
+}
+
+bool LayeredNeuralNetwork::EvaluateBatch(std::span<const float> inputs, std::span<float> outputs, int lanes)
+{
+    const int inputsCount = GetInputsCount();
+    const int outputsCount = GetOutputsCount();
+    if (lanes <= 0 || inputs.size() != static_cast<std::size_t>(lanes) * inputsCount || outputs.size() != static_cast<std::size_t>(lanes) * outputsCount)
+    {
+        return false;
+    }
+
+    m_BatchValues.resize(static_cast<std::size_t>(GetNeuronsCount()) * lanes);
+
+    // Fill inputs
+    for (int i = 0; i < inputsCount; ++i)
     {
-        for (int iOnLayer = 0; iOnLayer < m_LayerSizes[layer]; ++iOnLayer, ++i)
+        float* values = m_BatchValues.data() + static_cast<std::size_t>(i) * lanes;
+        for (int lane = 0; lane < lanes; ++lane)
+        {
+            values[lane] = inputs[lane * inputsCount + i];
+        }
+    }
+
+    // Propagate, each weight is loaded once for every lane
+    const int layers = static_cast<int>(m_LayerSizes.size());
+    for (int layer = 1; layer < layers; ++layer)
+    {
+        const int previousLayerSize = m_LayerSizes[layer - 1];
+        const float* weights = m_Weights.data() + m_WeightOffsets[layer];
+        const float* previousValues = m_BatchValues.data() + static_cast<std::size_t>(m_ValueOffsets[layer - 1]) * lanes;
+        float* layerValues = m_BatchValues.data() + static_cast<std::size_t>(m_ValueOffsets[layer]) * lanes;
+
+        for (int iOnLayer = 0; iOnLayer < m_LayerSizes[layer]; ++iOnLayer)
         {
-            float sum = 0.0f;
-            for (int iOnPreviousLayer = 0; iOnPreviousLayer < m_LayerSizes[layer - 1]; ++iOnPreviousLayer)
+            float* sums = layerValues + static_cast<std::size_t>(iOnLayer) * lanes;
+            std::fill(sums, sums + lanes, 0.0f);
+            for (int iOnPreviousLayer = 0; iOnPreviousLayer < previousLayerSize; ++iOnPreviousLayer)
             {
-                const int weightIndex = previousLayerWeightBeginIndex + iOnPreviousLayer + iOnLayer * iOnPreviousLayer;
-                const int valueIndex = previousLayerValueBeginIndex + iOnPreviousLayer;
-                sum += m_Weights[weightIndex] * m_Values[valueIndex];
+                const float weight = weights[iOnPreviousLayer + iOnLayer * iOnPreviousLayer];
+                const float* values = previousValues + static_cast<std::size_t>(iOnPreviousLayer) * lanes;
+                for (int lane = 0; lane < lanes; ++lane)
+                {
+                    sums[lane] += weight * values[lane];
+                }
+            }
+            for (int lane = 0; lane < lanes; ++lane)
+            {
+                sums[lane] = Sigmoid(sums[lane]);
             }
-            m_Values[i] = Sigmoid(sum);
         }
-        previousLayerWeightBeginIndex += m_LayerSizes[layer] * m_LayerSizes[layer - 1];
-        previousLayerValueBeginIndex += m_LayerSizes[layer - 1];
     }
 
     // Read outputs
-    const int previousLayerIndex = static_cast<int>(m_LayerSizes.size() - 2);
-    for (int iOnLayer = 0; iOnLayer < m_LayerSizes.back(); ++iOnLayer, ++i)
+    const float* outputValues = m_BatchValues.data() + static_cast<std::size_t>(m_ValueOffsets[layers - 1]) * lanes;
+    for (int i = 0; i < outputsCount; ++i)
     {
-        float sum = 0.0f;
-        for (int iOnPreviousLayer = 0; iOnPreviousLayer < m_LayerSizes[previousLayerIndex]; ++iOnPreviousLayer)
+        for (int lane = 0; lane < lanes; ++lane)
         {
-            const int weightIndex = previousLayerWeightBeginIndex + iOnPreviousLayer + iOnLayer * iOnPreviousLayer;
-            const int valueIndex = previousLayerValueBeginIndex + iOnPreviousLayer;
-            sum += m_Weights[weightIndex] * m_Values[valueIndex];
+            outputs[lane * outputsCount + i] = outputValues[static_cast<std::size_t>(i) * lanes + lane];
         }
-        outputs[iOnLayer] = Sigmoid(sum);
     }
 
     return true;
 }
 
+void LayeredNeuralNetwork::EvaluateRows(int layer, int rowBegin, int rowEnd, float* destination)
+{
+    const int previousLayerSize = m_LayerSizes[layer - 1];
+    const float* weights = m_Weights.data() + m_WeightOffsets[layer];
+    const float* values = m_Values.data() + m_ValueOffsets[layer - 1];
+
+    for (int iOnLayer = rowBegin; iOnLayer < rowEnd; ++iOnLayer)
+    {
+        float sum = 0.0f;
+        for (int iOnPreviousLayer = 0; iOnPreviousLayer < previousLayerSize; ++iOnPreviousLayer)
+        {
+            sum += weights[iOnPreviousLayer + iOnLayer * iOnPreviousLayer] * values[iOnPreviousLayer];
+        }
+        destination[iOnLayer] = Sigmoid(sum);
+    }
+}
+
+int LayeredNeuralNetwork::GetLayerWorkersCount(int layer, int maxWorkers) const
+{
+    const int rows = m_LayerSizes[layer];
+    const int links = m_LayerSizes[layer - 1] * rows;
+
+    // Enough links per worker to pay for the dispatch, and enough workers for each weights slice to fit in L2
+    const std::size_t layerBytes = static_cast<std::size_t>(links) * sizeof(float);
+    const int costWorkers = links / k_MinParallelLinksPerWorker;
+    if (costWorkers <= 1)
+        return 1;
+    const int cacheWorkers = static_cast<int>((layerBytes + TaskScheduler::GetL2CacheSize() - 1) / TaskScheduler::GetL2CacheSize());
+
+    return std::clamp(std::max(costWorkers, cacheWorkers), 1, std::min(maxWorkers, rows));
+}
+
 } // namespace BrainFramework
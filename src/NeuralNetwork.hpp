@@ -9,10 +9,20 @@ class NeuralNetwork
 {
 public:
     NeuralNetwork() = default;
+    virtual ~NeuralNetwork() = default;
     NeuralNetwork(const NeuralNetwork&) = delete;
     NeuralNetwork& operator=(const NeuralNetwork&) = delete;
 
     virtual bool Evaluate(const std::vector<float>& inputs, std::vector<float>& outputs) = 0;
+
+    // Evaluates lanes independent inputs at once, inputs and outputs hold one row per lane
+    // Each lane keeps its own state from one call to the next, as long as the amount of lanes doesn't change
+    virtual bool EvaluateBatch(std::span<const float> inputs, std::span<float> outputs, int lanes) = 0;
+
+    // Recurrent links read the values of the previous evaluation, an episode starts from cleared values
+    virtual void ResetState() {}
+    virtual void ResetBatchState(int /*lane*/) {}
+
     virtual int GetInputsCount() = 0;
     virtual int GetOutputsCount() = 0;
     virtual int GetNeuronsCount() = 0;
@@ -58,6 +68,10 @@ public:
     bool Make(int inputs, int outputs, std::vector<Neuron>&& neurons);
 
     bool Evaluate(const std::vector<float>& inputs, std::vector<float>& outputs) override;
+    bool EvaluateBatch(std::span<const float> inputs, std::span<float> outputs, int lanes) override;
+
+    void ResetState() override;
+    void ResetBatchState(int lane) override;
 
     int GetInputsCount() override { return m_Inputs; }
     int GetOutputsCount() override { return m_Outputs; }
@@ -84,8 +98,16 @@ private:
     std::vector<Neuron> m_Neurons;
     int m_Inputs{ 0 };
     int m_Outputs{ 0 };
+
+    // Neuron after neuron, one value per lane, so the inner loops run over contiguous lanes
+    std::vector<float> m_BatchValues;
+    std::vector<float> m_BatchSums;
+    int m_BatchLanes{ 0 };
 };
 
+class TaskScheduler;
+class KernelTuner;
+
 class LayeredNeuralNetwork : public NeuralNetwork
 {
 public:
@@ -105,6 +127,27 @@ public:
 
     bool Evaluate(const std::vector<float>& inputs, std::vector<float>& outputs) override;
 
+    // Lanes are evaluated together row by row, the scheduler is left to whoever runs the batches
+    bool EvaluateBatch(std::span<const float> inputs, std::span<float> outputs, int lanes) override;
+
+    // Shared by every layered network: wide layers get their rows split across the scheduler workers
+    static void SetTaskScheduler(TaskScheduler* taskScheduler) { ms_TaskScheduler = taskScheduler; }
+    static TaskScheduler* GetTaskScheduler() { return ms_TaskScheduler; }
+
+    // When set, Make asks the tuner which kernel fits the network shape best on this host
+    static void SetKernelTuner(KernelTuner* kernelTuner) { ms_KernelTuner = kernelTuner; }
+    static KernelTuner* GetKernelTuner() { return ms_KernelTuner; }
+
+    // 1 forces the serial kernel, 0 leaves the amount of workers to the cost model
+    void SetMaxWorkers(int maxWorkers) { m_MaxWorkers = maxWorkers; }
+    int GetMaxWorkers() const { return m_MaxWorkers; }
+
+    // Below this amount of links per worker, handing out the rows costs more than the work it splits
+    static constexpr int k_MinParallelLinksPerWorker = 16 * 1024;
+
+    // One evaluation in this many is profiled, reading the counters twice costs more than evaluating a small network
+    static constexpr std::uint32_t k_EvaluateSampling = 64;
+
     int GetInputsCount() override { return m_LayerSizes[0]; }
     int GetOutputsCount() override { return m_LayerSizes.back(); }
     int GetNeuronsCount() override 
@@ -290,9 +333,19 @@ public:
     }
 
 private:
+    void EvaluateRows(int layer, int rowBegin, int rowEnd, float* destination);
+    int GetLayerWorkersCount(int layer, int maxWorkers) const;
+
     std::vector<float> m_Values;
+    std::vector<float> m_BatchValues; // Neuron after neuron, one value per lane
     std::vector<int> m_LayerSizes;
     std::vector<float> m_Weights;
+    std::vector<int> m_WeightOffsets;
+    std::vector<int> m_ValueOffsets;
+    int m_MaxWorkers{ 0 };
+
+    static inline TaskScheduler* ms_TaskScheduler = nullptr;
+    static inline KernelTuner* ms_KernelTuner = nullptr;
 };
 
 } // namespace BrainFramework
@@ -0,0 +1,263 @@
+#include "PerfCounters.hpp"
+
+#include <chrono>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace BrainFramework
+{
+
+namespace
+{
+
+std::uint64_t GetTimeNs()
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+#if defined(__linux__)
+int OpenCounter(std::uint32_t type, std::uint64_t config, int groupFd)
+{
+    perf_event_attr attributes;
+    std::memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = type;
+    attributes.config = config;
+    attributes.disabled = groupFd < 0 ? 1 : 0;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    // This thread only, on any CPU
+    return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, groupFd, 0));
+}
+#endif
+
+} // namespace
+
+PerfCounters::PerfCounters()
+{
+    m_Fds.fill(-1);
+    m_Indices.fill(-1);
+
+#if defined(__linux__)
+    struct Event
+    {
+        std::uint32_t type;
+        std::uint64_t config;
+    };
+    const std::array<Event, COUNT> events = { {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    } };
+
+    // The first counter the kernel accepts leads the group so all of them are read with a single syscall
+    for (int i = 0; i < COUNT; ++i)
+    {
+        const int fd = OpenCounter(events[i].type, events[i].config, m_GroupFd);
+        if (fd < 0)
+            continue;
+
+        if (m_GroupFd < 0)
+            m_GroupFd = fd;
+        m_Fds[i] = fd;
+        m_Indices[i] = m_OpenedCount++;
+    }
+
+    if (m_GroupFd >= 0)
+    {
+        ioctl(m_GroupFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(m_GroupFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+}
+
+PerfCounters::~PerfCounters()
+{
+#if defined(__linux__)
+    for (int fd : m_Fds)
+    {
+        if (fd >= 0)
+            close(fd);
+    }
+#endif
+}
+
+PerfCounters::Sample PerfCounters::Read() const
+{
+    Sample sample;
+#if defined(__linux__)
+    if (m_GroupFd >= 0)
+    {
+        // { nr, time_enabled, time_running, values[nr] }, the group is scheduled as a whole so both times hold for every counter
+        std::array<std::uint64_t, COUNT + 3> buffer{};
+        if (read(m_GroupFd, buffer.data(), sizeof(buffer)) > 0)
+        {
+            sample.countersEnabledNs = buffer[1];
+            sample.countersRunningNs = buffer[2];
+            for (int i = 0; i < COUNT; ++i)
+            {
+                if (m_Indices[i] >= 0 && static_cast<std::uint64_t>(m_Indices[i]) < buffer[0])
+                    sample.counters[i] = buffer[3 + m_Indices[i]];
+            }
+        }
+    }
+#endif
+    sample.timeNs = GetTimeNs();
+    return sample;
+}
+
+const char* PerfCounters::GetCounterName(Counter counter)
+{
+    switch (counter)
+    {
+    case Cycles: return "cycles";
+    case Instructions: return "instructions";
+    case L1DMisses: return "l1dMisses";
+    case LLCMisses: return "llcMisses";
+    case BranchMisses: return "branchMisses";
+    default: return "unknown";
+    }
+}
+
+PerfCounters& PerfCounters::GetThreadCounters()
+{
+    thread_local PerfCounters counters;
+    return counters;
+}
+
+PerfProfiler::Shard& PerfProfiler::GetThreadShard()
+{
+    // Only one profiler is active at a time, a single entry is enough
+    struct ThreadCache
+    {
+        Shard* shard{ nullptr };
+        std::uint64_t id{ 0 };
+    };
+    thread_local ThreadCache t_Cache;
+
+    if (t_Cache.id != m_Id)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        t_Cache.shard = m_Shards.emplace_back(std::make_unique<Shard>()).get();
+        t_Cache.id = m_Id;
+    }
+    return *t_Cache.shard;
+}
+
+void PerfProfiler::Add(const char* phase, const PerfCounters::Sample& start, const PerfCounters::Sample& end, std::uint64_t weight)
+{
+    Shard& shard = GetThreadShard();
+
+    // A handful of phases per thread, a linear scan on the name address beats hashing it
+    Slot* slot = nullptr;
+    for (int i = 0; i < shard.slotsCount; ++i)
+    {
+        if (shard.slots[i].phase.load(std::memory_order_relaxed) == phase)
+        {
+            slot = &shard.slots[i];
+            break;
+        }
+    }
+    if (slot == nullptr)
+    {
+        if (shard.slotsCount == k_MaxPhases)
+            return;
+
+        slot = &shard.slots[shard.slotsCount++];
+        slot->phase.store(phase, std::memory_order_release);
+    }
+
+    // Multiplexed counters are scaled over the phase to the time they missed, counters that never ran in it count nothing
+    const std::uint64_t enabledNs = end.countersEnabledNs - start.countersEnabledNs;
+    const std::uint64_t runningNs = end.countersRunningNs - start.countersRunningNs;
+    const double scale = static_cast<double>(weight) * (runningNs < enabledNs ? (runningNs > 0 ? static_cast<double>(enabledNs) / runningNs : 0.0) : 1.0);
+    for (int i = 0; i < PerfCounters::COUNT; ++i)
+        slot->counters[i].store(slot->counters[i].load(std::memory_order_relaxed) + static_cast<std::uint64_t>((end.counters[i] - start.counters[i]) * scale), std::memory_order_relaxed);
+    slot->timeNs.store(slot->timeNs.load(std::memory_order_relaxed) + (end.timeNs - start.timeNs) * weight, std::memory_order_relaxed);
+    slot->calls.store(slot->calls.load(std::memory_order_relaxed) + weight, std::memory_order_relaxed);
+    slot->countersEnabledNs.store(slot->countersEnabledNs.load(std::memory_order_relaxed) + enabledNs * weight, std::memory_order_relaxed);
+    slot->countersRunningNs.store(slot->countersRunningNs.load(std::memory_order_relaxed) + runningNs * weight, std::memory_order_relaxed);
+}
+
+void PerfProfiler::Reset()
+{
+    // Phases added concurrently with a reset may be partially kept, which is fine for profiling
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (const std::unique_ptr<Shard>& shard : m_Shards)
+    {
+        for (Slot& slot : shard->slots)
+        {
+            for (std::atomic<std::uint64_t>& counter : slot.counters)
+                counter.store(0, std::memory_order_relaxed);
+            slot.timeNs.store(0, std::memory_order_relaxed);
+            slot.calls.store(0, std::memory_order_relaxed);
+            slot.countersEnabledNs.store(0, std::memory_order_relaxed);
+            slot.countersRunningNs.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+std::map<std::string, PerfProfiler::Phase> PerfProfiler::GetPhases() const
+{
+    std::map<std::string, Phase> phases;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (const std::unique_ptr<Shard>& shard : m_Shards)
+    {
+        for (const Slot& slot : shard->slots)
+        {
+            const char* name = slot.phase.load(std::memory_order_acquire);
+            if (name == nullptr)
+                break;
+
+            const std::uint64_t calls = slot.calls.load(std::memory_order_relaxed);
+            if (calls == 0)
+                continue;
+
+            Phase& phase = phases[name];
+            for (int i = 0; i < PerfCounters::COUNT; ++i)
+                phase.counters[i] += slot.counters[i].load(std::memory_order_relaxed);
+            phase.timeNs += slot.timeNs.load(std::memory_order_relaxed);
+            phase.calls += calls;
+            phase.countersEnabledNs += slot.countersEnabledNs.load(std::memory_order_relaxed);
+            phase.countersRunningNs += slot.countersRunningNs.load(std::memory_order_relaxed);
+        }
+    }
+    return phases;
+}
+
+bool PerfProfiler::WriteJson(std::ostream& stream) const
+{
+    const std::map<std::string, Phase> phases = GetPhases();
+    const PerfCounters& counters = PerfCounters::GetThreadCounters();
+
+    stream << "{\n  \"phases\": [\n";
+    std::size_t index = 0;
+    for (const auto& entry : phases)
+    {
+        const Phase& phase = entry.second;
+        stream << "    { \"name\": \"" << entry.first << "\", \"calls\": " << phase.calls << ", \"timeNs\": " << phase.timeNs;
+        for (int i = 0; i < PerfCounters::COUNT; ++i)
+        {
+            const PerfCounters::Counter counter = static_cast<PerfCounters::Counter>(i);
+            if (counters.IsAvailable(counter))
+                stream << ", \"" << PerfCounters::GetCounterName(counter) << "\": " << phase.counters[i];
+        }
+        if (phase.countersEnabledNs > 0)
+            stream << ", \"countersRunning\": " << static_cast<double>(phase.countersRunningNs) / phase.countersEnabledNs;
+        stream << " }" << (++index < phases.size() ? "," : "") << "\n";
+    }
+    stream << "  ]\n}\n";
+    return static_cast<bool>(stream);
+}
+
+} // namespace BrainFramework
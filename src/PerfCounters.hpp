@@ -0,0 +1,189 @@
+#pragma once
+
+#include "Utils.hpp"
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <mutex>
+
+namespace BrainFramework
+{
+
+// Hardware performance counters of the calling thread, read through perf_event_open on Linux
+// Elsewhere, or when the kernel refuses access, only wall time and calls are recorded
+class PerfCounters
+{
+public:
+    enum Counter
+    {
+        Cycles,
+        Instructions,
+        L1DMisses,
+        LLCMisses,
+        BranchMisses,
+
+        COUNT
+    };
+
+    struct Sample
+    {
+        std::array<std::uint64_t, COUNT> counters{};
+        std::uint64_t timeNs{ 0 };
+        // Time the counters were enabled and actually counting, they differ when the kernel multiplexes more counters than the PMU holds
+        std::uint64_t countersEnabledNs{ 0 };
+        std::uint64_t countersRunningNs{ 0 };
+    };
+
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool IsAvailable(Counter counter) const { return m_Indices[counter] >= 0; }
+
+    // Counters are free running, phases are the difference between two reads
+    Sample Read() const;
+
+    static const char* GetCounterName(Counter counter);
+
+    // Counters opened once per thread, on first use
+    static PerfCounters& GetThreadCounters();
+
+private:
+    int m_GroupFd{ -1 };
+    std::array<int, COUNT> m_Fds;
+    std::array<int, COUNT> m_Indices;
+    int m_OpenedCount{ 0 };
+};
+
+// Aggregates counters per named phase across every thread
+// Each thread adds into its own slots, keyed by the address of the phase name, slots are merged by name on read
+class PerfProfiler
+{
+public:
+    struct Phase
+    {
+        std::array<std::uint64_t, PerfCounters::COUNT> counters{}; // Scaled up from the time they counted when multiplexed
+        std::uint64_t timeNs{ 0 };
+        std::uint64_t calls{ 0 };
+        std::uint64_t countersEnabledNs{ 0 };
+        std::uint64_t countersRunningNs{ 0 };
+
+        // The counters are estimates when they only counted part of the phase
+        bool IsMultiplexed() const { return countersRunningNs < countersEnabledNs; }
+    };
+
+    PerfProfiler() : m_Id(ms_NextId.fetch_add(1, std::memory_order_relaxed)) {}
+    PerfProfiler(const PerfProfiler&) = delete;
+    PerfProfiler& operator=(const PerfProfiler&) = delete;
+
+    // The phase name must outlive the profiler, string literals in practice
+    // A sampled phase passes the calls each measured one stands for
+    void Add(const char* phase, const PerfCounters::Sample& start, const PerfCounters::Sample& end, std::uint64_t weight = 1);
+    void Reset();
+
+    std::map<std::string, Phase> GetPhases() const;
+    bool WriteJson(std::ostream& stream) const;
+
+    // Instrumented code only pays for a pointer check while no profiler is active
+    static void SetActive(PerfProfiler* profiler) { ms_Active.store(profiler, std::memory_order_release); }
+    static PerfProfiler* GetActive() { return ms_Active.load(std::memory_order_acquire); }
+
+private:
+    // Written by its thread only, without any atomic read-modify-write, read by anyone
+    struct Slot
+    {
+        std::atomic<const char*> phase{ nullptr }; // Published once the slot is ready
+        std::array<std::atomic<std::uint64_t>, PerfCounters::COUNT> counters{};
+        std::atomic<std::uint64_t> timeNs{ 0 };
+        std::atomic<std::uint64_t> calls{ 0 };
+        std::atomic<std::uint64_t> countersEnabledNs{ 0 };
+        std::atomic<std::uint64_t> countersRunningNs{ 0 };
+    };
+
+    static constexpr int k_MaxPhases = 64; // Per thread, phases past it are dropped
+
+    struct Shard
+    {
+        std::array<Slot, k_MaxPhases> slots;
+        int slotsCount{ 0 }; // Only touched by the thread of the shard
+    };
+
+    Shard& GetThreadShard();
+
+    std::vector<std::unique_ptr<Shard>> m_Shards;
+    mutable std::mutex m_Mutex; // Guards m_Shards, taken once per thread
+    std::uint64_t m_Id; // Tells a thread cache apart from one of an earlier profiler at the same address
+
+    static inline std::atomic<PerfProfiler*> ms_Active{ nullptr };
+    static inline std::atomic<std::uint64_t> ms_NextId{ 1 };
+};
+
+// Measures the enclosing scope into the active profiler, if any
+class PerfScope
+{
+public:
+    explicit PerfScope(const char* phase)
+        : m_Profiler(PerfProfiler::GetActive())
+        , m_Phase(phase)
+    {
+        if (m_Profiler != nullptr)
+            m_Start = PerfCounters::GetThreadCounters().Read();
+    }
+
+    ~PerfScope()
+    {
+        if (m_Profiler != nullptr)
+            m_Profiler->Add(m_Phase, m_Start, PerfCounters::GetThreadCounters().Read());
+    }
+
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+    PerfProfiler* m_Profiler;
+    const char* m_Phase;
+    PerfCounters::Sample m_Start;
+};
+
+// Measures one call in t_Interval of the enclosing scope, counted as t_Interval calls, for scopes too short to read the counters every time
+// Every sampled scope of a thread with the same interval shares the count
+template <std::uint32_t t_Interval>
+class SampledPerfScope
+{
+public:
+    explicit SampledPerfScope(const char* phase)
+        : m_Profiler(PerfProfiler::GetActive())
+        , m_Phase(phase)
+    {
+        if (m_Profiler == nullptr)
+            return;
+
+        if (++t_Calls < t_Interval)
+        {
+            m_Profiler = nullptr;
+            return;
+        }
+        t_Calls = 0;
+        m_Start = PerfCounters::GetThreadCounters().Read();
+    }
+
+    ~SampledPerfScope()
+    {
+        if (m_Profiler != nullptr)
+            m_Profiler->Add(m_Phase, m_Start, PerfCounters::GetThreadCounters().Read(), t_Interval);
+    }
+
+    SampledPerfScope(const SampledPerfScope&) = delete;
+    SampledPerfScope& operator=(const SampledPerfScope&) = delete;
+
+private:
+    PerfProfiler* m_Profiler;
+    const char* m_Phase;
+    PerfCounters::Sample m_Start;
+
+    static inline thread_local std::uint32_t t_Calls{ 0 };
+};
+
+} // namespace BrainFramework
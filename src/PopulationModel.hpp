@@ -0,0 +1,719 @@
+#pragma once
+
+#include "Model.hpp"
+#include "AtomicSnapshot.hpp"
+#include "EvaluationRace.hpp"
+#include "PerfCounters.hpp"
+#include "ScenarioSet.hpp"
+#include "SteadyStatePopulation.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+#include <string>
+
+namespace BrainFramework
+{
+
+// Scheduling of the models evolving a fixed population of genomes that live for many generations
+// A generation races the genomes over episodes, keeps the best third on lifetime averages and breeds the rest from its best half
+// In steady state the same population evolves without generations, a child at a time
+// The derived model brings what depends on its genome, called through CRTP:
+//     void MakeChild(TGenome& child, const TGenome& parent1, const TGenome* parent2): draws from the thread stream, no second parent without crossover
+//     void SaveBest(const TGenome& best): keeps what MakeBestNeuralNetwork builds from
+//     void AddStatsDetails(Stats& stats) const: what the stats show of the best genome
+//     void OnRanked(): optional, called once the genomes that breed next are ranked in m_Ranking
+// TGenome scores itself (EndBatch, GetAverageScore, GetLifetime), reads and writes itself, and shares the TNeuralNetwork it builds (GetNeuralNetwork)
+template <typename TDerived, typename TGenome, typename TNeuralNetwork>
+class PopulationModel : public Model
+{
+public:
+#ifndef BRAINFRAMEWORK_NO_IMGUI
+    void DisplayImGui() override
+    {
+        std::shared_ptr<const Stats> stats = m_Stats.Get();
+        if (stats == nullptr)
+            return;
+
+        ImGui::Text("Generation: %d", stats->generation);
+        ImGui::Text("MaxLifetime: %d", stats->maxLifetime);
+        ImGui::Text("AverageScoreTop5: %f", stats->averageScoreTop5);
+        ImGui::Text("AverageScoreTop10: %f", stats->averageScoreTop10);
+        ImGui::Text("AverageScore: %f", stats->averageScore);
+        ImGui::Text("Episodes: %d", stats->episodes);
+
+        // A request shows until the training thread applied it
+        std::shared_ptr<const DisplaySettings> requestedSettings = m_RequestedSettings.Get();
+        DisplaySettings settings = requestedSettings != nullptr ? *requestedSettings : stats->settings;
+        bool changed = ImGui::SliderInt("EpisodeBudget", &settings.episodeBudget, 0, k_Population * k_MaxEpisodes);
+        changed |= ImGui::Checkbox("CommonScenarios", &settings.commonScenarios);
+        changed |= ImGui::Checkbox("SteadyState", &settings.steadyState);
+        if (changed)
+            m_RequestedSettings.Publish(settings);
+
+        ImGui::PlotHistogram("MaxLifetime", stats->lifetimes.data(), static_cast<int>(stats->lifetimes.size()), 0, NULL, FLT_MAX, FLT_MAX, ImVec2(0, 80));
+        ImGui::PlotHistogram("AverageScoreTop5", stats->averageScoresTop5.data(), static_cast<int>(stats->averageScoresTop5.size()), 0, NULL, FLT_MAX, FLT_MAX, ImVec2(0, 80));
+        ImGui::PlotHistogram("AverageScoreTop10", stats->averageScoresTop10.data(), static_cast<int>(stats->averageScoresTop10.size()), 0, NULL, FLT_MAX, FLT_MAX, ImVec2(0, 80));
+        ImGui::PlotHistogram("AverageScore", stats->averageScores.data(), static_cast<int>(stats->averageScores.size()), 0, NULL, FLT_MAX, FLT_MAX, ImVec2(0, 80));
+
+        for (const auto& [name, value] : stats->details)
+        {
+            ImGui::Text("%s: %g", name, value);
+        }
+    }
+#endif
+
+    void ApplySettings() override
+    {
+        std::shared_ptr<const DisplaySettings> requestedSettings = m_RequestedSettings.Get();
+        if (requestedSettings == nullptr)
+            return;
+
+        m_RaceSettings.episodeBudget = requestedSettings->episodeBudget;
+        m_RaceSettings.commonScenarios = requestedSettings->commonScenarios;
+        SetSteadyState(requestedSettings->steadyState);
+
+        PublishStats();
+        m_RequestedSettings.Clear(requestedSettings);
+    }
+
+    bool PrepareTraining(const ISimulation& simulation) override
+    {
+        if (m_Genomes.empty())
+        {
+            const std::uint64_t generationSeed = GetGenerationSeed(m_Generation);
+            for (int i = 0; i < k_Population; ++i)
+            {
+                RandomScope genomeScope(DeriveSeed(generationSeed, i));
+                TGenome& genome = m_Genomes.emplace_back();
+                genome.Initialize(simulation.GetRLInputsCount(), simulation.GetRLOutputsCount());
+                genome.Mutate();
+            }
+        }
+
+        if (m_SteadyState)
+            StartSteadyState();
+        else
+            StartRace();
+
+        PublishStats();
+        return true;
+    }
+
+    // Genomes keep their slot in the population while evaluated, so the slot is the genome node
+    // Episodes are numbered across the rounds of the race, the first ones are the same whatever the budget
+    // With common scenarios, episode k of every genome is scenario k of the generation
+    // In steady state, the episodes of a job hang from its ticket
+    std::uint64_t GetEvaluationSeed() const override
+    {
+        if (m_SteadyState)
+        {
+            if (m_SequentialJob.slot >= 0)
+                return m_SequentialJob.evaluationSeeds[m_SequentialJob.results.size()];
+            return m_SteadyStatePopulation.GetJobSeed(m_SteadyStatePopulation.GetNextTicket(), 0);
+        }
+
+        const int genomeIndex = GetCurrentGenome();
+        return GetEvaluationSeed(genomeIndex, m_Race.GetEpisodes(genomeIndex));
+    }
+
+    std::uint64_t GetEvaluationSeed(int genomeIndex, int evaluation) const
+    {
+        if (m_Race.GetSettings().commonScenarios)
+            return m_Scenarios.GetSeed(evaluation);
+
+        return DeriveSeed(DeriveSeed(GetGenerationSeed(m_Generation), genomeIndex), evaluation);
+    }
+
+    bool SupportsBatch() const override { return true; }
+
+    // Every genome left in the round of the race, the current one only for the evaluations it still lacks
+    bool PrepareBatch(std::vector<EvaluationJob>& jobs) override
+    {
+        // The steady state has no round to hand out, its jobs go through AcquireJob
+        if (m_SteadyState)
+            return false;
+
+        const std::vector<int>& roundGenomes = m_Race.GetRoundCandidates();
+
+        jobs.clear();
+        jobs.reserve(roundGenomes.size() - m_RoundGenome);
+
+        int firstEvaluation = m_CurrentGenomeEvaluation;
+        for (int roundGenome = m_RoundGenome; roundGenome < static_cast<int>(roundGenomes.size()); ++roundGenome)
+        {
+            const int i = roundGenomes[roundGenome];
+            EvaluationJob& job = jobs.emplace_back();
+            SetJobGenome(job, m_Genomes[i]);
+
+            const int played = m_Race.GetEpisodes(i);
+            for (int evaluation = firstEvaluation; evaluation < m_Race.GetRoundEpisodes(roundGenome); ++evaluation)
+            {
+                job.evaluationSeeds.push_back(GetEvaluationSeed(i, played + evaluation - firstEvaluation));
+            }
+            firstEvaluation = 0;
+        }
+
+        return true;
+    }
+
+    bool StartEvaluation(std::shared_ptr<NeuralNetwork>& neuralNetwork) override
+    {
+        PerfScope perfScope(GetPhaseNames().startEvaluation.c_str());
+
+        // In steady state, the episodes are played one at a time as a job of their own
+        if (m_SteadyState && m_SequentialJob.slot < 0 && !AcquireJob(m_SequentialJob))
+        {
+            return false;
+        }
+
+        const TGenome& genome = m_Genomes[m_SteadyState ? m_SequentialJob.slot : GetCurrentGenome()];
+
+        // Built once per genome, every evaluation of the batch reuses it from cleared values
+        std::shared_ptr<TNeuralNetwork> genomeNeuralNetwork = genome.GetNeuralNetwork();
+        if (!genomeNeuralNetwork)
+        {
+            return false;
+        }
+
+        genomeNeuralNetwork->ResetState();
+        neuralNetwork = std::move(genomeNeuralNetwork);
+
+        return true;
+    }
+
+    bool EndEvalutation(float result) override
+    {
+        if (m_SteadyState)
+        {
+            if (m_SequentialJob.slot < 0)
+                return false;
+
+            m_SequentialJob.results.push_back(result);
+            if (m_SequentialJob.results.size() >= m_SequentialJob.evaluationSeeds.size())
+            {
+                CompleteJob(m_SequentialJob);
+                m_SequentialJob.slot = -1;
+            }
+            return true;
+        }
+
+        m_Race.AddResult(GetCurrentGenome(), result);
+
+        m_CurrentGenomeEvaluation++;
+        if (m_CurrentGenomeEvaluation >= m_Race.GetRoundEpisodes(m_RoundGenome))
+        {
+            m_CurrentGenomeEvaluation = 0;
+
+            NextGenome();
+        }
+
+        return true;
+    }
+
+    // The genomes with the best lifetime averages leave, arrivals take the place of the worst evaluated ones
+    // The race starts over with the arrivals, in steady state they are the next slots to mature
+    bool SupportsMigration() const override { return true; }
+
+    void WriteMigrants(int count, ByteWriter& writer) const override
+    {
+        std::vector<int> ranking;
+        RankEvaluated(ranking);
+
+        const int migrants = std::clamp(count, 0, static_cast<int>(ranking.size()));
+        writer.Write(static_cast<std::uint32_t>(migrants));
+        for (int i = 0; i < migrants; ++i)
+        {
+            m_Genomes[ranking[i]].Write(writer);
+        }
+    }
+
+    int ReadMigrants(ByteReader& reader) override
+    {
+        std::uint32_t count = 0;
+        if (m_Genomes.empty() || !reader.Read(count))
+            return 0;
+
+        std::vector<TGenome> arrivals;
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            TGenome arrival;
+            if (!arrival.Read(reader) || arrival.GetInputs() != m_Genomes[0].GetInputs() || arrival.GetOutputs() != m_Genomes[0].GetOutputs())
+                break;
+
+            arrivals.push_back(std::move(arrival));
+        }
+
+        // The best evaluated genome always stays
+        std::vector<int> ranking;
+        RankEvaluated(ranking);
+        const int arrived = std::min(static_cast<int>(arrivals.size()), std::max(static_cast<int>(ranking.size()) - 1, 0));
+        for (int i = 0; i < arrived; ++i)
+        {
+            const int slot = ranking[ranking.size() - 1 - i];
+            m_Genomes[slot] = std::move(arrivals[i]);
+            if (m_SteadyState)
+                m_SteadyStatePopulation.SetScore(slot, 0.0f, 0);
+        }
+
+        if (arrived > 0 && !m_SteadyState)
+            StartRace();
+        return arrived;
+    }
+
+    // Genomes travel whole in the compact encoding of Write, they live for many generations so a worker mostly finds them in its cache
+    std::shared_ptr<RemoteGenome> ReadRemoteGenome(ByteReader& reader) const override
+    {
+        std::shared_ptr<PopulationRemoteGenome> remoteGenome = std::make_shared<PopulationRemoteGenome>();
+        if (!remoteGenome->genome.Read(reader))
+            return nullptr;
+
+        return remoteGenome;
+    }
+
+    bool SupportsAsync() const override { return m_SteadyState; }
+
+    // The next genome nobody evaluates or breeds over, for a few episodes of its own
+    bool AcquireJob(EvaluationJob& job) override
+    {
+        if (!m_SteadyState)
+            return false;
+
+        std::uint64_t ticket = 0;
+        const int slot = m_SteadyStatePopulation.AcquireEvaluation(ticket);
+        if (slot < 0)
+            return false;
+
+        job.slot = slot;
+        SetJobGenome(job, m_Genomes[slot]);
+
+        job.evaluationSeeds.clear();
+        for (int evaluation = 0; evaluation < m_SteadyStatePopulation.GetSettings().jobEpisodes; ++evaluation)
+        {
+            job.evaluationSeeds.push_back(m_SteadyStatePopulation.GetJobSeed(ticket, evaluation));
+        }
+        job.results.clear();
+
+        return true;
+    }
+
+    // Adds the job to the lifetime average of the genome, then breeds a child from the thread that completed it
+    bool CompleteJob(EvaluationJob& job) override
+    {
+        float sum = 0.0f;
+        for (float result : job.results)
+        {
+            sum += result;
+        }
+
+        TGenome& genome = m_Genomes[job.slot];
+        genome.EndBatch(job.results.empty() ? 0.0f : sum / job.results.size());
+        const std::uint64_t completion = m_SteadyStatePopulation.CompleteEvaluation(job.slot, genome.GetAverageScore(), genome.GetLifetime());
+
+        BreedChild(completion);
+
+        // A population worth of jobs stands for a generation
+        if ((completion + 1) % m_Genomes.size() == 0)
+            Census();
+
+        return true;
+    }
+
+    int GetGeneration() const { return m_Generation; }
+    const std::vector<TGenome>& GetGenomes() const { return m_Genomes; }
+
+    // Episodes of a generation and how they are spread over the genomes, takes effect from the next generation
+    void SetRaceSettings(const EvaluationRace::Settings& raceSettings) { m_RaceSettings = raceSettings; }
+    const EvaluationRace::Settings& GetRaceSettings() const { return m_RaceSettings; }
+
+    // Switching keeps the population, the generation or the steady state in progress starts over
+    void SetSteadyState(bool steadyState)
+    {
+        if (steadyState == m_SteadyState)
+            return;
+
+        m_SteadyState = steadyState;
+        if (m_Genomes.empty())
+            return;
+
+        if (m_SteadyState)
+        {
+            StartSteadyState();
+        }
+        else
+        {
+            m_SequentialJob.slot = -1;
+            StartRace();
+        }
+    }
+    bool IsSteadyState() const { return m_SteadyState; }
+
+    // Takes effect from the next switch to the steady state
+    void SetSteadyStateSettings(const SteadyStatePopulation::Settings& steadyStateSettings) { m_SteadyStateSettings = steadyStateSettings; }
+    const SteadyStatePopulation::Settings& GetSteadyStateSettings() const { return m_SteadyStateSettings; }
+
+    static constexpr int k_Population = 300;
+    static constexpr int k_Cut = 3;
+    static constexpr int k_FirstRoundEpisodes = 2; // Episodes every genome plays each generation
+    static constexpr int k_MaxEpisodes = 8; // Episodes a genome close to the cut may play each generation
+    static constexpr int k_EpisodeBudget = k_Population * 4; // Episodes per generation, shared by all the rounds
+    static constexpr float k_CrossoverChance = 0.75f;
+
+    static constexpr int k_HistogramValues = 300;
+
+protected:
+    // Settings DisplayImGui can change
+    struct DisplaySettings
+    {
+        int episodeBudget{ 0 };
+        bool commonScenarios{ false };
+        bool steadyState{ false };
+    };
+
+    // What DisplayImGui shows, the training thread publishes a new copy and never changes a published one
+    struct Stats
+    {
+        int generation{ 0 };
+        int maxLifetime{ 0 };
+        float averageScoreTop5{ 0.0f };
+        float averageScoreTop10{ 0.0f };
+        float averageScore{ 0.0f };
+        int episodes{ 0 };
+        std::vector<float> lifetimes;
+        std::vector<float> averageScoresTop5;
+        std::vector<float> averageScoresTop10;
+        std::vector<float> averageScores;
+        std::vector<std::pair<const char*, float>> details; // Added by the derived model, shown by name
+        DisplaySettings settings;
+    };
+
+    // What a worker process rebuilds
+    using PopulationRemoteGenome = RemoteGenomeOf<TGenome, TNeuralNetwork>;
+
+    // Default for the optional hook
+    void OnRanked() {}
+
+    TDerived& GetDerived() { return static_cast<TDerived&>(*this); }
+    const TDerived& GetDerived() const { return static_cast<const TDerived&>(*this); }
+
+    // Profiler phases carry the name of the model, the profiler keys them on their address so they are built once per model
+    struct PhaseNames
+    {
+        explicit PhaseNames(const std::string& model)
+            : startEvaluation(model + "::StartEvaluation")
+            , breedChild(model + "::BreedChild")
+            , census(model + "::Census")
+            , newGeneration(model + "::NewGeneration")
+        {
+        }
+
+        std::string startEvaluation;
+        std::string breedChild;
+        std::string census;
+        std::string newGeneration;
+    };
+
+    const PhaseNames& GetPhaseNames() const
+    {
+        static const PhaseNames phaseNames(GetDerived().GetName());
+        return phaseNames;
+    }
+
+    static void SetJobGenome(EvaluationJob& job, const TGenome& genome)
+    {
+        job.makeNeuralNetwork = [genome = &genome](std::shared_ptr<NeuralNetwork>& neuralNetwork)
+        {
+            neuralNetwork = genome->GetNeuralNetwork();
+            return neuralNetwork != nullptr;
+        };
+        job.describeGenome = [genome = &genome](GenomeDescription& description, bool writeBytes)
+        {
+            genome->Describe(description, writeBytes);
+        };
+    }
+
+    // Genomes evaluated at least once, best lifetime average first
+    void RankEvaluated(std::vector<int>& ranking) const
+    {
+        ranking.clear();
+        for (int i = 0; i < static_cast<int>(m_Genomes.size()); ++i)
+        {
+            if (m_Genomes[i].GetLifetime() > 0)
+                ranking.push_back(i);
+        }
+        std::stable_sort(ranking.begin(), ranking.end(), [&](int a, int b)
+        {
+            return m_Genomes[a].GetAverageScore() > m_Genomes[b].GetAverageScore();
+        });
+    }
+
+    void NextGenome()
+    {
+        m_RoundGenome++;
+        if (m_RoundGenome < static_cast<int>(m_Race.GetRoundCandidates().size()))
+            return;
+
+        m_RoundGenome = 0;
+        if (m_Race.NextRound())
+            return;
+
+        // Every genome is scored on all the episodes it played in the race
+        for (int i = 0; i < static_cast<int>(m_Genomes.size()); ++i)
+        {
+            m_Genomes[i].EndBatch(m_Race.GetMean(i));
+        }
+        m_LastGenerationEpisodes = m_Race.GetTotalEpisodes();
+
+        NewGeneration();
+        StartRace();
+    }
+
+    // Races the population against what the next generation selects on lifetime averages: the best genome, the parents and the cut
+    void StartRace()
+    {
+        m_RoundGenome = 0;
+        m_CurrentGenomeEvaluation = 0;
+
+        const int genomes = static_cast<int>(m_Genomes.size());
+        const int survivors = genomes / k_Cut;
+        const std::array<int, 3> cutoffs = { 1, survivors / 2 + 1, survivors };
+        m_Race.Start(genomes, cutoffs, m_RaceSettings);
+        // One scenario per episode a genome can play, as the race clamped them
+        m_Scenarios.Draw(GetGenerationSeed(m_Generation), m_Race.GetSettings().maxEpisodes);
+        for (int i = 0; i < genomes; ++i)
+        {
+            m_Race.SetHistory(i, m_Genomes[i].GetAverageScore(), m_Genomes[i].GetLifetime());
+        }
+    }
+
+    int GetCurrentGenome() const { return m_Race.GetRoundCandidates()[m_RoundGenome]; }
+
+    // The genomes keep the scores they earned, the episodes and births hang from the current generation
+    void StartSteadyState()
+    {
+        m_SequentialJob.slot = -1;
+
+        const int genomes = static_cast<int>(m_Genomes.size());
+        m_SteadyStatePopulation.Start(genomes, GetGenerationSeed(m_Generation), m_SteadyStateSettings);
+        for (int i = 0; i < genomes; ++i)
+        {
+            m_SteadyStatePopulation.SetScore(i, m_Genomes[i].GetAverageScore(), m_Genomes[i].GetLifetime());
+        }
+    }
+
+    // The worst of a tournament of mature genomes gives its slot to a child of two tournament winners
+    // Skipped when another thread holds the genomes the tournaments picked
+    void BreedChild(std::uint64_t completion)
+    {
+        if (!m_SteadyStatePopulation.IsBirth(completion))
+            return;
+
+        PerfScope perfScope(GetPhaseNames().breedChild.c_str());
+        RandomScope birthScope(m_SteadyStatePopulation.GetBirthSeed(completion));
+
+        const int victim = m_SteadyStatePopulation.AcquireVictim();
+        if (victim < 0)
+            return;
+
+        int parent1Index = m_SteadyStatePopulation.AcquireParent();
+        int parent2Index = m_SteadyStatePopulation.AcquireParent();
+        if (parent1Index < 0)
+            std::swap(parent1Index, parent2Index);
+
+        if (parent1Index < 0)
+        {
+            m_SteadyStatePopulation.ReleaseWrite(victim);
+            return;
+        }
+
+        TGenome& child = m_Genomes[victim];
+        child = TGenome();
+        const bool crossover = RandomFloat() < k_CrossoverChance && parent2Index >= 0 && parent1Index != parent2Index;
+        GetDerived().MakeChild(child, m_Genomes[parent1Index], crossover ? &m_Genomes[parent2Index] : nullptr);
+
+        m_SteadyStatePopulation.ReleaseRead(parent1Index);
+        if (parent2Index >= 0)
+            m_SteadyStatePopulation.ReleaseRead(parent2Index);
+        m_SteadyStatePopulation.CompleteBirth(victim);
+    }
+
+    // Generation statistics of the steady state, taken by the thread completing every population worth of jobs
+    // The others keep evaluating meanwhile, and skip their own census while one is running
+    void Census()
+    {
+        std::unique_lock<std::mutex> lock(m_CensusMutex, std::try_to_lock);
+        if (!lock.owns_lock())
+            return;
+
+        PerfScope perfScope(GetPhaseNames().census.c_str());
+
+        // OnRanked draws from the generation node, as in NewGeneration
+        RandomScope generationScope(GetGenerationSeed(m_Generation + 1));
+
+        // Ranked on lifetime averages, as NewGeneration does, children too young to compare are left out
+        m_MaxLifetime = 0;
+        m_Ranking.clear();
+        for (int i = 0; i < m_SteadyStatePopulation.GetSlotsCount(); ++i)
+        {
+            m_MaxLifetime = std::max(m_MaxLifetime, m_SteadyStatePopulation.GetLifetime(i));
+            if (m_SteadyStatePopulation.IsMature(i))
+                m_Ranking.push_back(i);
+        }
+        std::stable_sort(m_Ranking.begin(), m_Ranking.end(), [&](int a, int b)
+        {
+            return m_SteadyStatePopulation.GetAverageScore(a) > m_SteadyStatePopulation.GetAverageScore(b);
+        });
+
+        if (!m_Ranking.empty())
+        {
+            // Kept when the best is being bred over right now, the next census will have it
+            const int best = m_Ranking[0];
+            if (m_SteadyStatePopulation.TryAcquireRead(best))
+            {
+                GetDerived().SaveBest(m_Genomes[best]);
+                m_SteadyStatePopulation.ReleaseRead(best);
+            }
+
+            GetDerived().OnRanked();
+
+            // Health of the genomes a generation would keep
+            UpdateHealth(std::max(static_cast<int>(m_Ranking.size()) / k_Cut, 1), [&](int rank) { return m_SteadyStatePopulation.GetAverageScore(m_Ranking[rank]); });
+        }
+
+        AddToHistograms();
+
+        m_Generation++;
+        PublishStats();
+    }
+
+    // Averages of the first genomes of the ranking
+    template <typename TScore>
+    void UpdateHealth(int size, TScore score)
+    {
+        m_AverageScore = 0.0f;
+        m_AverageScoreTop5 = 0.0f;
+        m_AverageScoreTop10 = 0.0f;
+        for (int i = 0; i < size; ++i)
+        {
+            const float avg = score(i);
+            if (i < 5) m_AverageScoreTop5 += avg;
+            if (i < 10) m_AverageScoreTop10 += avg;
+            m_AverageScore += avg;
+        }
+        m_AverageScore /= size;
+        m_AverageScoreTop5 /= 5;
+        m_AverageScoreTop10 /= 10;
+    }
+
+    // Copies what DisplayImGui shows, at the end of every generation and census
+    void PublishStats()
+    {
+        Stats stats;
+        stats.generation = m_Generation;
+        stats.maxLifetime = m_MaxLifetime;
+        stats.averageScoreTop5 = m_AverageScoreTop5;
+        stats.averageScoreTop10 = m_AverageScoreTop10;
+        stats.averageScore = m_AverageScore;
+        stats.episodes = m_LastGenerationEpisodes;
+        stats.lifetimes = m_LifetimeArray;
+        stats.averageScoresTop5 = m_AverageScoreTop5Array;
+        stats.averageScoresTop10 = m_AverageScoreTop10Array;
+        stats.averageScores = m_AverageScoreArray;
+        GetDerived().AddStatsDetails(stats);
+        stats.settings = { m_RaceSettings.episodeBudget, m_RaceSettings.commonScenarios, m_SteadyState };
+        m_Stats.Publish(std::move(stats));
+    }
+
+    void AddToHistograms()
+    {
+        m_LifetimeArray.push_back(static_cast<float>(m_MaxLifetime));
+        if (m_LifetimeArray.size() > k_HistogramValues) m_LifetimeArray.erase(m_LifetimeArray.begin());
+        m_AverageScoreTop5Array.push_back(m_AverageScoreTop5);
+        if (m_AverageScoreTop5Array.size() > k_HistogramValues) m_AverageScoreTop5Array.erase(m_AverageScoreTop5Array.begin());
+        m_AverageScoreTop10Array.push_back(m_AverageScoreTop10);
+        if (m_AverageScoreTop10Array.size() > k_HistogramValues) m_AverageScoreTop10Array.erase(m_AverageScoreTop10Array.begin());
+        m_AverageScoreArray.push_back(m_AverageScore);
+        if (m_AverageScoreArray.size() > k_HistogramValues) m_AverageScoreArray.erase(m_AverageScoreArray.begin());
+    }
+
+    void NewGeneration()
+    {
+        PerfScope perfScope(GetPhaseNames().newGeneration.c_str());
+
+        // Generation wide work (OnRanked) draws from the generation node, each child from its own node
+        const std::uint64_t generationSeed = GetGenerationSeed(m_Generation + 1);
+        RandomScope generationScope(generationSeed);
+
+        m_MaxLifetime = 0;
+        for (const TGenome& genome : m_Genomes)
+        {
+            m_MaxLifetime = std::max(m_MaxLifetime, genome.GetLifetime());
+        }
+
+        // Stable so ties keep the population order
+        std::stable_sort(m_Genomes.begin(), m_Genomes.end(), [&](const TGenome& a, const TGenome& b)
+        {
+            return a.GetAverageScore() > b.GetAverageScore();
+        });
+
+        GetDerived().SaveBest(m_Genomes[0]);
+
+        // Cull the bottom
+        m_Genomes.erase(m_Genomes.begin() + m_Genomes.size() / k_Cut, m_Genomes.end());
+
+        const int size = static_cast<int>(m_Genomes.size());
+
+        m_Ranking.resize(size);
+        std::iota(m_Ranking.begin(), m_Ranking.end(), 0);
+        GetDerived().OnRanked();
+
+        UpdateHealth(size, [&](int rank) { return m_Genomes[rank].GetAverageScore(); });
+        AddToHistograms();
+
+        // Breed from any adults
+        for (int i = size; i < k_Population; ++i)
+        {
+            RandomScope childScope(DeriveSeed(generationSeed, i));
+
+            const int parent1Index = RandomInt(0, size / 2);
+            const int parent2Index = RandomInt(0, size / 2);
+
+            TGenome& child = m_Genomes.emplace_back();
+            const bool crossover = RandomFloat() < k_CrossoverChance && parent1Index != parent2Index;
+            GetDerived().MakeChild(child, m_Genomes[parent1Index], crossover ? &m_Genomes[parent2Index] : nullptr);
+        }
+
+        m_Generation++;
+        PublishStats();
+    }
+
+    std::vector<TGenome> m_Genomes;
+    std::vector<int> m_Ranking; // Genome indices, best first
+    EvaluationRace m_Race;
+    EvaluationRace::Settings m_RaceSettings{ .firstRoundEpisodes = k_FirstRoundEpisodes, .maxEpisodes = k_MaxEpisodes, .episodeBudget = k_EpisodeBudget };
+    ScenarioSet m_Scenarios;
+    int m_RoundGenome{ 0 };
+    int m_CurrentGenomeEvaluation{ 0 };
+    int m_LastGenerationEpisodes{ 0 };
+
+    bool m_SteadyState{ false };
+    SteadyStatePopulation m_SteadyStatePopulation;
+    SteadyStatePopulation::Settings m_SteadyStateSettings;
+    EvaluationJob m_SequentialJob; // Job of the episodes played through StartEvaluation
+    std::mutex m_CensusMutex;
+
+    int m_Generation{ 0 };
+    int m_MaxLifetime{ 0 };
+    float m_AverageScoreTop5{ 0.0f };
+    float m_AverageScoreTop10{ 0.0f };
+    float m_AverageScore{ 0.0f };
+    std::vector<float> m_LifetimeArray;
+    std::vector<float> m_AverageScoreTop5Array;
+    std::vector<float> m_AverageScoreTop10Array;
+    std::vector<float> m_AverageScoreArray;
+
+    AtomicSnapshot<Stats> m_Stats;
+    AtomicSnapshot<DisplaySettings> m_RequestedSettings;
+};
+
+} // namespace BrainFramework
@@ -0,0 +1,282 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <span>
+
+namespace BrainFramework
+{
+
+// Counter-based generator (Philox4x32-10), every block of 4 outputs is a pure function of (key, counter)
+// Streams with different keys or counter ranges are independent, so they can be handed out per thread freely
+class Philox4x32
+{
+public:
+    using Counter = std::array<std::uint32_t, 4>;
+    using Key = std::array<std::uint32_t, 2>;
+
+    static Counter Generate(Counter counter, Key key)
+    {
+        for (int round = 0; round < k_Rounds; ++round)
+        {
+            const std::uint64_t product0 = static_cast<std::uint64_t>(k_Multiplier0) * counter[0];
+            const std::uint64_t product1 = static_cast<std::uint64_t>(k_Multiplier1) * counter[2];
+            counter = {
+                static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                static_cast<std::uint32_t>(product1),
+                static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                static_cast<std::uint32_t>(product0)
+            };
+            key[0] += k_Weyl0;
+            key[1] += k_Weyl1;
+        }
+        return counter;
+    }
+
+private:
+    static constexpr int k_Rounds = 10;
+    static constexpr std::uint32_t k_Multiplier0 = 0xD2511F53;
+    static constexpr std::uint32_t k_Multiplier1 = 0xCD9E8D57;
+    static constexpr std::uint32_t k_Weyl0 = 0x9E3779B9;
+    static constexpr std::uint32_t k_Weyl1 = 0xBB67AE85;
+};
+
+// Mixes a 64 bits value into a well distributed one, used to derive keys and child seeds
+inline std::uint64_t SplitMix64(std::uint64_t value)
+{
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+// Child seed of a node of the seed tree, e.g. run -> generation -> genome -> episode
+// Randomness tied to the work item instead of the thread keeps a run reproducible whatever the threads count
+inline std::uint64_t DeriveSeed(std::uint64_t parent, std::uint64_t index)
+{
+    return SplitMix64(SplitMix64(parent) + index);
+}
+
+// One Philox stream: the key comes from the seed, the stream id fills the high half of the counter
+// Satisfies UniformRandomBitGenerator so it also works with the std algorithms
+class RandomStream
+{
+public:
+    using result_type = std::uint32_t;
+
+    RandomStream(std::uint64_t seed = 0, std::uint64_t stream = 0) { Reset(seed, stream); }
+
+    void Reset(std::uint64_t seed, std::uint64_t stream)
+    {
+        const std::uint64_t key = SplitMix64(seed);
+        m_Key = { static_cast<std::uint32_t>(key), static_cast<std::uint32_t>(key >> 32) };
+        m_Counter = { 0, 0, static_cast<std::uint32_t>(stream), static_cast<std::uint32_t>(stream >> 32) };
+        m_Index = 4;
+    }
+
+    std::uint32_t NextUInt32()
+    {
+        if (m_Index == 4)
+        {
+            m_Block = Philox4x32::Generate(m_Counter, m_Key);
+            if (++m_Counter[0] == 0)
+                ++m_Counter[1];
+            m_Index = 0;
+        }
+        return m_Block[m_Index++];
+    }
+
+    std::uint64_t NextUInt64()
+    {
+        const std::uint64_t low = NextUInt32();
+        return low | (static_cast<std::uint64_t>(NextUInt32()) << 32);
+    }
+
+    // Same sequence as calling NextUInt32 repeatedly, whole blocks are written straight to the output
+    void Fill(std::span<std::uint32_t> values)
+    {
+        std::size_t i = 0;
+        while (m_Index < 4 && i < values.size())
+            values[i++] = m_Block[m_Index++];
+
+        for (; values.size() - i >= 4; i += 4)
+        {
+            const Philox4x32::Counter block = Philox4x32::Generate(m_Counter, m_Key);
+            if (++m_Counter[0] == 0)
+                ++m_Counter[1];
+            values[i] = block[0];
+            values[i + 1] = block[1];
+            values[i + 2] = block[2];
+            values[i + 3] = block[3];
+        }
+
+        for (; i < values.size(); ++i)
+            values[i] = NextUInt32();
+    }
+
+    // [min, max)
+    void FillUniform(std::span<float> values, float min = 0.0f, float max = 1.0f)
+    {
+        std::uint32_t bits[k_ChunkSize];
+        const float scale = (max - min) * (1.0f / 16777216.0f);
+        for (std::size_t i = 0; i < values.size(); i += k_ChunkSize)
+        {
+            const std::size_t count = std::min<std::size_t>(k_ChunkSize, values.size() - i);
+            Fill(std::span<std::uint32_t>(bits, count));
+            for (std::size_t j = 0; j < count; ++j)
+                values[i + j] = min + static_cast<float>(bits[j] >> 8) * scale;
+        }
+    }
+
+    // Box-Muller on pairs of uniforms, an odd last value still consumes a full pair
+    void FillNormal(std::span<float> values, float mean = 0.0f, float standardDeviation = 1.0f)
+    {
+        constexpr float k_TwoPi = 6.28318530718f;
+        std::uint32_t bits[k_ChunkSize];
+        for (std::size_t i = 0; i < values.size(); i += k_ChunkSize)
+        {
+            const std::size_t count = std::min<std::size_t>(k_ChunkSize, values.size() - i);
+            const std::size_t pairs = (count + 1) / 2;
+            Fill(std::span<std::uint32_t>(bits, 2 * pairs));
+            for (std::size_t j = 0; j < pairs; ++j)
+            {
+                const float u1 = static_cast<float>((bits[2 * j] >> 8) + 1) * (1.0f / 16777216.0f); // (0, 1], log stays finite
+                const float u2 = static_cast<float>(bits[2 * j + 1] >> 8) * (1.0f / 16777216.0f);
+                const float radius = standardDeviation * std::sqrt(-2.0f * std::log(u1));
+                const float angle = k_TwoPi * u2;
+                values[i + 2 * j] = mean + radius * std::cos(angle);
+                if (2 * j + 1 < count)
+                    values[i + 2 * j + 1] = mean + radius * std::sin(angle);
+            }
+        }
+    }
+
+    // 1 with probability p, 0 otherwise
+    void FillBernoulli(std::span<std::uint8_t> values, float p)
+    {
+        std::uint32_t bits[k_ChunkSize];
+        const std::uint64_t threshold = static_cast<std::uint64_t>(static_cast<double>(std::clamp(p, 0.0f, 1.0f)) * 4294967296.0);
+        for (std::size_t i = 0; i < values.size(); i += k_ChunkSize)
+        {
+            const std::size_t count = std::min<std::size_t>(k_ChunkSize, values.size() - i);
+            Fill(std::span<std::uint32_t>(bits, count));
+            for (std::size_t j = 0; j < count; ++j)
+                values[i + j] = static_cast<std::uint8_t>(bits[j] < threshold ? 1 : 0);
+        }
+    }
+
+    // [0, 1)
+    float NextFloat() { return static_cast<float>(NextUInt32() >> 8) * (1.0f / 16777216.0f); }
+
+    // [min, max], unbiased
+    int NextInt(int min, int max)
+    {
+        const std::uint32_t range = static_cast<std::uint32_t>(max) - static_cast<std::uint32_t>(min) + 1;
+        if (range == 0)
+            return static_cast<int>(NextUInt32());
+
+        std::uint64_t product = static_cast<std::uint64_t>(NextUInt32()) * range;
+        if (static_cast<std::uint32_t>(product) < range)
+        {
+            const std::uint32_t threshold = (0u - range) % range;
+            while (static_cast<std::uint32_t>(product) < threshold)
+                product = static_cast<std::uint64_t>(NextUInt32()) * range;
+        }
+        return static_cast<int>(static_cast<std::uint32_t>(min) + static_cast<std::uint32_t>(product >> 32));
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFFu; }
+    result_type operator()() { return NextUInt32(); }
+
+private:
+    static constexpr std::size_t k_ChunkSize = 256;
+
+    Philox4x32::Key m_Key;
+    Philox4x32::Counter m_Counter;
+    Philox4x32::Counter m_Block;
+    int m_Index{ 4 };
+};
+
+// Process wide run seed, each thread draws from its own stream derived from it
+class Random
+{
+public:
+    // Restarts every thread stream, stream ids are handed out again in order of first use
+    static void SetRunSeed(std::uint64_t seed)
+    {
+        ms_RunSeed.store(seed, std::memory_order_relaxed);
+        ms_NextStreamId.store(0, std::memory_order_relaxed);
+        ms_Epoch.fetch_add(1, std::memory_order_release);
+    }
+    static std::uint64_t GetRunSeed() { return ms_RunSeed.load(std::memory_order_relaxed); }
+
+    // The innermost RandomScope of the thread if any, otherwise the thread stream
+    static RandomStream& GetThreadStream()
+    {
+        if (t_ScopedStream != nullptr)
+            return *t_ScopedStream;
+
+        thread_local ThreadState state;
+        const std::uint64_t epoch = ms_Epoch.load(std::memory_order_acquire);
+        if (state.epoch != epoch)
+        {
+            state.stream.Reset(GetRunSeed(), ms_NextStreamId.fetch_add(1, std::memory_order_relaxed));
+            state.epoch = epoch;
+        }
+        return state.stream;
+    }
+
+private:
+    friend class RandomScope;
+
+    struct ThreadState
+    {
+        RandomStream stream;
+        std::uint64_t epoch{ 0 };
+    };
+
+    static std::uint64_t MakeDefaultSeed()
+    {
+        std::random_device device;
+        return (static_cast<std::uint64_t>(device()) << 32) | device();
+    }
+
+    static inline std::atomic<std::uint64_t> ms_RunSeed{ MakeDefaultSeed() };
+    static inline std::atomic<std::uint64_t> ms_NextStreamId{ 0 };
+    static inline std::atomic<std::uint64_t> ms_Epoch{ 1 }; // Thread states start at 0 so they pick up the first seed
+    static inline thread_local RandomStream* t_ScopedStream{ nullptr };
+};
+
+// Routes every random draw of the calling thread to a stream seeded from a seed tree node, until the scope ends
+// Scopes nest, the previous stream is restored on exit
+class RandomScope
+{
+public:
+    explicit RandomScope(std::uint64_t seed)
+        : m_Stream(seed)
+        , m_Previous(Random::t_ScopedStream)
+    {
+        Random::t_ScopedStream = &m_Stream;
+    }
+
+    ~RandomScope()
+    {
+        Random::t_ScopedStream = m_Previous;
+    }
+
+    RandomScope(const RandomScope&) = delete;
+    RandomScope& operator=(const RandomScope&) = delete;
+
+    RandomStream& GetStream() { return m_Stream; }
+
+private:
+    RandomStream m_Stream;
+    RandomStream* m_Previous;
+};
+
+} // namespace BrainFramework
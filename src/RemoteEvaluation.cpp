@@ -0,0 +1,874 @@
+#include "RemoteEvaluation.hpp"
+#include "PerfCounters.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace BrainFramework
+{
+
+namespace
+{
+
+constexpr std::uint32_t k_Magic = 0x45524642; // "BFRE"
+constexpr std::uint32_t k_Version = 1;
+constexpr std::uint32_t k_MaxFrameBytes = 1u << 28;
+constexpr int k_MaxWorkerThreads = 4096;
+constexpr int k_ConnectAttempts = 50; // Every 100 ms, so workers may start a few seconds before the coordinator
+
+enum class GenomeKind : std::uint8_t
+{
+    Cached, // Key only
+    Full, // Key and bytes
+    Bred, // Key, parent keys and breeding seed
+};
+
+enum class JobStatus : std::uint8_t
+{
+    Played, // Followed by the results
+    Missing, // The worker didn't hold the genome or its parents, or bred a different one
+};
+
+// Frames start with their size, written as a placeholder then filled in
+void BeginFrame(ByteWriter& frame)
+{
+    frame.Clear();
+    frame.Write(std::uint32_t{ 0 });
+}
+
+void EndFrame(ByteWriter& frame)
+{
+    frame.WriteAt(0, static_cast<std::uint32_t>(frame.GetBytes().size() - sizeof(std::uint32_t)));
+}
+
+#if !defined(_WIN32)
+
+bool SendAll(int socket, const std::vector<std::uint8_t>& bytes)
+{
+    std::size_t offset = 0;
+    while (offset < bytes.size())
+    {
+        const ssize_t sent = send(socket, bytes.data() + offset, bytes.size() - offset, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR)
+            continue;
+        if (sent <= 0)
+            return false;
+
+        offset += static_cast<std::size_t>(sent);
+    }
+    return true;
+}
+
+bool ReceiveAll(int socket, void* data, std::size_t size)
+{
+    std::uint8_t* bytes = static_cast<std::uint8_t*>(data);
+    while (size > 0)
+    {
+        const ssize_t received = recv(socket, bytes, size, 0);
+        if (received < 0 && errno == EINTR)
+            continue;
+        if (received <= 0)
+            return false;
+
+        bytes += received;
+        size -= static_cast<std::size_t>(received);
+    }
+    return true;
+}
+
+void CloseSocket(int socket)
+{
+    close(socket);
+}
+
+// Frames are written whole, there is nothing for Nagle to gather, fails harmlessly on local sockets
+void SetNoDelay(int socket)
+{
+    int enabled = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+}
+
+// unix:PATH, or HOST:PORT with an empty host for loopback, false when the address is malformed
+bool SplitAddress(const std::string& address, std::string& unixPath, std::string& host, std::string& port)
+{
+    constexpr std::string_view unixPrefix = "unix:";
+    if (address.starts_with(unixPrefix))
+    {
+        unixPath = address.substr(unixPrefix.size());
+        return !unixPath.empty() && unixPath.size() < sizeof(sockaddr_un::sun_path);
+    }
+
+    const std::size_t colon = address.rfind(':');
+    if (colon == std::string::npos || colon + 1 == address.size())
+        return false;
+
+    host = address.substr(0, colon);
+    port = address.substr(colon + 1);
+    return true;
+}
+
+sockaddr_un MakeUnixAddress(const std::string& path)
+{
+    sockaddr_un unixAddress{};
+    unixAddress.sun_family = AF_UNIX;
+    std::memcpy(unixAddress.sun_path, path.c_str(), path.size() + 1);
+    return unixAddress;
+}
+
+int OpenListenSocket(const std::string& address, std::string& unixPath)
+{
+    std::string host;
+    std::string port;
+    if (!SplitAddress(address, unixPath, host, port))
+        return -1;
+
+    if (!unixPath.empty())
+    {
+        const int listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenSocket < 0)
+            return -1;
+
+        // A socket file left by an earlier run would make bind fail
+        unlink(unixPath.c_str());
+        const sockaddr_un unixAddress = MakeUnixAddress(unixPath);
+        if (bind(listenSocket, reinterpret_cast<const sockaddr*>(&unixAddress), sizeof(unixAddress)) != 0 || listen(listenSocket, SOMAXCONN) != 0)
+        {
+            CloseSocket(listenSocket);
+            return -1;
+        }
+        return listenSocket;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    // Workers are not authenticated, listening beyond this machine has to be asked for with an explicit host
+    if (getaddrinfo(host.empty() ? "localhost" : host.c_str(), port.c_str(), &hints, &addresses) != 0)
+        return -1;
+
+    int listenSocket = -1;
+    for (addrinfo* info = addresses; info != nullptr && listenSocket < 0; info = info->ai_next)
+    {
+        listenSocket = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+        if (listenSocket < 0)
+            continue;
+
+        int enabled = 1;
+        setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled));
+        if (bind(listenSocket, info->ai_addr, info->ai_addrlen) != 0 || listen(listenSocket, SOMAXCONN) != 0)
+        {
+            CloseSocket(listenSocket);
+            listenSocket = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    return listenSocket;
+}
+
+int AcceptSocket(int listenSocket)
+{
+    while (true)
+    {
+        const int acceptedSocket = accept(listenSocket, nullptr, nullptr);
+        if (acceptedSocket >= 0 || errno != EINTR)
+            return acceptedSocket;
+    }
+}
+
+int ConnectOnce(const std::string& address)
+{
+    std::string unixPath;
+    std::string host;
+    std::string port;
+    if (!SplitAddress(address, unixPath, host, port))
+        return -1;
+
+    if (!unixPath.empty())
+    {
+        const int connectedSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (connectedSocket < 0)
+            return -1;
+
+        const sockaddr_un unixAddress = MakeUnixAddress(unixPath);
+        if (connect(connectedSocket, reinterpret_cast<const sockaddr*>(&unixAddress), sizeof(unixAddress)) != 0)
+        {
+            CloseSocket(connectedSocket);
+            return -1;
+        }
+        return connectedSocket;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (getaddrinfo(host.empty() ? "localhost" : host.c_str(), port.c_str(), &hints, &addresses) != 0)
+        return -1;
+
+    int connectedSocket = -1;
+    for (addrinfo* info = addresses; info != nullptr && connectedSocket < 0; info = info->ai_next)
+    {
+        connectedSocket = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+        if (connectedSocket < 0)
+            continue;
+
+        if (connect(connectedSocket, info->ai_addr, info->ai_addrlen) != 0)
+        {
+            CloseSocket(connectedSocket);
+            connectedSocket = -1;
+        }
+        else
+        {
+            SetNoDelay(connectedSocket);
+        }
+    }
+    freeaddrinfo(addresses);
+    return connectedSocket;
+}
+
+// Indices of the sockets with a frame to read or a hang up to notice, waits until there is one
+bool WaitReadable(const std::vector<int>& sockets, std::vector<int>& readable)
+{
+    thread_local std::vector<pollfd> pollFds;
+    pollFds.clear();
+    for (int socket : sockets)
+    {
+        pollFds.push_back({ socket, POLLIN, 0 });
+    }
+
+    int ready = -1;
+    do
+    {
+        ready = poll(pollFds.data(), pollFds.size(), -1);
+    } while (ready < 0 && errno == EINTR);
+    if (ready < 0)
+        return false;
+
+    readable.clear();
+    for (std::size_t i = 0; i < pollFds.size(); ++i)
+    {
+        if (pollFds[i].revents != 0)
+            readable.push_back(static_cast<int>(i));
+    }
+    return true;
+}
+
+#else
+
+// Sockets are only implemented for POSIX systems, remote evaluation fails to start elsewhere
+bool SendAll(int, const std::vector<std::uint8_t>&) { return false; }
+bool ReceiveAll(int, void*, std::size_t) { return false; }
+void CloseSocket(int) {}
+void SetNoDelay(int) {}
+int OpenListenSocket(const std::string&, std::string&) { return -1; }
+int AcceptSocket(int) { return -1; }
+int ConnectOnce(const std::string&) { return -1; }
+bool WaitReadable(const std::vector<int>&, std::vector<int>&) { return false; }
+
+#endif
+
+bool ReceiveFrameBytes(int socket, std::vector<std::uint8_t>& frame)
+{
+    std::uint32_t size = 0;
+    if (!ReceiveAll(socket, &size, sizeof(size)) || size > k_MaxFrameBytes)
+        return false;
+
+    frame.resize(size);
+    return ReceiveAll(socket, frame.data(), frame.size());
+}
+
+} // namespace
+
+RemoteEvaluator::~RemoteEvaluator()
+{
+    Close();
+}
+
+bool RemoteEvaluator::Listen(const std::string& address)
+{
+    Close();
+    m_ListenSocket = OpenListenSocket(address, m_UnixPath);
+    return m_ListenSocket >= 0;
+}
+
+bool RemoteEvaluator::Accept(int workersCount, const RemoteSession& session)
+{
+    if (m_ListenSocket < 0)
+        return false;
+
+    std::vector<std::uint8_t> hello;
+    while (static_cast<int>(m_Workers.size()) < workersCount)
+    {
+        const int workerSocket = AcceptSocket(m_ListenSocket);
+        if (workerSocket < 0)
+            return false;
+        SetNoDelay(workerSocket);
+
+        // The worker introduces itself first, so the session can size its cache on its threads
+        if (!ReceiveFrameBytes(workerSocket, hello))
+        {
+            CloseSocket(workerSocket);
+            continue;
+        }
+
+        ByteReader reader(hello);
+        std::uint32_t magic = 0;
+        std::uint64_t version = 0;
+        int threads = 0;
+        reader.Read(magic);
+        reader.ReadVarint(version);
+        reader.ReadVarint(threads, k_MaxWorkerThreads);
+        if (reader.HasFailed() || magic != k_Magic || version != k_Version || threads <= 0)
+        {
+            CloseSocket(workerSocket);
+            continue;
+        }
+
+        // Enough room for every genome and parent of the frames in flight, so a frame never evicts what it relies on
+        const int frameJobs = threads * k_JobsPerThread;
+        const int cacheCapacity = std::max(session.cacheCapacity, 3 * k_FramesInFlight * frameJobs);
+
+        BeginFrame(m_Frame);
+        m_Frame.Write(k_Magic);
+        m_Frame.WriteVarint(k_Version);
+        m_Frame.Write(session.runSeed);
+        m_Frame.WriteVarint(static_cast<std::uint64_t>(cacheCapacity));
+        m_Frame.WriteString(session.simulation);
+        m_Frame.WriteString(session.model);
+        EndFrame(m_Frame);
+        if (!SendAll(workerSocket, m_Frame.GetBytes()))
+        {
+            CloseSocket(workerSocket);
+            continue;
+        }
+
+        Worker& worker = m_Workers.emplace_back();
+        worker.socket = workerSocket;
+        worker.threads = threads;
+        worker.genomes.SetCapacity(cacheCapacity);
+    }
+    return true;
+}
+
+void RemoteEvaluator::Close()
+{
+    for (Worker& worker : m_Workers)
+    {
+        if (worker.socket >= 0)
+            CloseSocket(worker.socket);
+    }
+    m_Workers.clear();
+    m_SentJobs.clear();
+    m_Retries.clear();
+
+    if (m_ListenSocket >= 0)
+    {
+        CloseSocket(m_ListenSocket);
+        m_ListenSocket = -1;
+    }
+#if !defined(_WIN32)
+    if (!m_UnixPath.empty())
+        unlink(m_UnixPath.c_str());
+#endif
+    m_UnixPath.clear();
+}
+
+void RemoteEvaluator::Evaluate(std::vector<EvaluationJob>& jobs)
+{
+    PerfScope perfScope("RemoteEvaluator::Evaluate");
+
+    std::size_t nextJob = 0;
+    Run([&]() -> EvaluationJob*
+    {
+        return nextJob < jobs.size() ? &jobs[nextJob++] : nullptr;
+    }, [](EvaluationJob&) {});
+}
+
+void RemoteEvaluator::EvaluateAsync(Model& model, int jobsCount)
+{
+    PerfScope perfScope("RemoteEvaluator::EvaluateAsync");
+
+    // Jobs in flight keep their address, finished ones are acquired again
+    std::vector<std::unique_ptr<EvaluationJob>> freeJobs;
+    std::vector<std::unique_ptr<EvaluationJob>> sentJobs;
+    int acquiredJobs = 0;
+    Run([&]() -> EvaluationJob*
+    {
+        if (acquiredJobs >= jobsCount)
+            return nullptr;
+
+        if (freeJobs.empty())
+            freeJobs.push_back(std::make_unique<EvaluationJob>());
+        if (!model.AcquireJob(*freeJobs.back()))
+            return nullptr;
+
+        acquiredJobs++;
+        sentJobs.push_back(std::move(freeJobs.back()));
+        freeJobs.pop_back();
+        return sentJobs.back().get();
+    }, [&](EvaluationJob& job)
+    {
+        model.CompleteJob(job);
+
+        auto it = std::find_if(sentJobs.begin(), sentJobs.end(), [&](const std::unique_ptr<EvaluationJob>& sentJob) { return sentJob.get() == &job; });
+        freeJobs.push_back(std::move(*it));
+        *it = std::move(sentJobs.back());
+        sentJobs.pop_back();
+    });
+}
+
+int RemoteEvaluator::GetWorkersCount() const
+{
+    return static_cast<int>(std::count_if(m_Workers.begin(), m_Workers.end(), [](const Worker& worker) { return worker.socket >= 0; }));
+}
+
+void RemoteEvaluator::Run(const std::function<EvaluationJob*()>& acquire, const std::function<void(EvaluationJob&)>& complete)
+{
+    std::vector<int> sockets;
+    std::vector<int> socketWorkers;
+    std::vector<int> readable;
+    while (true)
+    {
+        for (int workerIndex = 0; workerIndex < static_cast<int>(m_Workers.size()); ++workerIndex)
+        {
+            while (m_Workers[workerIndex].socket >= 0 && static_cast<int>(m_Workers[workerIndex].frames.size()) < k_FramesInFlight)
+            {
+                bool sent = false;
+                if (!SendFrame(workerIndex, acquire, complete, sent))
+                    DropWorker(workerIndex);
+                else if (!sent)
+                    break;
+            }
+        }
+
+        // With no worker left, the jobs get the results of a network that failed to build
+        if (GetWorkersCount() == 0)
+        {
+            for (const Retry& retry : m_Retries)
+            {
+                retry.job->results.assign(retry.job->evaluationSeeds.size(), 0.0f);
+                complete(*retry.job);
+            }
+            m_Retries.clear();
+            while (EvaluationJob* job = acquire())
+            {
+                job->results.assign(job->evaluationSeeds.size(), 0.0f);
+                complete(*job);
+            }
+            return;
+        }
+
+        if (m_SentJobs.empty())
+            return;
+
+        sockets.clear();
+        socketWorkers.clear();
+        for (int workerIndex = 0; workerIndex < static_cast<int>(m_Workers.size()); ++workerIndex)
+        {
+            if (m_Workers[workerIndex].socket >= 0 && !m_Workers[workerIndex].frames.empty())
+            {
+                sockets.push_back(m_Workers[workerIndex].socket);
+                socketWorkers.push_back(workerIndex);
+            }
+        }
+
+        // Failing to wait at all leaves no way to reach the workers
+        if (!WaitReadable(sockets, readable))
+        {
+            for (int workerIndex : socketWorkers)
+            {
+                DropWorker(workerIndex);
+            }
+            continue;
+        }
+
+        for (int socketIndex : readable)
+        {
+            if (!ReceiveFrame(socketWorkers[socketIndex], complete))
+                DropWorker(socketWorkers[socketIndex]);
+        }
+    }
+}
+
+bool RemoteEvaluator::SendFrame(int workerIndex, const std::function<EvaluationJob*()>& acquire, const std::function<void(EvaluationJob&)>& complete, bool& sent)
+{
+    Worker& worker = m_Workers[workerIndex];
+    const int frameJobs = worker.threads * k_JobsPerThread;
+
+    // Jobs to send again first, they are the oldest
+    m_FrameJobs.clear();
+    while (static_cast<int>(m_FrameJobs.size()) < frameJobs)
+    {
+        if (!m_Retries.empty())
+        {
+            m_FrameJobs.push_back(m_Retries.front());
+            m_Retries.pop_front();
+            continue;
+        }
+
+        EvaluationJob* job = acquire();
+        if (job == nullptr)
+            break;
+
+        if (!job->describeGenome)
+        {
+            job->results.assign(job->evaluationSeeds.size(), 0.0f);
+            complete(*job);
+            continue;
+        }
+        m_FrameJobs.push_back({ job, false });
+    }
+
+    sent = !m_FrameJobs.empty();
+    if (!sent)
+        return true;
+
+    BeginFrame(m_Frame);
+    m_Frame.WriteVarint(m_FrameJobs.size());
+    worker.frames.emplace_back(m_NextJobId, m_FrameJobs.size());
+    for (const Retry& frameJob : m_FrameJobs)
+    {
+        const std::uint64_t jobId = m_NextJobId++;
+        m_Frame.WriteVarint(jobId);
+
+        std::uint64_t key = 0;
+        WriteGenome(worker, *frameJob.job, frameJob.full, key);
+
+        m_Frame.WriteVarint(frameJob.job->evaluationSeeds.size());
+        for (std::uint64_t evaluationSeed : frameJob.job->evaluationSeeds)
+        {
+            m_Frame.Write(evaluationSeed);
+        }
+
+        m_SentJobs[jobId] = { frameJob.job, workerIndex, key };
+    }
+    EndFrame(m_Frame);
+
+    m_Stats.jobs += m_FrameJobs.size();
+    m_Stats.bytesSent += m_Frame.GetBytes().size();
+    return SendAll(worker.socket, m_Frame.GetBytes());
+}
+
+void RemoteEvaluator::WriteGenome(Worker& worker, EvaluationJob& job, bool full, std::uint64_t& key)
+{
+    m_Description.parentKeys = { 0, 0 };
+    m_Description.breedSeed = 0;
+    job.describeGenome(m_Description, false);
+    key = m_Description.key;
+
+    if (!full && worker.genomes.Find(key) != nullptr)
+    {
+        m_Frame.Write(GenomeKind::Cached);
+        m_Frame.Write(key);
+        m_Stats.cachedGenomes++;
+        return;
+    }
+
+    const std::array<std::uint64_t, 2>& parentKeys = m_Description.parentKeys;
+    const bool hasParents = parentKeys[0] != 0 && worker.genomes.Find(parentKeys[0]) != nullptr && (parentKeys[1] == 0 || worker.genomes.Find(parentKeys[1]) != nullptr);
+    if (!full && hasParents)
+    {
+        m_Frame.Write(GenomeKind::Bred);
+        m_Frame.Write(key);
+        m_Frame.Write(parentKeys[0]);
+        m_Frame.Write(parentKeys[1]);
+        m_Frame.Write(m_Description.breedSeed);
+        m_Stats.bredGenomes++;
+    }
+    else
+    {
+        if (m_Description.bytes.GetBytes().empty())
+            job.describeGenome(m_Description, true);
+
+        const std::vector<std::uint8_t>& bytes = m_Description.bytes.GetBytes();
+        m_Frame.Write(GenomeKind::Full);
+        m_Frame.Write(key);
+        m_Frame.WriteVarint(bytes.size());
+        m_Frame.WriteBytes(bytes.data(), bytes.size());
+        m_Stats.fullGenomes++;
+    }
+
+    // The worker keeps it from now on, in the same order
+    worker.genomes.Insert(key, true);
+}
+
+bool RemoteEvaluator::ReceiveFrame(int workerIndex, const std::function<void(EvaluationJob&)>& complete)
+{
+    Worker& worker = m_Workers[workerIndex];
+    if (!ReceiveFrameBytes(worker.socket, m_Received))
+        return false;
+
+    m_Stats.bytesReceived += sizeof(std::uint32_t) + m_Received.size();
+
+    // Frames are answered in order, each reply names every job of its frame once
+    ByteReader reader(m_Received);
+    std::uint64_t count = 0;
+    if (worker.frames.empty() || !reader.ReadVarint(count))
+        return false;
+
+    const auto [firstJobId, frameJobs] = worker.frames.front();
+    worker.frames.pop_front();
+    if (count != frameJobs)
+        return false;
+
+    for (std::uint64_t i = 0; i < count; ++i)
+    {
+        std::uint64_t jobId = 0;
+        JobStatus status = JobStatus::Played;
+        if (!reader.ReadVarint(jobId) || !reader.Read(status))
+            return false;
+
+        auto it = m_SentJobs.find(jobId);
+        if (jobId - firstJobId >= frameJobs || it == m_SentJobs.end() || it->second.worker != workerIndex)
+            return false;
+
+        const SentJob sentJob = it->second;
+        if (status == JobStatus::Missing)
+        {
+            worker.genomes.Erase(sentJob.key);
+            m_Retries.push_back({ sentJob.job, true });
+            m_SentJobs.erase(it);
+            continue;
+        }
+
+        std::uint64_t resultsCount = 0;
+        if (status != JobStatus::Played || !reader.ReadVarint(resultsCount) || resultsCount != sentJob.job->evaluationSeeds.size() || resultsCount > reader.GetRemaining() / sizeof(float))
+            return false;
+
+        sentJob.job->results.resize(static_cast<std::size_t>(resultsCount));
+        if (!reader.ReadBytes(sentJob.job->results.data(), sentJob.job->results.size() * sizeof(float)))
+            return false;
+
+        m_SentJobs.erase(it);
+        complete(*sentJob.job);
+    }
+    return true;
+}
+
+void RemoteEvaluator::DropWorker(int workerIndex)
+{
+    Worker& worker = m_Workers[workerIndex];
+    CloseSocket(worker.socket);
+    worker.socket = -1;
+    worker.frames.clear();
+
+    // Its jobs go to the others, in the order they were sent
+    std::vector<std::pair<std::uint64_t, EvaluationJob*>> lostJobs;
+    for (auto it = m_SentJobs.begin(); it != m_SentJobs.end();)
+    {
+        if (it->second.worker == workerIndex)
+        {
+            lostJobs.emplace_back(it->first, it->second.job);
+            it = m_SentJobs.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    std::sort(lostJobs.begin(), lostJobs.end());
+    for (const auto& [jobId, job] : lostJobs)
+    {
+        m_Retries.push_back({ job, false });
+    }
+}
+
+RemoteWorker::~RemoteWorker()
+{
+    if (m_Socket >= 0)
+        CloseSocket(m_Socket);
+}
+
+bool RemoteWorker::Connect(const std::string& address, int threads, RemoteSession& session)
+{
+    for (int attempt = 0; attempt < k_ConnectAttempts && m_Socket < 0; ++attempt)
+    {
+        m_Socket = ConnectOnce(address);
+        if (m_Socket < 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    if (m_Socket < 0)
+        return false;
+
+    ByteWriter hello;
+    BeginFrame(hello);
+    hello.Write(k_Magic);
+    hello.WriteVarint(k_Version);
+    hello.WriteVarint(static_cast<std::uint64_t>(std::clamp(threads, 1, k_MaxWorkerThreads)));
+    EndFrame(hello);
+
+    std::vector<std::uint8_t> frame;
+    if (!SendAll(m_Socket, hello.GetBytes()) || !ReceiveFrameBytes(m_Socket, frame))
+        return false;
+
+    ByteReader reader(frame);
+    std::uint32_t magic = 0;
+    std::uint64_t version = 0;
+    reader.Read(magic);
+    reader.ReadVarint(version);
+    reader.Read(session.runSeed);
+    reader.ReadVarint(session.cacheCapacity, std::numeric_limits<int>::max());
+    reader.ReadString(session.simulation);
+    reader.ReadString(session.model);
+    if (reader.HasFailed() || magic != k_Magic || version != k_Version)
+        return false;
+
+    m_Genomes.SetCapacity(session.cacheCapacity);
+    return true;
+}
+
+bool RemoteWorker::Run(const Model& model, const ISimulation& simulation, TaskScheduler* taskScheduler)
+{
+    BatchEvaluator batchEvaluator(taskScheduler, simulation);
+    std::vector<std::uint8_t> frame;
+    std::vector<EvaluationJob> jobs;
+    std::vector<std::uint64_t> jobIds;
+    std::vector<std::uint64_t> missingJobIds;
+    ByteWriter reply;
+    while (true)
+    {
+        // A hang up between frames is the coordinator being done
+        if (!ReceiveFrameBytes(m_Socket, frame))
+            return true;
+
+        ByteReader reader(frame);
+        std::uint64_t count = 0;
+        if (!reader.ReadVarint(count) || count > reader.GetRemaining())
+            return false;
+
+        jobs.clear();
+        jobIds.clear();
+        missingJobIds.clear();
+        for (std::uint64_t i = 0; i < count; ++i)
+        {
+            std::uint64_t jobId = 0;
+            std::shared_ptr<RemoteGenome> genome;
+            bool missing = false;
+            std::uint64_t seedsCount = 0;
+            if (!reader.ReadVarint(jobId) || !ResolveGenome(model, reader, genome, missing))
+                return false;
+            if (!reader.ReadVarint(seedsCount) || seedsCount > reader.GetRemaining() / sizeof(std::uint64_t))
+                return false;
+
+            std::vector<std::uint64_t> evaluationSeeds(static_cast<std::size_t>(seedsCount));
+            reader.ReadBytes(evaluationSeeds.data(), evaluationSeeds.size() * sizeof(std::uint64_t));
+            if (missing)
+            {
+                missingJobIds.push_back(jobId);
+                continue;
+            }
+
+            // A genome that failed to rebuild plays as a network that failed to build
+            EvaluationJob& job = jobs.emplace_back();
+            if (genome != nullptr)
+            {
+                job.makeNeuralNetwork = [genome](std::shared_ptr<NeuralNetwork>& neuralNetwork)
+                {
+                    return genome->MakeNeuralNetwork(neuralNetwork);
+                };
+            }
+            job.evaluationSeeds = std::move(evaluationSeeds);
+            jobIds.push_back(jobId);
+        }
+        if (reader.HasFailed())
+            return false;
+
+        batchEvaluator.Evaluate(jobs);
+
+        BeginFrame(reply);
+        reply.WriteVarint(jobs.size() + missingJobIds.size());
+        for (std::size_t i = 0; i < jobs.size(); ++i)
+        {
+            reply.WriteVarint(jobIds[i]);
+            reply.Write(JobStatus::Played);
+            reply.WriteVarint(jobs[i].results.size());
+            reply.WriteBytes(jobs[i].results.data(), jobs[i].results.size() * sizeof(float));
+        }
+        for (std::uint64_t jobId : missingJobIds)
+        {
+            reply.WriteVarint(jobId);
+            reply.Write(JobStatus::Missing);
+        }
+        EndFrame(reply);
+
+        if (!SendAll(m_Socket, reply.GetBytes()))
+            return true;
+    }
+}
+
+bool RemoteWorker::ResolveGenome(const Model& model, ByteReader& reader, std::shared_ptr<RemoteGenome>& genome, bool& missing)
+{
+    GenomeKind kind = GenomeKind::Cached;
+    std::uint64_t key = 0;
+    if (!reader.Read(kind) || !reader.Read(key))
+        return false;
+
+    switch (kind)
+    {
+    case GenomeKind::Cached:
+    {
+        const std::shared_ptr<RemoteGenome>* cachedGenome = m_Genomes.Find(key);
+        missing = cachedGenome == nullptr;
+        if (cachedGenome != nullptr)
+            genome = *cachedGenome;
+        return true;
+    }
+    case GenomeKind::Full:
+    {
+        std::uint64_t size = 0;
+        if (!reader.ReadVarint(size) || size > reader.GetRemaining())
+            return false;
+
+        std::vector<std::uint8_t> bytes(static_cast<std::size_t>(size));
+        reader.ReadBytes(bytes.data(), bytes.size());
+
+        // A genome whose bytes don't match its key is not kept, its jobs score 0
+        ByteReader genomeReader(bytes);
+        genome = model.ReadRemoteGenome(genomeReader);
+        if (genome != nullptr && genome->GetKey() == key)
+            m_Genomes.Insert(key, genome);
+        else
+            genome.reset();
+        return true;
+    }
+    case GenomeKind::Bred:
+    {
+        std::uint64_t parentKeys[2]{ 0, 0 };
+        std::uint64_t breedSeed = 0;
+        if (!reader.Read(parentKeys[0]) || !reader.Read(parentKeys[1]) || !reader.Read(breedSeed))
+            return false;
+
+        const std::shared_ptr<RemoteGenome>* parent1 = m_Genomes.Find(parentKeys[0]);
+        const std::shared_ptr<RemoteGenome>* parent2 = parentKeys[1] != 0 ? m_Genomes.Find(parentKeys[1]) : nullptr;
+        if (parent1 != nullptr && (parentKeys[1] == 0 || parent2 != nullptr))
+            genome = model.BreedRemoteGenome(**parent1, parent2 != nullptr ? parent2->get() : nullptr, breedSeed);
+
+        // The coordinator sends the bytes when the child can't be bred the same here
+        missing = genome == nullptr || genome->GetKey() != key;
+        if (missing)
+            genome.reset();
+        else
+            m_Genomes.Insert(key, genome);
+        return true;
+    }
+    }
+    return false;
+}
+
+} // namespace BrainFramework
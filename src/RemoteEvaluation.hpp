@@ -0,0 +1,180 @@
+#pragma once
+
+#include "BatchEvaluator.hpp"
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+namespace BrainFramework
+{
+
+// What a worker process needs to play the jobs of a coordinator, sent as soon as it connects
+struct RemoteSession
+{
+    std::string simulation; // Names the worker builds its simulation and model from
+    std::string model;
+    std::uint64_t runSeed{ 0 }; // Episode seeds derive from it, so a worker plays the episodes the coordinator would
+    int cacheCapacity{ 0 }; // Genomes each worker keeps
+};
+
+// Genomes a worker keeps by key, the oldest one is forgotten first
+// The coordinator keeps a cache of keys in step with the cache of every worker, so it knows what a worker holds without asking
+template <typename T>
+class RemoteGenomeCache
+{
+public:
+    explicit RemoteGenomeCache(int capacity = 0) : m_Capacity(capacity) {}
+
+    void SetCapacity(int capacity) { m_Capacity = capacity; }
+
+    const T* Find(std::uint64_t key) const
+    {
+        auto it = m_Values.find(key);
+        return it != m_Values.end() ? &it->second.value : nullptr;
+    }
+
+    void Insert(std::uint64_t key, T value)
+    {
+        Entry& entry = m_Values[key];
+        entry.value = std::move(value);
+        entry.serial = ++m_Serial;
+        m_Order.emplace_back(key, entry.serial);
+
+        // Entries erased or inserted again leave stale ones in the order, skipped here
+        while (static_cast<int>(m_Values.size()) > m_Capacity && !m_Order.empty())
+        {
+            const auto [oldKey, serial] = m_Order.front();
+            m_Order.pop_front();
+            auto it = m_Values.find(oldKey);
+            if (it != m_Values.end() && it->second.serial == serial)
+                m_Values.erase(it);
+        }
+    }
+
+    void Erase(std::uint64_t key) { m_Values.erase(key); }
+
+private:
+    struct Entry
+    {
+        T value{};
+        std::uint64_t serial{ 0 };
+    };
+
+    std::unordered_map<std::uint64_t, Entry> m_Values;
+    std::deque<std::pair<std::uint64_t, std::uint64_t>> m_Order; // Key and serial, oldest first
+    std::uint64_t m_Serial{ 0 };
+    int m_Capacity{ 0 };
+};
+
+// Statistics of a RemoteEvaluator, genomes counted once per job sent
+struct RemoteStats
+{
+    std::uint64_t bytesSent{ 0 };
+    std::uint64_t bytesReceived{ 0 };
+    std::uint64_t fullGenomes{ 0 }; // Sent as bytes
+    std::uint64_t bredGenomes{ 0 }; // Sent as parents and a seed
+    std::uint64_t cachedGenomes{ 0 }; // Sent as a key the worker already held
+    std::uint64_t jobs{ 0 };
+};
+
+// Coordinator side of remote evaluation: the model stays here, its jobs are played by worker processes
+// Workers connect over a local socket (unix:PATH) or TCP (HOST:PORT), and receive jobs in frames, a few frames ahead of their results
+// There is no authentication, an empty host listens on loopback only, 0.0.0.0:PORT opens the port to every machine that can reach it
+// A genome is shipped once per worker, as its compact bytes or as its parents and breeding seed, later jobs only name its key
+// Everything runs on the calling thread, the model is never called concurrently
+class RemoteEvaluator
+{
+public:
+    RemoteEvaluator() = default;
+    ~RemoteEvaluator();
+    RemoteEvaluator(const RemoteEvaluator&) = delete;
+    RemoteEvaluator& operator=(const RemoteEvaluator&) = delete;
+
+    // Workers may connect as soon as Listen returned, Accept waits until workersCount of them did
+    bool Listen(const std::string& address);
+    bool Accept(int workersCount, const RemoteSession& session);
+    // Hangs up on every worker, which then exit
+    void Close();
+
+    // Same contracts as BatchEvaluator, a job no worker could play scores 0 on every episode as a network that failed to build does
+    // A worker replying with other jobs than it was sent, or with a result count other than the seed count, is dropped
+    // Jobs of models that don't describe their genomes are not played either
+    void Evaluate(std::vector<EvaluationJob>& jobs);
+    void EvaluateAsync(Model& model, int jobsCount);
+
+    // Workers still connected, a worker that failed is dropped and its jobs go to the others
+    int GetWorkersCount() const;
+    const RemoteStats& GetStats() const { return m_Stats; }
+
+private:
+    struct Worker
+    {
+        int socket{ -1 };
+        int threads{ 1 };
+        std::deque<std::pair<std::uint64_t, std::uint64_t>> frames; // First job id and jobs count of the frames in flight, oldest first
+        RemoteGenomeCache<bool> genomes; // Mirror of the worker cache
+    };
+
+    struct SentJob
+    {
+        EvaluationJob* job{ nullptr };
+        int worker{ -1 };
+        std::uint64_t key{ 0 };
+    };
+
+    struct Retry
+    {
+        EvaluationJob* job{ nullptr };
+        bool full{ false }; // The worker missed the genome it was supposed to hold, its bytes go along this time
+    };
+
+    // Sends what acquire hands out until every worker has its frames in flight, completes jobs as results come back
+    void Run(const std::function<EvaluationJob*()>& acquire, const std::function<void(EvaluationJob&)>& complete);
+    // False when the worker is gone, sent tells whether there was anything to send
+    bool SendFrame(int workerIndex, const std::function<EvaluationJob*()>& acquire, const std::function<void(EvaluationJob&)>& complete, bool& sent);
+    void WriteGenome(Worker& worker, EvaluationJob& job, bool full, std::uint64_t& key);
+    bool ReceiveFrame(int workerIndex, const std::function<void(EvaluationJob&)>& complete);
+    void DropWorker(int workerIndex);
+
+    static constexpr int k_FramesInFlight = 2; // One played while the next one travels
+    static constexpr int k_JobsPerThread = 2; // Jobs of a frame per worker thread
+
+    std::vector<Worker> m_Workers;
+    std::unordered_map<std::uint64_t, SentJob> m_SentJobs; // By job id
+    std::deque<Retry> m_Retries; // Jobs of dropped workers and jobs whose genome a worker missed, sent before new ones
+    std::vector<Retry> m_FrameJobs;
+    std::uint64_t m_NextJobId{ 0 };
+    int m_ListenSocket{ -1 };
+    std::string m_UnixPath; // Removed on Close
+    GenomeDescription m_Description;
+    ByteWriter m_Frame;
+    std::vector<std::uint8_t> m_Received;
+    RemoteStats m_Stats;
+};
+
+// Worker side of remote evaluation, plays the jobs of one coordinator until it hangs up
+class RemoteWorker
+{
+public:
+    RemoteWorker() = default;
+    ~RemoteWorker();
+    RemoteWorker(const RemoteWorker&) = delete;
+    RemoteWorker& operator=(const RemoteWorker&) = delete;
+
+    // Connects and reads the session, with which the caller builds the model and the simulation
+    bool Connect(const std::string& address, int threads, RemoteSession& session);
+
+    // The model is only used to rebuild genomes, the jobs run through a BatchEvaluator on the scheduler
+    // Returns true once the coordinator hung up, false on a broken frame
+    bool Run(const Model& model, const ISimulation& simulation, TaskScheduler* taskScheduler);
+
+private:
+    // False on a broken frame, missing when the worker lacks the genome or its parents
+    bool ResolveGenome(const Model& model, ByteReader& reader, std::shared_ptr<RemoteGenome>& genome, bool& missing);
+
+    int m_Socket{ -1 };
+    RemoteGenomeCache<std::shared_ptr<RemoteGenome>> m_Genomes;
+};
+
+} // namespace BrainFramework
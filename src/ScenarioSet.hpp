@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Utils.hpp"
+
+namespace BrainFramework
+{
+
+// Episode seeds drawn once per generation and shared by every genome, so genomes are compared on the same scenarios
+// With common random numbers the luck of the draw cancels out of the differences between genomes
+class ScenarioSet
+{
+public:
+    void Draw(std::uint64_t generationSeed, int count)
+    {
+        const std::uint64_t scenariosSeed = DeriveSeed(generationSeed, k_ScenariosNode);
+        m_Seeds.resize(std::max(count, 0));
+        for (int i = 0; i < static_cast<int>(m_Seeds.size()); ++i)
+        {
+            m_Seeds[i] = DeriveSeed(scenariosSeed, i);
+        }
+    }
+
+    int GetCount() const { return static_cast<int>(m_Seeds.size()); }
+
+    // Evaluation seed of the scenario, the simulation draws the whole episode from it
+    std::uint64_t GetSeed(int scenario) const { return m_Seeds[scenario]; }
+    std::span<const std::uint64_t> GetSeeds() const { return m_Seeds; }
+
+private:
+    // Node of the generation seed tree the scenarios hang from, away from the genome nodes
+    static constexpr std::uint64_t k_ScenariosNode = ~0ull;
+
+    std::vector<std::uint64_t> m_Seeds;
+};
+
+} // namespace BrainFramework
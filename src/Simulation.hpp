@@ -2,6 +2,8 @@
 
 #include "NeuralNetwork.hpp"
 #include "AgentInterface.hpp"
+#include "VectorSimulation.hpp"
+#include "CoroutineAgent.hpp"
 
 namespace BrainFramework
 {
@@ -30,11 +32,27 @@ class ISimulation
 {
 public:
     ISimulation(const AgentCountSettings& agentCountSettings) : m_AgentCountSettings(agentCountSettings) {}
+    virtual ~ISimulation() = default;
     ISimulation(const ISimulation&) = delete;
     ISimulation& operator=(const ISimulation&) = delete;
 
     virtual const char* GetName() const = 0;
 
+    // Independent instance in its initial state, with no agents and a random stream of its own
+    // Episodes run on different instances share nothing and can run concurrently
+    virtual std::unique_ptr<ISimulation> Clone() const = 0;
+
+    // True when the agents of one episode act on common state (a deck they all draw from...)
+    // Their steps must then stay sequential, otherwise each agent could run on its own thread
+    virtual bool HasSharedAgentState() const = 0;
+
+    // Same game played by single agents on many lanes at once, nullptr when the simulation has no such version
+    virtual std::unique_ptr<VectorSimulation> CreateVectorSimulation(int /*lanes*/) const { return nullptr; }
+
+    // Whole episode of a single agent as a coroutine, for a CoroutineScheduler to interleave with many others
+    // It must only touch the agent and its own locals, an empty task when the simulation has no such episode
+    virtual EpisodeTask PlayEpisode(CoroutineAgent& /*agent*/) const { return {}; }
+
     virtual void Initialize() {}
     virtual bool IsFinished() const = 0;
 
@@ -47,8 +65,15 @@ public:
 
     const AgentCountSettings& GetAgentCountSettings() const { return m_AgentCountSettings; }
 
+protected:
+    // Called by Initialize, the episode stream is drawn from the calling thread stream so the episode seed decides it
+    // Steps then use GetRandom only, whatever thread runs them and whatever runs in between
+    void SeedRandom() { m_Random.Reset(Random::GetThreadStream().NextUInt64(), 0); }
+    RandomStream& GetRandom() { return m_Random; }
+
 private:
     AgentCountSettings m_AgentCountSettings;
+    RandomStream m_Random;
 };
 
 template <typename BaseAgentType>
@@ -67,28 +92,99 @@ public:
         return nullptr;
     }
 
+    // Agent types with a Rebind taking the constructor arguments are pooled: a removed agent is kept
+    // and handed out again, rebound, to the next agent of its type, its Initialize then resets it
     template <typename AgentType, typename ... AgentArgs>
     BaseAgentType* CreateAgent(AgentArgs&& ... args)
     {
-        m_Agents.emplace_back(std::make_unique<AgentType>(std::forward<AgentArgs>(args)...));
-        return m_Agents.back().get();
+        if constexpr (requires(AgentType& agent) { agent.Rebind(args...); })
+        {
+            const std::size_t pool = GetPoolIndex<AgentType>();
+            if (pool < m_FreeSlots.size() && !m_FreeSlots[pool].empty())
+            {
+                const int slot = m_FreeSlots[pool].back();
+                m_FreeSlots[pool].pop_back();
+                m_Slots[slot].used = true;
+
+                AgentType* agent = static_cast<AgentType*>(m_Slots[slot].agent.get());
+                agent->Rebind(std::forward<AgentArgs>(args)...);
+                return agent;
+            }
+            return AddAgent(std::make_unique<AgentType>(std::forward<AgentArgs>(args)...), pool);
+        }
+        else
+        {
+            return AddAgent(std::make_unique<AgentType>(std::forward<AgentArgs>(args)...), k_NoPool);
+        }
     }
 
+    // O(1), the agent knows its slot
     void RemoveAgent(AgentInterface* agent) override
     {
-        m_Agents.erase(
-            std::remove_if(m_Agents.begin(), m_Agents.end(),
-                [agent](const std::unique_ptr<BaseAgentType>& ptr)
-                {
-                    return static_cast<AgentInterface*>(ptr.get()) == agent;
-                }
-            ),
-            m_Agents.end()
-        );
+        const int slot = agent != nullptr ? agent->m_Slot : -1;
+        if (slot < 0 || slot >= static_cast<int>(m_Slots.size()) || !m_Slots[slot].used || static_cast<AgentInterface*>(m_Slots[slot].agent.get()) != agent)
+            return;
+
+        Slot& removed = m_Slots[slot];
+        removed.used = false;
+        if (removed.pool == k_NoPool)
+        {
+            removed.agent.reset();
+            m_EmptySlots.push_back(slot);
+        }
+        else
+        {
+            agent->SetLogger(nullptr);
+            m_FreeSlots[removed.pool].push_back(slot);
+        }
     }
 
 private:
-    std::vector<std::unique_ptr<BaseAgentType>> m_Agents;
+    static constexpr std::size_t k_NoPool = static_cast<std::size_t>(-1);
+
+    struct Slot
+    {
+        std::unique_ptr<BaseAgentType> agent;
+        std::size_t pool{ k_NoPool };
+        bool used{ false };
+    };
+
+    BaseAgentType* AddAgent(std::unique_ptr<BaseAgentType> agent, std::size_t pool)
+    {
+        int slot = static_cast<int>(m_Slots.size());
+        if (!m_EmptySlots.empty())
+        {
+            slot = m_EmptySlots.back();
+            m_EmptySlots.pop_back();
+        }
+        else
+        {
+            m_Slots.emplace_back();
+        }
+
+        if (pool != k_NoPool && pool >= m_FreeSlots.size())
+        {
+            m_FreeSlots.resize(pool + 1);
+        }
+
+        agent->m_Slot = slot;
+        m_Slots[slot] = Slot{ std::move(agent), pool, true };
+        return m_Slots[slot].agent.get();
+    }
+
+    // One pool per agent type, indices shared by every simulation of the same base agent type
+    template <typename AgentType>
+    static std::size_t GetPoolIndex()
+    {
+        static const std::size_t s_Index = ms_PoolsCount.fetch_add(1, std::memory_order_relaxed);
+        return s_Index;
+    }
+
+    static inline std::atomic<std::size_t> ms_PoolsCount{ 0 };
+
+    std::vector<Slot> m_Slots; // Stable, an agent keeps its slot until removed
+    std::vector<int> m_EmptySlots; // Slots of destroyed agents
+    std::vector<std::vector<int>> m_FreeSlots; // Slots of pooled agents waiting for reuse, per pool
 };
 
 } // namespace BrainFramework
@@ -0,0 +1,146 @@
+#include "SteadyStatePopulation.hpp"
+
+namespace BrainFramework
+{
+
+void SteadyStatePopulation::Start(int slots, std::uint64_t seed, const Settings& settings)
+{
+    m_Settings = settings;
+    m_Settings.jobEpisodes = std::max(m_Settings.jobEpisodes, 1);
+    m_Settings.maturity = std::max(m_Settings.maturity, 1);
+    m_Settings.tournamentSize = std::max(m_Settings.tournamentSize, 1);
+
+    m_Slots = std::vector<Slot>(std::max(slots, 0));
+    m_JobsSeed = DeriveSeed(seed, k_JobsNode);
+    m_BirthsSeed = DeriveSeed(seed, k_BirthsNode);
+
+    m_Cursor.store(0, std::memory_order_relaxed);
+    m_NextTicket.store(0, std::memory_order_relaxed);
+    m_Completions.store(0, std::memory_order_relaxed);
+}
+
+void SteadyStatePopulation::SetScore(int slot, float averageScore, int lifetime)
+{
+    m_Slots[slot].averageScore.store(averageScore, std::memory_order_relaxed);
+    m_Slots[slot].lifetime.store(lifetime, std::memory_order_relaxed);
+}
+
+int SteadyStatePopulation::AcquireEvaluation(std::uint64_t& ticket)
+{
+    const int count = GetSlotsCount();
+    for (int attempt = 0; attempt < count; ++attempt)
+    {
+        const int slot = static_cast<int>(m_Cursor.fetch_add(1, std::memory_order_relaxed) % count);
+        if (TryAcquireWrite(slot))
+        {
+            ticket = m_NextTicket.fetch_add(1, std::memory_order_relaxed);
+            return slot;
+        }
+    }
+    return -1;
+}
+
+std::uint64_t SteadyStatePopulation::CompleteEvaluation(int slot, float averageScore, int lifetime)
+{
+    SetScore(slot, averageScore, lifetime);
+    ReleaseWrite(slot);
+    return m_Completions.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool SteadyStatePopulation::IsBirth(std::uint64_t completion) const
+{
+    const double birthsPerJob = std::clamp(static_cast<double>(m_Settings.birthsPerJob), 0.0, 1.0);
+    return static_cast<std::uint64_t>((completion + 1) * birthsPerJob) > static_cast<std::uint64_t>(completion * birthsPerJob);
+}
+
+void SteadyStatePopulation::DrawTournament(bool forWrite, std::vector<int>& entrants) const
+{
+    // A write claim needs the slot unclaimed, a read claim only needs no writer
+    const std::uint32_t blockingClaims = forWrite ? ~0u : k_Write;
+
+    entrants.clear();
+    const int count = GetSlotsCount();
+    for (int draw = 0; draw < m_Settings.tournamentSize * k_DrawsPerEntrant && static_cast<int>(entrants.size()) < m_Settings.tournamentSize; ++draw)
+    {
+        const int slot = RandomInt(0, count - 1);
+        if (IsMature(slot) && (m_Slots[slot].claims.load(std::memory_order_relaxed) & blockingClaims) == 0 && std::find(entrants.begin(), entrants.end(), slot) == entrants.end())
+            entrants.push_back(slot);
+    }
+}
+
+int SteadyStatePopulation::AcquireVictim()
+{
+    thread_local std::vector<int> entrants;
+    DrawTournament(true, entrants);
+    if (entrants.size() < 2)
+        return -1;
+
+    int victim = entrants[0];
+    for (int slot : entrants)
+    {
+        if (GetAverageScore(slot) < GetAverageScore(victim))
+            victim = slot;
+    }
+
+    // Lost to another thread since the tournament looked at it, this completion breeds nothing
+    if (!TryAcquireWrite(victim))
+        return -1;
+
+    return victim;
+}
+
+void SteadyStatePopulation::CompleteBirth(int slot)
+{
+    SetScore(slot, 0.0f, 0);
+    ReleaseWrite(slot);
+}
+
+int SteadyStatePopulation::AcquireParent()
+{
+    thread_local std::vector<int> entrants;
+    DrawTournament(false, entrants);
+    if (entrants.empty())
+        return -1;
+
+    int parent = entrants[0];
+    for (int slot : entrants)
+    {
+        if (GetAverageScore(slot) > GetAverageScore(parent))
+            parent = slot;
+    }
+
+    if (!TryAcquireRead(parent))
+        return -1;
+
+    return parent;
+}
+
+bool SteadyStatePopulation::TryAcquireRead(int slot)
+{
+    std::atomic<std::uint32_t>& claims = m_Slots[slot].claims;
+    std::uint32_t expected = claims.load(std::memory_order_relaxed);
+    while ((expected & k_Write) == 0)
+    {
+        if (claims.compare_exchange_weak(expected, expected + k_Reader, std::memory_order_acquire, std::memory_order_relaxed))
+            return true;
+    }
+    return false;
+}
+
+void SteadyStatePopulation::ReleaseRead(int slot)
+{
+    m_Slots[slot].claims.fetch_sub(k_Reader, std::memory_order_release);
+}
+
+bool SteadyStatePopulation::TryAcquireWrite(int slot)
+{
+    std::uint32_t expected = 0;
+    return m_Slots[slot].claims.compare_exchange_strong(expected, k_Write, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+void SteadyStatePopulation::ReleaseWrite(int slot)
+{
+    m_Slots[slot].claims.store(0, std::memory_order_release);
+}
+
+} // namespace BrainFramework
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Utils.hpp"
+
+#include <atomic>
+
+namespace BrainFramework
+{
+
+// Slots of a population evolved without generations, in the style of rtNEAT
+// Any thread evaluates any free slot, and every completed evaluation lets its thread breed a child over the worst of a tournament
+// Slots are claimed with atomics only, a write claim (evaluation, breeding) is exclusive while any number of breeders may read a parent
+// Selection reads the published scores without claiming anything, so nothing ever waits for a whole population
+class SteadyStatePopulation
+{
+public:
+    struct Settings
+    {
+        int jobEpisodes{ 4 }; // Episodes of one evaluation
+        int maturity{ 2 }; // Evaluations a genome plays before it can be replaced or bred from
+        int tournamentSize{ 4 };
+        float birthsPerJob{ 0.5f }; // Children bred per completed job, in [0, 1]
+    };
+
+    // Every slot starts unevaluated, the seed roots the job and birth seeds
+    void Start(int slots, std::uint64_t seed, const Settings& settings);
+
+    // Score a genome brought from an evaluated population, before any thread uses the slots
+    void SetScore(int slot, float averageScore, int lifetime);
+
+    // Claims the next free slot in turn and gives the ticket the episodes of its job derive from, -1 when every slot is claimed
+    int AcquireEvaluation(std::uint64_t& ticket);
+
+    // Publishes the new score of the genome and frees its slot, returns how many evaluations completed before this one
+    std::uint64_t CompleteEvaluation(int slot, float averageScore, int lifetime);
+
+    // Whether the thread that completed this evaluation breeds a child, spread evenly over the completions
+    bool IsBirth(std::uint64_t completion) const;
+
+    // Worst of a tournament of mature genomes, claimed for the child until CompleteBirth
+    // -1 when the tournament found fewer than two genomes to compare, the best one is never replaced
+    int AcquireVictim();
+    void CompleteBirth(int slot);
+
+    // Best of a tournament of mature genomes, readable until ReleaseRead, -1 when the tournament found none free
+    int AcquireParent();
+
+    bool TryAcquireRead(int slot);
+    void ReleaseRead(int slot);
+    bool TryAcquireWrite(int slot);
+    void ReleaseWrite(int slot);
+
+    std::uint64_t GetJobSeed(std::uint64_t ticket, int episode) const { return DeriveSeed(DeriveSeed(m_JobsSeed, ticket), episode); }
+    std::uint64_t GetBirthSeed(std::uint64_t completion) const { return DeriveSeed(m_BirthsSeed, completion); }
+
+    // Ticket the next AcquireEvaluation hands out, exact as long as a single thread uses the population
+    std::uint64_t GetNextTicket() const { return m_NextTicket.load(std::memory_order_relaxed); }
+
+    // Latest published values, a slot being evaluated still shows its previous score
+    float GetAverageScore(int slot) const { return m_Slots[slot].averageScore.load(std::memory_order_relaxed); }
+    int GetLifetime(int slot) const { return m_Slots[slot].lifetime.load(std::memory_order_relaxed); }
+    bool IsMature(int slot) const { return GetLifetime(slot) >= m_Settings.maturity; }
+
+    const Settings& GetSettings() const { return m_Settings; }
+    int GetSlotsCount() const { return static_cast<int>(m_Slots.size()); }
+    std::uint64_t GetCompletions() const { return m_Completions.load(std::memory_order_relaxed); }
+
+private:
+    // One cache line each, the threads claiming neighbouring slots don't share them
+    struct alignas(64) Slot
+    {
+        std::atomic<std::uint32_t> claims{ 0 }; // Write bit and readers count
+        std::atomic<float> averageScore{ 0.0f };
+        std::atomic<int> lifetime{ 0 };
+    };
+
+    static constexpr std::uint32_t k_Write = 1;
+    static constexpr std::uint32_t k_Reader = 2;
+    static constexpr int k_DrawsPerEntrant = 8; // Slots drawn per tournament entrant, most draws can be immature or claimed
+
+    // Draws free mature slots until the tournament is full or the draws run out
+    void DrawTournament(bool forWrite, std::vector<int>& entrants) const;
+
+    // Nodes of the seed tree the jobs and the births hang from, away from the genome and scenario nodes
+    static constexpr std::uint64_t k_JobsNode = ~1ull;
+    static constexpr std::uint64_t k_BirthsNode = ~2ull;
+
+    Settings m_Settings;
+    std::vector<Slot> m_Slots;
+    std::uint64_t m_JobsSeed{ 0 };
+    std::uint64_t m_BirthsSeed{ 0 };
+
+    alignas(64) std::atomic<std::uint64_t> m_Cursor{ 0 };
+    alignas(64) std::atomic<std::uint64_t> m_NextTicket{ 0 };
+    alignas(64) std::atomic<std::uint64_t> m_Completions{ 0 };
+};
+
+} // namespace BrainFramework
@@ -0,0 +1,375 @@
+#include "TaskScheduler.hpp"
+
+#include <algorithm>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace BrainFramework
+{
+
+namespace
+{
+
+inline void CpuRelax()
+{
+#if defined(_M_X64) || defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// Spins before yielding or parking, roughly a few microseconds
+constexpr int k_SpinsBeforeWait = 4096;
+
+// Backs off to the OS scheduler so an oversubscribed machine still makes progress
+inline void SpinWait(int& spins)
+{
+    if (++spins < k_SpinsBeforeWait)
+    {
+        CpuRelax();
+    }
+    else
+    {
+        std::this_thread::yield();
+    }
+}
+
+thread_local const TaskScheduler* t_Scheduler = nullptr;
+thread_local int t_WorkerIndex = 0;
+thread_local unsigned int t_Victim = 0;
+
+} // namespace
+
+WorkStealingDeque::WorkStealingDeque(int capacity)
+{
+    std::int64_t powerOfTwo = 1;
+    while (powerOfTwo < capacity)
+        powerOfTwo *= 2;
+
+    m_Buffers.push_back(std::make_unique<Buffer>(powerOfTwo));
+    m_Buffer.store(m_Buffers.back().get(), std::memory_order_relaxed);
+}
+
+void WorkStealingDeque::Push(Task* task)
+{
+    const std::int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+    const std::int64_t top = m_Top.load(std::memory_order_acquire);
+    Buffer* buffer = m_Buffer.load(std::memory_order_relaxed);
+
+    if (bottom - top > buffer->capacity - 1)
+    {
+        std::unique_ptr<Buffer> grown = std::make_unique<Buffer>(buffer->capacity * 2);
+        for (std::int64_t i = top; i < bottom; ++i)
+            grown->Put(i, buffer->Get(i));
+        buffer = grown.get();
+        m_Buffers.push_back(std::move(grown));
+        m_Buffer.store(buffer, std::memory_order_release);
+    }
+
+    buffer->Put(bottom, task);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+}
+
+Task* WorkStealingDeque::Take()
+{
+    const std::int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+    Buffer* buffer = m_Buffer.load(std::memory_order_relaxed);
+    m_Bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t top = m_Top.load(std::memory_order_relaxed);
+
+    if (top > bottom)
+    {
+        m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Task* task = buffer->Get(bottom);
+    if (top == bottom)
+    {
+        // Last task, race the thieves for it
+        if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            task = nullptr;
+        m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return task;
+}
+
+Task* WorkStealingDeque::Steal()
+{
+    std::int64_t top = m_Top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const std::int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+    if (top >= bottom)
+        return nullptr;
+
+    Buffer* buffer = m_Buffer.load(std::memory_order_acquire);
+    Task* task = buffer->Get(top);
+    if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;
+    return task;
+}
+
+TaskScheduler::TaskScheduler(int workers, bool pinThreads, int firstCore)
+{
+    if (workers <= 0)
+    {
+        workers = static_cast<int>(std::thread::hardware_concurrency());
+    }
+
+    // Deques exist before any thread starts, workers steal from each other right away
+    for (int i = 1; i < workers; ++i)
+    {
+        m_Deques.push_back(std::make_unique<WorkStealingDeque>());
+    }
+
+    m_Threads.reserve(m_Deques.size());
+    for (int i = 1; i < workers; ++i)
+    {
+        m_Threads.emplace_back(&TaskScheduler::WorkerLoop, this, i, pinThreads ? firstCore + i : -1);
+    }
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    m_Stop.store(true, std::memory_order_seq_cst);
+    m_WakeEpoch.fetch_add(1, std::memory_order_seq_cst);
+    m_WakeEpoch.notify_all();
+    for (std::thread& thread : m_Threads)
+    {
+        thread.join();
+    }
+}
+
+void TaskScheduler::ParallelFor(int begin, int end, int grainSize, const std::function<void(int, int)>& body)
+{
+    grainSize = std::max(grainSize, 1);
+    if (end - begin <= grainSize || m_Threads.empty())
+    {
+        if (begin < end)
+            body(begin, end);
+        return;
+    }
+
+    // Hand out the upper halves and keep splitting the lower one, thieves then take the largest pieces first
+    TaskGroup group(*this);
+    std::function<void(int, int)> split = [&](int rangeBegin, int rangeEnd)
+    {
+        while (rangeEnd - rangeBegin > grainSize)
+        {
+            const int middle = rangeBegin + (rangeEnd - rangeBegin) / 2;
+            group.Run([&split, middle, rangeEnd]() { split(middle, rangeEnd); });
+            rangeEnd = middle;
+        }
+        body(rangeBegin, rangeEnd);
+    };
+
+    split(begin, end);
+    group.Wait();
+}
+
+int TaskScheduler::GetCurrentWorkerIndex() const
+{
+    return t_Scheduler == this ? t_WorkerIndex : 0;
+}
+
+void TaskScheduler::Submit(Task* task)
+{
+    const int workerIndex = GetCurrentWorkerIndex();
+    if (workerIndex > 0)
+    {
+        m_Deques[workerIndex - 1]->Push(task);
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(m_InjectedMutex);
+        m_Injected.push_back(task);
+        m_InjectedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Pairs with the sleeping count increment of WorkerLoop, either it sees the task or we see it sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_Sleeping.load(std::memory_order_relaxed) > 0)
+    {
+        m_WakeEpoch.fetch_add(1, std::memory_order_seq_cst);
+        m_WakeEpoch.notify_one();
+    }
+}
+
+Task* TaskScheduler::FindTask(int workerIndex)
+{
+    if (workerIndex > 0)
+    {
+        if (Task* task = m_Deques[workerIndex - 1]->Take())
+            return task;
+    }
+
+    if (m_InjectedCount.load(std::memory_order_relaxed) > 0)
+    {
+        std::lock_guard<std::mutex> lock(m_InjectedMutex);
+        if (!m_Injected.empty())
+        {
+            Task* task = m_Injected.front();
+            m_Injected.pop_front();
+            m_InjectedCount.fetch_sub(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+
+    // Start from a different victim each time so thieves spread over the deques
+    const int dequesCount = static_cast<int>(m_Deques.size());
+    const int start = static_cast<int>(t_Victim++ % static_cast<unsigned int>(std::max(dequesCount, 1)));
+    for (int i = 0; i < dequesCount; ++i)
+    {
+        const int victim = (start + i) % dequesCount;
+        if (victim == workerIndex - 1)
+            continue;
+        if (Task* task = m_Deques[victim]->Steal())
+            return task;
+    }
+
+    return nullptr;
+}
+
+void TaskScheduler::Execute(Task* task)
+{
+    task->function();
+    TaskGroup* group = task->group;
+    delete task;
+    group->m_Pending.fetch_sub(1, std::memory_order_release);
+}
+
+void TaskScheduler::WorkerLoop(int workerIndex, int pinnedCore)
+{
+    t_Scheduler = this;
+    t_WorkerIndex = workerIndex;
+    t_Victim = static_cast<unsigned int>(workerIndex);
+
+    if (pinnedCore >= 0)
+    {
+        PinCurrentThread(pinnedCore);
+    }
+
+    while (!m_Stop.load(std::memory_order_acquire))
+    {
+        // Spin first as work tends to come in bursts, then park until something is submitted
+        int spins = 0;
+        Task* task = FindTask(workerIndex);
+        while (task == nullptr && spins < k_SpinsBeforeWait && !m_Stop.load(std::memory_order_relaxed))
+        {
+            CpuRelax();
+            spins++;
+            task = FindTask(workerIndex);
+        }
+
+        if (task == nullptr)
+        {
+            const std::uint32_t epoch = m_WakeEpoch.load(std::memory_order_seq_cst);
+            m_Sleeping.fetch_add(1, std::memory_order_seq_cst);
+            task = FindTask(workerIndex);
+            if (task == nullptr && !m_Stop.load(std::memory_order_seq_cst))
+            {
+                m_WakeEpoch.wait(epoch, std::memory_order_seq_cst);
+            }
+            m_Sleeping.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        if (task != nullptr)
+        {
+            Execute(task);
+        }
+    }
+}
+
+void TaskGroup::Run(std::function<void()> function)
+{
+    m_Pending.fetch_add(1, std::memory_order_relaxed);
+    m_Scheduler.Submit(new Task{ std::move(function), this });
+}
+
+void TaskGroup::Wait()
+{
+    const int workerIndex = m_Scheduler.GetCurrentWorkerIndex();
+    int spins = 0;
+    while (m_Pending.load(std::memory_order_acquire) > 0)
+    {
+        if (Task* task = m_Scheduler.FindTask(workerIndex))
+        {
+            m_Scheduler.Execute(task);
+            spins = 0;
+        }
+        else
+        {
+            SpinWait(spins);
+        }
+    }
+}
+
+bool TaskScheduler::PinCurrentThread(int core)
+{
+    const unsigned int cores = std::max(std::thread::hardware_concurrency(), 1u);
+    core %= static_cast<int>(cores);
+#if defined(_WIN32)
+    if (core >= 64)
+        return false;
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << core) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+std::size_t TaskScheduler::GetL2CacheSize()
+{
+    constexpr std::size_t k_DefaultL2CacheSize = 256 * 1024;
+
+    static const std::size_t s_L2CacheSize = []()
+    {
+        std::size_t size = 0;
+#if defined(_WIN32)
+        DWORD bufferSize = 0;
+        GetLogicalProcessorInformation(nullptr, &bufferSize);
+        std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> infos(bufferSize / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+        if (!infos.empty() && GetLogicalProcessorInformation(infos.data(), &bufferSize))
+        {
+            for (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION& info : infos)
+            {
+                if (info.Relationship == RelationCache && info.Cache.Level == 2)
+                {
+                    size = info.Cache.Size;
+                    break;
+                }
+            }
+        }
+#elif defined(__linux__) && defined(_SC_LEVEL2_CACHE_SIZE)
+        const long value = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        if (value > 0)
+        {
+            size = static_cast<std::size_t>(value);
+        }
+#endif
+        return size > 0 ? size : k_DefaultL2CacheSize;
+    }();
+
+    return s_L2CacheSize;
+}
+
+} // namespace BrainFramework
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace BrainFramework
+{
+
+class TaskGroup;
+
+struct Task
+{
+    std::function<void()> function;
+    TaskGroup* group{ nullptr };
+};
+
+// Chase-Lev deque: its owner pushes and takes at the bottom, any other thread steals from the top
+class WorkStealingDeque
+{
+public:
+    explicit WorkStealingDeque(int capacity = 256);
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Owner only
+    void Push(Task* task);
+    Task* Take();
+
+    // Any thread, nullptr when empty or when another thread won the race
+    Task* Steal();
+
+private:
+    struct Buffer
+    {
+        explicit Buffer(std::int64_t capacity) : capacity(capacity), tasks(new std::atomic<Task*>[capacity]) {}
+
+        Task* Get(std::int64_t index) const { return tasks[index & (capacity - 1)].load(std::memory_order_acquire); }
+        void Put(std::int64_t index, Task* task) { tasks[index & (capacity - 1)].store(task, std::memory_order_release); }
+
+        std::int64_t capacity;
+        std::unique_ptr<std::atomic<Task*>[]> tasks;
+    };
+
+    alignas(64) std::atomic<std::int64_t> m_Top{ 0 };
+    alignas(64) std::atomic<std::int64_t> m_Bottom{ 0 };
+    std::atomic<Buffer*> m_Buffer;
+    std::vector<std::unique_ptr<Buffer>> m_Buffers; // Outgrown buffers stay alive, a thief may still be reading one
+};
+
+// Work-stealing scheduler shared by every parallel part of the framework
+// The calling thread always takes part in the work it waits for, so a scheduler of N workers owns N - 1 threads
+class TaskScheduler
+{
+public:
+    // Pinned workers take the cores from firstCore on, schedulers of several processes can keep to separate cores
+    explicit TaskScheduler(int workers = 0, bool pinThreads = false, int firstCore = 0);
+    ~TaskScheduler();
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    int GetWorkersCount() const { return static_cast<int>(m_Threads.size()) + 1; }
+
+    // Calls body(rangeBegin, rangeEnd) on sub-ranges of [begin, end) of at most grainSize indices, returns once all are done
+    void ParallelFor(int begin, int end, int grainSize, const std::function<void(int, int)>& body);
+
+    // 1 to N - 1 on the threads of this scheduler, 0 on any other thread
+    int GetCurrentWorkerIndex() const;
+
+    static bool PinCurrentThread(int core);
+    static std::size_t GetL2CacheSize();
+
+private:
+    friend class TaskGroup;
+
+    void Submit(Task* task);
+    Task* FindTask(int workerIndex);
+    void Execute(Task* task);
+    void WorkerLoop(int workerIndex, int pinnedCore);
+
+    std::vector<std::thread> m_Threads;
+    std::vector<std::unique_ptr<WorkStealingDeque>> m_Deques; // One per owned thread, worker i uses m_Deques[i - 1]
+
+    // Tasks submitted from threads the scheduler does not own
+    std::deque<Task*> m_Injected;
+    std::mutex m_InjectedMutex;
+    std::atomic<int> m_InjectedCount{ 0 };
+
+    std::atomic<std::uint32_t> m_WakeEpoch{ 0 };
+    std::atomic<int> m_Sleeping{ 0 };
+    std::atomic<bool> m_Stop{ false };
+};
+
+// Tasks that can be waited for together, waiting runs pending tasks instead of blocking
+class TaskGroup
+{
+public:
+    explicit TaskGroup(TaskScheduler& scheduler) : m_Scheduler(scheduler) {}
+    ~TaskGroup() { Wait(); }
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void Run(std::function<void()> function);
+    void Wait();
+
+    bool IsDone() const { return m_Pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class TaskScheduler;
+
+    TaskScheduler& m_Scheduler;
+    std::atomic<int> m_Pending{ 0 };
+};
+
+} // namespace BrainFramework
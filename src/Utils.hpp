@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cassert>
 #include <cmath>
+#include <cstdint>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
@@ -14,37 +16,74 @@
 #include <cctype>
 #include <string>
 
+// Headless builds define BRAINFRAMEWORK_NO_IMGUI, the models then leave out their DisplayImGui
+#ifndef BRAINFRAMEWORK_NO_IMGUI
 #include <imgui.h>
+#endif
+
+#include "Random.hpp"
 
 namespace BrainFramework
 {
 
-static std::random_device rd;
-static std::mt19937 gen(rd());
-
 inline float Sigmoid(float x)
 {
     return 2.0f / (1.0f + std::exp(-4.9f * x)) - 1.0f;
 }
 
-// [min, max]
+// [min, max)
 inline float RandomFloat(float min = 0.0f, float max = 1.0f)
 {
-    std::uniform_real_distribution<float> distribution(min, max);
-    return distribution(gen);
+    return min + (max - min) * Random::GetThreadStream().NextFloat();
 }
 
 // [min, max]
 inline int RandomInt(int min = 0, int max = 100)
 {
-    std::uniform_int_distribution<int> distribution(min, max);
-    return distribution(gen);
+    return Random::GetThreadStream().NextInt(min, max);
 }
 
 inline bool RandomBool()
 {
-    std::uniform_int_distribution<int> distribution(0, 1);
-    return distribution(gen) == 0;
+    return (Random::GetThreadStream().NextUInt32() & 1) == 0;
+}
+
+// Bulk versions of the above, much cheaper per value than calling RandomFloat in a loop
+inline void FillUniform(std::span<float> values, float min = 0.0f, float max = 1.0f)
+{
+    Random::GetThreadStream().FillUniform(values, min, max);
+}
+
+inline void FillNormal(std::span<float> values, float mean = 0.0f, float standardDeviation = 1.0f)
+{
+    Random::GetThreadStream().FillNormal(values, mean, standardDeviation);
+}
+
+inline void FillBernoulli(std::span<std::uint8_t> values, float p)
+{
+    Random::GetThreadStream().FillBernoulli(values, p);
+}
+
+// Point mutation of count weights: each one is perturbed by up to step with perturbChance, otherwise reset within [-2, 2)
+// Two draws per weight, all generated at once, then the choice and the value
+template <typename GetWeight, typename SetWeight>
+inline void MutateWeights(std::size_t count, float perturbChance, float step, GetWeight&& getWeight, SetWeight&& setWeight)
+{
+    thread_local std::vector<float> draws;
+    draws.resize(2 * count);
+    FillUniform(draws);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (draws[2 * i] < perturbChance)
+        {
+            setWeight(i, getWeight(i) + draws[2 * i + 1] * step * 2.0f - step);
+        }
+        else
+        {
+            setWeight(i, draws[2 * i + 1] * 4.0f - 2.0f);
+        }
+    }
 }
 
 template <typename T>
@@ -0,0 +1,72 @@
+#include "VectorSimulation.hpp"
+
+namespace BrainFramework
+{
+
+VectorSimulation::VectorSimulation(int lanes)
+    : m_Lanes(std::max(lanes, 1))
+    , m_LaneEpisodes(m_Lanes, -1)
+    , m_LaneRandoms(m_Lanes)
+    , m_StepRewards(m_Lanes, 0.0f)
+    , m_Done(m_Lanes, 1)
+{
+}
+
+void VectorSimulation::Reset(std::span<const std::uint64_t> episodeSeeds, std::span<float> observations)
+{
+    m_EpisodeSeeds.assign(episodeSeeds.begin(), episodeSeeds.end());
+    m_EpisodeRewards.assign(m_EpisodeSeeds.size(), 0.0f);
+    m_NextEpisode = 0;
+
+    m_UsedLanes = static_cast<int>(std::min<std::size_t>(m_Lanes, m_EpisodeSeeds.size()));
+    m_ActiveLanes = 0;
+    std::fill(m_LaneEpisodes.begin(), m_LaneEpisodes.end(), -1);
+    for (int lane = 0; lane < m_UsedLanes; ++lane)
+    {
+        StartNextEpisode(lane);
+    }
+
+    WriteObservations(m_UsedLanes, observations.data());
+}
+
+void VectorSimulation::StepBatch(std::span<const float> actions, std::span<float> observations, std::span<float> rewards, std::span<std::uint8_t> done)
+{
+    std::fill(m_StepRewards.begin(), m_StepRewards.begin() + m_UsedLanes, 0.0f);
+    for (int lane = 0; lane < m_UsedLanes; ++lane)
+    {
+        m_Done[lane] = IsLaneActive(lane) ? 0 : 1;
+    }
+
+    StepLanes(m_UsedLanes, actions.data());
+
+    for (int lane = 0; lane < m_UsedLanes; ++lane)
+    {
+        rewards[lane] = m_StepRewards[lane];
+        done[lane] = m_Done[lane];
+
+        if (m_Done[lane] && IsLaneActive(lane))
+        {
+            m_LaneEpisodes[lane] = -1;
+            m_ActiveLanes--;
+            StartNextEpisode(lane);
+        }
+    }
+
+    WriteObservations(m_UsedLanes, observations.data());
+}
+
+void VectorSimulation::StartNextEpisode(int lane)
+{
+    if (m_NextEpisode >= m_EpisodeSeeds.size())
+        return;
+
+    // Draws the lane stream the way ISimulation::SeedRandom does under the episode scope
+    RandomStream episodeStream(m_EpisodeSeeds[m_NextEpisode]);
+    m_LaneRandoms[lane].Reset(episodeStream.NextUInt64(), 0);
+
+    m_LaneEpisodes[lane] = static_cast<int>(m_NextEpisode++);
+    m_ActiveLanes++;
+    ResetLane(lane);
+}
+
+} // namespace BrainFramework
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Utils.hpp"
+
+namespace BrainFramework
+{
+
+class NeuralNetwork;
+
+// Plays many single agent episodes side by side, the state is kept as one array per field with an entry per lane
+// An episode played from a seed is the one the scalar simulation plays under a RandomScope of that seed
+class VectorSimulation
+{
+public:
+    explicit VectorSimulation(int lanes);
+    virtual ~VectorSimulation() = default;
+    VectorSimulation(const VectorSimulation&) = delete;
+    VectorSimulation& operator=(const VectorSimulation&) = delete;
+
+    virtual const char* GetName() const = 0;
+    virtual int GetObservationsCount() const = 0;
+    virtual int GetActionsCount() const = 0;
+
+    int GetLanesCount() const { return m_Lanes; }
+
+    // Lanes used since the last Reset, never more than there are episodes
+    int GetUsedLanesCount() const { return m_UsedLanes; }
+
+    // Queues one episode per seed, starts the first ones and writes the first observations of the used lanes
+    void Reset(std::span<const std::uint64_t> episodeSeeds, std::span<float> observations);
+
+    // Rows of actions and observations are the used lanes, rewards and done are those of the step just played
+    // A finished lane restarts on the next queued episode right away, its observations are the first of that episode
+    // Idle lanes, once the queue is empty, ignore their actions and report done without reward
+    void StepBatch(std::span<const float> actions, std::span<float> observations, std::span<float> rewards, std::span<std::uint8_t> done);
+
+    // Index in the Reset seeds of the episode a lane plays, -1 when idle
+    int GetLaneEpisode(int lane) const { return m_LaneEpisodes[lane]; }
+    bool IsFinished() const { return m_ActiveLanes == 0; }
+
+    // Total reward of every episode queued by Reset, in seeds order
+    const std::vector<float>& GetEpisodeRewards() const { return m_EpisodeRewards; }
+
+protected:
+    // Starts an episode on the lane, its random draws must come from GetLaneRandom only
+    virtual void ResetLane(int lane) = 0;
+
+    // Plays one step on every active lane of [0, lanes), rewards go through AddReward and ends through Finish
+    virtual void StepLanes(int lanes, const float* actions) = 0;
+
+    // Writes one observations row per lane of [0, lanes)
+    virtual void WriteObservations(int lanes, float* observations) const = 0;
+
+    bool IsLaneActive(int lane) const { return m_LaneEpisodes[lane] >= 0; }
+    RandomStream& GetLaneRandom(int lane) { return m_LaneRandoms[lane]; }
+
+    // Same accumulation order as AgentInterface::AddReward, so episode totals match the scalar simulation
+    void AddReward(int lane, float reward)
+    {
+        m_StepRewards[lane] += reward;
+        m_EpisodeRewards[m_LaneEpisodes[lane]] += reward;
+    }
+    void Finish(int lane) { m_Done[lane] = 1; }
+
+private:
+    void StartNextEpisode(int lane);
+
+    int m_Lanes;
+    int m_UsedLanes{ 0 };
+    int m_ActiveLanes{ 0 };
+
+    std::vector<std::uint64_t> m_EpisodeSeeds;
+    std::vector<float> m_EpisodeRewards;
+    std::size_t m_NextEpisode{ 0 };
+
+    std::vector<int> m_LaneEpisodes;
+    std::vector<RandomStream> m_LaneRandoms;
+    std::vector<float> m_StepRewards;
+    std::vector<std::uint8_t> m_Done;
+};
+
+} // namespace BrainFramework
@@ -0,0 +1,644 @@
+#include "BrainFramework.hpp"
+
+#include "../demo/NEAT.hpp"
+#include "../demo/NEET.hpp"
+#include "../demo/NEETL.hpp"
+
+#include "../demo/MoreOrLess.hpp"
+#include "../demo/Blackjack.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Headless trainer, runs the training loop of the demo as fast as the workers go and prints stats along the way
+// Usage: BrainFrameworkTrainer [--simulation MoreOrLess|Blackjack] [--model NEAT|NEET|NEETL] [--threads N]
+//                              [--generations N] [--seconds N] [--seed N] [--stats-seconds N] [--steady-state] [--pipelined] [--refinement]
+//                              [--islands N] [--migration-interval N] [--migrants N] [--topology Ring|Full|Random] [--pin]
+//                              [--serve unix:PATH|HOST:PORT [--workers N] [--fork-workers]] [--worker unix:PATH|HOST:PORT]
+// Islands are populations evolved by processes of their own, sharing the threads, that swap their best genomes through shared memory
+// A served model trains in this process while its episodes are played by worker processes, started with --worker or forked here
+// Workers are not authenticated, :PORT listens on loopback only, 0.0.0.0:PORT lets other machines connect
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+    std::string simulation{ "MoreOrLess" };
+    std::string model{ "NEAT" };
+    int threads{ 0 };
+    int generations{ 0 };
+    double seconds{ 0.0 };
+    std::uint64_t seed{ 0 };
+    bool hasSeed{ false };
+    double statsSeconds{ 5.0 };
+    bool steadyState{ false };
+    bool pipelined{ false };
+    bool refinement{ false };
+    int islands{ 1 };
+    int migrationInterval{ 10 }; // Generations between two migrations of an island
+    int migrants{ 5 }; // Genomes an island sends at each migration
+    std::string topology{ "Ring" };
+    bool pin{ false };
+    std::string serve; // Address the coordinator listens on
+    int workers{ 1 }; // Workers the coordinator waits for before training
+    bool forkWorkers{ false };
+    std::string worker; // Address of the coordinator to work for
+};
+
+// One process of an island model, alone when there is no mailbox
+struct Island
+{
+    int index{ 0 };
+    int count{ 1 };
+    BrainFramework::MigrationMailbox* mailbox{ nullptr };
+    BrainFramework::MigrationTopology topology{ BrainFramework::MigrationTopology::Ring };
+};
+
+// Shared with the demo, a host measures its kernels once
+const char* const k_KernelTuningFilename = "kernels.tuning";
+
+// Wide layers of the layered networks split their rows over the scheduler, with the kernels measured best on this host, as in the demo
+struct LayeredKernels
+{
+    LayeredKernels(BrainFramework::TaskScheduler* taskScheduler, bool saveTuning)
+        : kernelTuner(taskScheduler)
+        , saveTuning(saveTuning)
+    {
+        kernelTuner.LoadFromFile(k_KernelTuningFilename);
+        BrainFramework::LayeredNeuralNetwork::SetTaskScheduler(taskScheduler);
+        BrainFramework::LayeredNeuralNetwork::SetKernelTuner(&kernelTuner);
+    }
+
+    ~LayeredKernels()
+    {
+        BrainFramework::LayeredNeuralNetwork::SetKernelTuner(nullptr);
+        BrainFramework::LayeredNeuralNetwork::SetTaskScheduler(nullptr);
+        if (saveTuning)
+            kernelTuner.SaveToFile(k_KernelTuningFilename);
+    }
+
+    LayeredKernels(const LayeredKernels&) = delete;
+    LayeredKernels& operator=(const LayeredKernels&) = delete;
+
+    BrainFramework::KernelTuner kernelTuner;
+    bool saveTuning;
+};
+
+// Episodes the best network plays for each stats line, on the same seeds every time so the lines compare
+constexpr int k_StatsEpisodes = 200;
+constexpr std::uint64_t k_StatsNode = ~3ull;
+
+// Random topologies draw the sources of every migration from this node
+constexpr std::uint64_t k_MigrationNode = ~4ull;
+
+// Largest message of migrants an island can post
+constexpr std::size_t k_MailboxSlotBytes = 1 << 20;
+
+// Jobs an async model runs between two looks at the clock
+constexpr int k_AsyncJobsPerStep = 100;
+
+// Genomes each worker keeps, a few populations worth
+constexpr int k_WorkerCacheGenomes = 1024;
+
+float EvaluateBest(BrainFramework::Model& model, BrainFramework::ISimulation& simulation)
+{
+    std::shared_ptr<BrainFramework::NeuralNetwork> neuralNetwork;
+    if (!model.MakeBestNeuralNetwork(neuralNetwork))
+        return 0.0f;
+
+    const std::uint64_t statsSeed = BrainFramework::DeriveSeed(BrainFramework::Random::GetRunSeed(), k_StatsNode);
+    double sum = 0.0;
+    for (int episode = 0; episode < k_StatsEpisodes; ++episode)
+    {
+        sum += BrainFramework::BatchEvaluator::RunEpisode(simulation, *neuralNetwork, BrainFramework::DeriveSeed(statsSeed, episode));
+    }
+    return static_cast<float>(sum / k_StatsEpisodes);
+}
+
+// Posts the best genomes of the island, then takes in whatever its sources posted since it last looked
+// Islands never wait for one another, so which generation of a source arrives depends on how fast each one runs
+int Migrate(BrainFramework::Model& model, const Options& options, const Island& island, int migration, std::vector<std::uint64_t>& lastSequences)
+{
+    BrainFramework::ByteWriter writer;
+    model.WriteMigrants(options.migrants, writer);
+    if (!island.mailbox->Post(island.index, writer.GetBytes()))
+        std::fprintf(stderr, "island %d: %zu bytes of migrants don't fit the mailbox\n", island.index, writer.GetBytes().size());
+
+    const std::uint64_t migrationSeed = BrainFramework::DeriveSeed(BrainFramework::DeriveSeed(BrainFramework::Random::GetRunSeed(), k_MigrationNode), migration);
+    std::vector<int> sources;
+    BrainFramework::MigrationMailbox::GetSources(island.topology, island.index, island.count, migrationSeed, sources);
+
+    int arrived = 0;
+    std::vector<std::uint8_t> message;
+    for (int source : sources)
+    {
+        if (island.mailbox->Receive(source, lastSequences[source], message))
+        {
+            BrainFramework::ByteReader reader(message);
+            arrived += model.ReadMigrants(reader);
+        }
+    }
+    return arrived;
+}
+
+template <typename TModel>
+int Train(const Options& options, const Island& island, BrainFramework::ISimulation& simulation, BrainFramework::TaskScheduler* taskScheduler, BrainFramework::RemoteEvaluator* remoteEvaluator)
+{
+    TModel model;
+    if constexpr (requires { model.SetSteadyState(true); })
+    {
+        model.SetSteadyState(options.steadyState);
+    }
+    else if (options.steadyState)
+    {
+        std::fprintf(stderr, "%s has no steady-state mode\n", model.GetName());
+        return 1;
+    }
+    if constexpr (requires { model.SetPipelined(true); })
+    {
+        model.SetPipelined(options.pipelined);
+    }
+    else if (options.pipelined)
+    {
+        std::fprintf(stderr, "%s has no pipelined mode\n", model.GetName());
+        return 1;
+    }
+    if constexpr (requires { model.SetRefinement(true); })
+    {
+        model.SetRefinement(options.refinement);
+    }
+    else if (options.refinement)
+    {
+        std::fprintf(stderr, "%s has no refinement\n", model.GetName());
+        return 1;
+    }
+
+    if (island.mailbox != nullptr && !model.SupportsMigration())
+    {
+        std::fprintf(stderr, "%s has no island mode\n", model.GetName());
+        return 1;
+    }
+
+    // Island 0 evolves the population a single process would
+    model.SetSeed(BrainFramework::DeriveSeed(BrainFramework::Random::GetRunSeed(), static_cast<std::uint64_t>(island.index)));
+    if (!model.PrepareTraining(simulation) || !model.SupportsBatch())
+    {
+        std::fprintf(stderr, "%s can't train on %s\n", model.GetName(), simulation.GetName());
+        return 1;
+    }
+
+    std::vector<std::uint64_t> lastSequences(island.count, 0);
+    int migrations = 0;
+    int arrivals = 0;
+
+    BrainFramework::BatchEvaluator batchEvaluator(taskScheduler, simulation);
+    std::vector<BrainFramework::EvaluationJob> evaluationJobs;
+
+    const int startGeneration = model.GetGeneration();
+    const Clock::time_point start = Clock::now();
+    Clock::time_point lastStats = start;
+    int lastStatsGeneration = startGeneration;
+    int nextMigration = startGeneration + options.migrationInterval;
+
+    auto printStats = [&](Clock::time_point now)
+    {
+        const double elapsed = std::chrono::duration<double>(now - start).count();
+        const double interval = std::chrono::duration<double>(now - lastStats).count();
+        const double generationsPerSecond = interval > 0.0 ? (model.GetGeneration() - lastStatsGeneration) / interval : 0.0;
+        if (island.mailbox != nullptr)
+            std::printf("island %2d  %8.1fs  generation %6d  %8.2f generations/s  best %10.4f  arrivals %6d\n", island.index, elapsed, model.GetGeneration(), generationsPerSecond, EvaluateBest(model, simulation), arrivals);
+        else
+            std::printf("%8.1fs  generation %6d  %8.2f generations/s  best %10.4f\n", elapsed, model.GetGeneration(), generationsPerSecond, EvaluateBest(model, simulation));
+
+        if (remoteEvaluator != nullptr)
+        {
+            const BrainFramework::RemoteStats& remoteStats = remoteEvaluator->GetStats();
+            std::printf("          workers %d  sent %.1f KiB  received %.1f KiB  %.1f bytes/job  genomes %llu full, %llu bred, %llu cached\n", remoteEvaluator->GetWorkersCount(),
+                remoteStats.bytesSent / 1024.0, remoteStats.bytesReceived / 1024.0, remoteStats.jobs > 0 ? static_cast<double>(remoteStats.bytesSent) / remoteStats.jobs : 0.0,
+                static_cast<unsigned long long>(remoteStats.fullGenomes), static_cast<unsigned long long>(remoteStats.bredGenomes), static_cast<unsigned long long>(remoteStats.cachedGenomes));
+        }
+        std::fflush(stdout);
+
+        lastStats = now;
+        lastStatsGeneration = model.GetGeneration();
+    };
+
+    while (true)
+    {
+        const Clock::time_point now = Clock::now();
+        const bool generationsDone = options.generations > 0 && model.GetGeneration() - startGeneration >= options.generations;
+        const bool secondsDone = options.seconds > 0.0 && std::chrono::duration<double>(now - start).count() >= options.seconds;
+        if (generationsDone || secondsDone)
+            break;
+
+        if (std::chrono::duration<double>(now - lastStats).count() >= options.statsSeconds)
+            printStats(now);
+
+        // Nothing runs on the scheduler between two training steps, the shapes met during the last one are measured now
+        if (BrainFramework::KernelTuner* kernelTuner = BrainFramework::LayeredNeuralNetwork::GetKernelTuner())
+            kernelTuner->TunePending();
+
+        // Between two steps, no job holds a genome
+        if (island.mailbox != nullptr && options.migrationInterval > 0 && model.GetGeneration() >= nextMigration)
+        {
+            arrivals += Migrate(model, options, island, migrations++, lastSequences);
+            nextMigration = model.GetGeneration() + options.migrationInterval;
+        }
+
+        if (remoteEvaluator != nullptr && remoteEvaluator->GetWorkersCount() == 0)
+        {
+            std::fprintf(stderr, "Every worker is gone\n");
+            return 1;
+        }
+
+        // Same steps as the demo training, without a frame to wait for
+        if (model.SupportsAsync())
+        {
+            if (remoteEvaluator != nullptr)
+                remoteEvaluator->EvaluateAsync(model, k_AsyncJobsPerStep);
+            else
+                batchEvaluator.EvaluateAsync(model, k_AsyncJobsPerStep);
+            continue;
+        }
+
+        if (!model.PrepareBatch(evaluationJobs))
+            break;
+
+        if (remoteEvaluator != nullptr)
+            remoteEvaluator->Evaluate(evaluationJobs);
+        else
+            batchEvaluator.Evaluate(evaluationJobs);
+        model.EndBatch(evaluationJobs);
+    }
+
+    printStats(Clock::now());
+    return 0;
+}
+
+template <typename TSimulation>
+int Train(const Options& options, const Island& island, BrainFramework::TaskScheduler* taskScheduler, BrainFramework::RemoteEvaluator* remoteEvaluator)
+{
+    TSimulation simulation;
+    if (options.model == "NEAT")
+        return Train<NEAT::NEATModel>(options, island, simulation, taskScheduler, remoteEvaluator);
+    if (options.model == "NEET")
+        return Train<NEET::NEETModel>(options, island, simulation, taskScheduler, remoteEvaluator);
+    if (options.model == "NEETL")
+        return Train<NEETL::NEETLModel>(options, island, simulation, taskScheduler, remoteEvaluator);
+
+    std::fprintf(stderr, "Unknown model %s\n", options.model.c_str());
+    return 1;
+}
+
+// Runs one island, or the only population, on its own scheduler
+int Train(const Options& options, const Island& island, int threads, BrainFramework::RemoteEvaluator* remoteEvaluator = nullptr)
+{
+    // Pinned islands keep to consecutive cores, which tend to share a NUMA node
+    const int firstCore = island.index * threads;
+    if (options.pin)
+        BrainFramework::TaskScheduler::PinCurrentThread(firstCore);
+
+    std::unique_ptr<BrainFramework::TaskScheduler> taskScheduler;
+    if (threads > 1)
+    {
+        taskScheduler = std::make_unique<BrainFramework::TaskScheduler>(threads, options.pin, firstCore);
+    }
+
+    // Islands measure the same host, only the first one writes the table
+    LayeredKernels layeredKernels(taskScheduler.get(), island.index == 0);
+
+    if (options.simulation == "MoreOrLess")
+        return Train<MoreOrLess>(options, island, taskScheduler.get(), remoteEvaluator);
+    if (options.simulation == "Blackjack")
+        return Train<Blackjack>(options, island, taskScheduler.get(), remoteEvaluator);
+
+    std::fprintf(stderr, "Unknown simulation %s\n", options.simulation.c_str());
+    return 1;
+}
+
+template <typename TSimulation>
+int Work(const BrainFramework::RemoteSession& session, BrainFramework::RemoteWorker& worker, BrainFramework::TaskScheduler* taskScheduler)
+{
+    TSimulation simulation;
+    bool succeeded = false;
+    if (session.model == "NEAT")
+        succeeded = worker.Run(NEAT::NEATModel(), simulation, taskScheduler);
+    else if (session.model == "NEET")
+        succeeded = worker.Run(NEET::NEETModel(), simulation, taskScheduler);
+    else if (session.model == "NEETL")
+        succeeded = worker.Run(NEETL::NEETLModel(), simulation, taskScheduler);
+    else
+        std::fprintf(stderr, "Unknown model %s\n", session.model.c_str());
+    return succeeded ? 0 : 1;
+}
+
+// Plays the jobs of the coordinator at the address until it hangs up, on the simulation and model it names
+int Work(const Options& options, int threads)
+{
+    BrainFramework::RemoteWorker worker;
+    BrainFramework::RemoteSession session;
+    if (!worker.Connect(options.worker, threads, session))
+    {
+        std::fprintf(stderr, "Can't work for %s\n", options.worker.c_str());
+        return 1;
+    }
+
+    // Episode seeds derive from the run seed, the worker plays the episodes the coordinator would
+    BrainFramework::Random::SetRunSeed(session.runSeed);
+
+    std::unique_ptr<BrainFramework::TaskScheduler> taskScheduler;
+    if (threads > 1)
+    {
+        taskScheduler = std::make_unique<BrainFramework::TaskScheduler>(threads);
+    }
+
+    // A worker has no step boundary to tune at, it uses the table its host already has
+    LayeredKernels layeredKernels(taskScheduler.get(), false);
+
+    if (session.simulation == "MoreOrLess")
+        return Work<MoreOrLess>(session, worker, taskScheduler.get());
+    if (session.simulation == "Blackjack")
+        return Work<Blackjack>(session, worker, taskScheduler.get());
+
+    std::fprintf(stderr, "Unknown simulation %s\n", session.simulation.c_str());
+    return 1;
+}
+
+// Trains in this process while the workers play every episode, forking them first when asked
+int Serve(const Options& options, int threads)
+{
+    BrainFramework::RemoteEvaluator remoteEvaluator;
+    if (!remoteEvaluator.Listen(options.serve))
+    {
+        std::fprintf(stderr, "Can't listen on %s\n", options.serve.c_str());
+        return 1;
+    }
+
+#if !defined(_WIN32)
+    std::vector<pid_t> processes;
+    if (options.forkWorkers)
+    {
+        Options workerOptions = options;
+        workerOptions.worker = options.serve;
+        const int workerThreads = std::max(threads / options.workers, 1);
+        for (int i = 0; i < options.workers; ++i)
+        {
+            // Forked before any thread exists, the worker connects back to the address
+            std::fflush(stdout);
+            const pid_t process = fork();
+            if (process == 0)
+            {
+                const int result = Work(workerOptions, workerThreads);
+                std::fflush(stdout);
+                _exit(result);
+            }
+            if (process < 0)
+            {
+                std::fprintf(stderr, "Can't fork worker %d\n", i);
+                return 1;
+            }
+            processes.push_back(process);
+        }
+    }
+#endif
+
+    BrainFramework::RemoteSession session;
+    session.simulation = options.simulation;
+    session.model = options.model;
+    session.runSeed = BrainFramework::Random::GetRunSeed();
+    session.cacheCapacity = k_WorkerCacheGenomes;
+    if (!remoteEvaluator.Accept(options.workers, session))
+    {
+        std::fprintf(stderr, "Can't accept workers on %s\n", options.serve.c_str());
+        return 1;
+    }
+
+    // The coordinator only breeds, a single thread
+    int result = Train(options, Island(), 1, &remoteEvaluator);
+    remoteEvaluator.Close();
+
+#if !defined(_WIN32)
+    for (pid_t process : processes)
+    {
+        int status = 0;
+        if (waitpid(process, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            result = 1;
+    }
+#endif
+    return result;
+}
+
+bool ParseTopology(const std::string& name, BrainFramework::MigrationTopology& topology)
+{
+    if (name == "Ring")
+        topology = BrainFramework::MigrationTopology::Ring;
+    else if (name == "Full")
+        topology = BrainFramework::MigrationTopology::Full;
+    else if (name == "Random")
+        topology = BrainFramework::MigrationTopology::Random;
+    else
+        return false;
+    return true;
+}
+
+// Forks a process per island, each one inherits the mailbox and trains on its share of the threads
+// Processes share nothing else, not even the innovation counters or the allocator, so islands scale with the cores
+int TrainIslands(const Options& options, int threads)
+{
+    Island island;
+    island.count = options.islands;
+    if (!ParseTopology(options.topology, island.topology))
+    {
+        std::fprintf(stderr, "Unknown topology %s\n", options.topology.c_str());
+        return 1;
+    }
+
+#if defined(_WIN32)
+    std::fprintf(stderr, "Islands need fork, they are not available on this platform\n");
+    return 1;
+#else
+    BrainFramework::MigrationMailbox mailbox;
+    if (!mailbox.Create(options.islands, k_MailboxSlotBytes))
+    {
+        std::fprintf(stderr, "Can't map the migration mailbox\n");
+        return 1;
+    }
+    island.mailbox = &mailbox;
+
+    const int islandThreads = std::max(threads / options.islands, 1);
+    std::vector<pid_t> processes;
+    for (int i = 0; i < options.islands; ++i)
+    {
+        // Forked before any thread exists, the child starts its own scheduler
+        std::fflush(stdout);
+        const pid_t process = fork();
+        if (process == 0)
+        {
+            island.index = i;
+            const int result = Train(options, island, islandThreads);
+            std::fflush(stdout);
+            _exit(result);
+        }
+        if (process < 0)
+        {
+            std::fprintf(stderr, "Can't fork island %d\n", i);
+            break;
+        }
+        processes.push_back(process);
+    }
+
+    int result = static_cast<int>(processes.size()) == options.islands ? 0 : 1;
+    for (pid_t process : processes)
+    {
+        int status = 0;
+        if (waitpid(process, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            result = 1;
+    }
+    return result;
+#endif
+}
+
+bool ParseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (argument == "--simulation" && hasValue)
+        {
+            options.simulation = argv[++i];
+        }
+        else if (argument == "--model" && hasValue)
+        {
+            options.model = argv[++i];
+        }
+        else if (argument == "--threads" && hasValue)
+        {
+            options.threads = std::atoi(argv[++i]);
+        }
+        else if (argument == "--generations" && hasValue)
+        {
+            options.generations = std::atoi(argv[++i]);
+        }
+        else if (argument == "--seconds" && hasValue)
+        {
+            options.seconds = std::atof(argv[++i]);
+        }
+        else if (argument == "--seed" && hasValue)
+        {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+            options.hasSeed = true;
+        }
+        else if (argument == "--stats-seconds" && hasValue)
+        {
+            options.statsSeconds = std::atof(argv[++i]);
+        }
+        else if (argument == "--steady-state")
+        {
+            options.steadyState = true;
+        }
+        else if (argument == "--pipelined")
+        {
+            options.pipelined = true;
+        }
+        else if (argument == "--refinement")
+        {
+            options.refinement = true;
+        }
+        else if (argument == "--islands" && hasValue)
+        {
+            options.islands = std::max(std::atoi(argv[++i]), 1);
+        }
+        else if (argument == "--migration-interval" && hasValue)
+        {
+            options.migrationInterval = std::atoi(argv[++i]);
+        }
+        else if (argument == "--migrants" && hasValue)
+        {
+            options.migrants = std::atoi(argv[++i]);
+        }
+        else if (argument == "--topology" && hasValue)
+        {
+            options.topology = argv[++i];
+        }
+        else if (argument == "--pin")
+        {
+            options.pin = true;
+        }
+        else if (argument == "--serve" && hasValue)
+        {
+            options.serve = argv[++i];
+        }
+        else if (argument == "--workers" && hasValue)
+        {
+            options.workers = std::max(std::atoi(argv[++i]), 1);
+        }
+        else if (argument == "--fork-workers")
+        {
+            options.forkWorkers = true;
+        }
+        else if (argument == "--worker" && hasValue)
+        {
+            options.worker = argv[++i];
+        }
+        else
+        {
+            std::fprintf(stderr, "Usage: %s [--simulation MoreOrLess|Blackjack] [--model NEAT|NEET|NEETL] [--threads N]\n", argv[0]);
+            std::fprintf(stderr, "       [--generations N] [--seconds N] [--seed N] [--stats-seconds N] [--steady-state] [--pipelined] [--refinement]\n");
+            std::fprintf(stderr, "       [--islands N] [--migration-interval N] [--migrants N] [--topology Ring|Full|Random] [--pin]\n");
+            std::fprintf(stderr, "       [--serve unix:PATH|HOST:PORT [--workers N] [--fork-workers]] [--worker unix:PATH|HOST:PORT]\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options))
+        return 1;
+
+    const int threads = std::max(options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+    // A worker takes everything but its threads from the coordinator
+    if (!options.worker.empty())
+        return Work(options, threads);
+
+    if (!options.serve.empty() && options.islands > 1)
+    {
+        std::fprintf(stderr, "A served model has no islands\n");
+        return 1;
+    }
+
+    // Without a budget the training runs until the process is killed
+    const std::uint64_t seed = options.hasSeed ? options.seed : static_cast<std::uint64_t>(std::time(nullptr));
+    BrainFramework::Random::SetRunSeed(seed);
+
+    std::printf("%s on %s, %d threads, seed %llu\n", options.model.c_str(), options.simulation.c_str(), threads, static_cast<unsigned long long>(seed));
+    if (options.islands > 1)
+        std::printf("%d islands, %s migration of %d genomes every %d generations\n", options.islands, options.topology.c_str(), options.migrants, options.migrationInterval);
+    if (!options.serve.empty())
+        std::printf("Serving %d workers on %s\n", options.workers, options.serve.c_str());
+    std::fflush(stdout);
+
+    if (options.islands > 1)
+        return TrainIslands(options, threads);
+    if (!options.serve.empty())
+        return Serve(options, threads);
+
+    return Train(options, Island(), threads);
+}